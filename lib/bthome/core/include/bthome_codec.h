@@ -0,0 +1,530 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BTHOME_CODEC_H_
+#define BTHOME_CODEC_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Freestanding BTHome v2 codec
+ *
+ * Object table, payload encoding, AES-CCM and service data parsing with
+ * no dependency on Zephyr. The Zephyr library is built on top of it, and
+ * host tools link it as the plain CMake target bthome_codec, so devices
+ * and gateways share one definition of the format.
+ *
+ * Functions return 0 or a length on success and a negative errno value
+ * on failure. The AES block cipher is supplied by the caller through
+ * struct bthome_aes.
+ */
+
+/**
+ * @defgroup bthome_codec BTHome v2 codec
+ * @{
+ */
+
+/* BTHome v2 Protocol Constants */
+#define BTHOME_SERVICE_UUID         0xFCD2  /**< BTHome service UUID */
+#define BTHOME_MAX_PAYLOAD_SIZE     23      /**< Maximum payload size without encryption */
+#define BTHOME_MAX_PAYLOAD_ENC      15      /**< Maximum payload size with encryption */
+
+/* BTHome v2 Device Info Flags */
+#define BTHOME_NO_ENCRYPT           0x40    /**< BTHome v2, no encryption */
+#define BTHOME_NO_ENCRYPT_TRIGGER   0x44    /**< BTHome v2, no encryption, trigger-based */
+#define BTHOME_ENCRYPT              0x41    /**< BTHome v2, with encryption */
+#define BTHOME_ENCRYPT_TRIGGER      0x45    /**< BTHome v2, with encryption, trigger-based */
+
+/* BTHome v2 Object IDs - Sensor Measurements */
+#define BTHOME_ID_PACKET            0x00    /**< Packet ID (8-bit) */
+#define BTHOME_ID_BATTERY           0x01    /**< Battery (8-bit, %) */
+#define BTHOME_ID_TEMPERATURE_PRECISE 0x02  /**< Temperature precise (16-bit, 0.01°C) */
+#define BTHOME_ID_HUMIDITY_PRECISE  0x03    /**< Humidity precise (16-bit, 0.01%) */
+#define BTHOME_ID_PRESSURE          0x04    /**< Pressure (24-bit, 0.01 hPa) */
+#define BTHOME_ID_ILLUMINANCE       0x05    /**< Illuminance (24-bit, 0.01 lux) */
+#define BTHOME_ID_MASS              0x06    /**< Mass (16-bit, 0.01 kg) */
+#define BTHOME_ID_MASS_LB           0x07    /**< Mass (16-bit, 0.01 lb) */
+#define BTHOME_ID_DEWPOINT          0x08    /**< Dewpoint (16-bit, 0.01°C) */
+#define BTHOME_ID_COUNT             0x09    /**< Count (8-bit) */
+#define BTHOME_ID_ENERGY            0x0A    /**< Energy (24-bit, 0.001 kWh) */
+#define BTHOME_ID_POWER             0x0B    /**< Power (24-bit, 0.01 W) */
+#define BTHOME_ID_VOLTAGE           0x0C    /**< Voltage (16-bit, 0.001 V) */
+#define BTHOME_ID_PM25              0x0D    /**< PM2.5 (16-bit, μg/m³) */
+#define BTHOME_ID_PM10              0x0E    /**< PM10 (16-bit, μg/m³) */
+
+/* BTHome v2 Object IDs - Binary States */
+#define BTHOME_STATE_GENERIC_BOOLEAN 0x0F   /**< Generic boolean (8-bit) */
+#define BTHOME_STATE_POWER_ON       0x10    /**< Power state (8-bit) */
+#define BTHOME_STATE_OPENING        0x11    /**< Opening state (8-bit) */
+
+/* BTHome v2 Object IDs - Gas and Air Quality */
+#define BTHOME_ID_CO2               0x12    /**< CO2 (16-bit, ppm) */
+#define BTHOME_ID_TVOC              0x13    /**< TVOC (16-bit, μg/m³) */
+#define BTHOME_ID_MOISTURE_PRECISE  0x14    /**< Moisture precise (16-bit, 0.01%) */
+
+/* BTHome v2 Object IDs - Device States */
+#define BTHOME_STATE_BATTERY_LOW    0x15    /**< Battery low (8-bit) */
+#define BTHOME_STATE_BATTERY_CHARGING 0x16  /**< Battery charging (8-bit) */
+#define BTHOME_STATE_CO             0x17    /**< CO detected (8-bit) */
+#define BTHOME_STATE_COLD           0x18    /**< Cold detected (8-bit) */
+#define BTHOME_STATE_CONNECTIVITY   0x19    /**< Connectivity (8-bit) */
+#define BTHOME_STATE_DOOR           0x1A    /**< Door state (8-bit) */
+#define BTHOME_STATE_GARAGE_DOOR    0x1B    /**< Garage door (8-bit) */
+#define BTHOME_STATE_GAS_DETECTED   0x1C    /**< Gas detected (8-bit) */
+#define BTHOME_STATE_HEAT           0x1D    /**< Heat detected (8-bit) */
+#define BTHOME_STATE_LIGHT          0x1E    /**< Light state (8-bit) */
+#define BTHOME_STATE_LOCK           0x1F    /**< Lock state (8-bit) */
+#define BTHOME_STATE_MOISTURE       0x20    /**< Moisture detected (8-bit) */
+#define BTHOME_STATE_MOTION         0x21    /**< Motion detected (8-bit) */
+#define BTHOME_STATE_MOVING         0x22    /**< Moving state (8-bit) */
+#define BTHOME_STATE_OCCUPANCY      0x23    /**< Occupancy (8-bit) */
+#define BTHOME_STATE_PLUG           0x24    /**< Plug state (8-bit) */
+#define BTHOME_STATE_PRESENCE       0x25    /**< Presence (8-bit) */
+#define BTHOME_STATE_PROBLEM        0x26    /**< Problem detected (8-bit) */
+#define BTHOME_STATE_RUNNING        0x27    /**< Running state (8-bit) */
+#define BTHOME_STATE_SAFETY         0x28    /**< Safety state (8-bit) */
+#define BTHOME_STATE_SMOKE          0x29    /**< Smoke detected (8-bit) */
+#define BTHOME_STATE_SOUND          0x2A    /**< Sound detected (8-bit) */
+#define BTHOME_STATE_TAMPER         0x2B    /**< Tamper detected (8-bit) */
+#define BTHOME_STATE_VIBRATION      0x2C    /**< Vibration detected (8-bit) */
+#define BTHOME_STATE_WINDOW         0x2D    /**< Window state (8-bit) */
+
+/* BTHome v2 Object IDs - Additional Sensors */
+#define BTHOME_ID_HUMIDITY          0x2E    /**< Humidity (8-bit, %) */
+#define BTHOME_ID_MOISTURE          0x2F    /**< Moisture (8-bit, %) */
+
+/* BTHome v2 Object IDs - Events */
+#define BTHOME_EVENT_BUTTON         0x3A    /**< Button press event */
+#define BTHOME_EVENT_DIMMER         0x3C    /**< Dimmer event */
+
+/* BTHome v2 Object IDs - Extended Counters */
+#define BTHOME_ID_COUNT2            0x3D    /**< Count (16-bit) */
+#define BTHOME_ID_COUNT4            0x3E    /**< Count (32-bit) */
+
+/* BTHome v2 Object IDs - Additional Measurements */
+#define BTHOME_ID_ROTATION          0x3F    /**< Rotation (16-bit, 0.1°) */
+#define BTHOME_ID_DISTANCE          0x40    /**< Distance (16-bit, mm) */
+#define BTHOME_ID_DISTANCE_M        0x41    /**< Distance (16-bit, 0.1 m) */
+#define BTHOME_ID_DURATION          0x42    /**< Duration (24-bit, 0.001 s) */
+#define BTHOME_ID_CURRENT           0x43    /**< Current (16-bit, 0.001 A) */
+#define BTHOME_ID_SPEED             0x44    /**< Speed (16-bit, 0.01 m/s) */
+#define BTHOME_ID_TEMPERATURE       0x45    /**< Temperature (16-bit, 0.1°C) */
+#define BTHOME_ID_UV                0x46    /**< UV index (8-bit, 0.1) */
+#define BTHOME_ID_VOLUME1           0x47    /**< Volume (16-bit, 0.1 L) */
+#define BTHOME_ID_VOLUME2           0x48    /**< Volume (16-bit, mL) */
+#define BTHOME_ID_VOLUME_FLOW_RATE  0x49    /**< Volume flow rate (16-bit, 0.001 m³/hr) */
+#define BTHOME_ID_VOLTAGE1          0x4A    /**< Voltage (16-bit, 0.1 V) */
+#define BTHOME_ID_GAS               0x4B    /**< Gas (24-bit, 0.001 m³) */
+#define BTHOME_ID_GAS4              0x4C    /**< Gas (32-bit, 0.001 m³) */
+#define BTHOME_ID_ENERGY4           0x4D    /**< Energy (32-bit, 0.001 kWh) */
+#define BTHOME_ID_VOLUME            0x4E    /**< Volume (32-bit, 0.001 m³) */
+#define BTHOME_ID_WATER             0x4F    /**< Water (32-bit, 0.001 L) */
+#define BTHOME_ID_TIMESTAMP         0x50    /**< Timestamp (32-bit, Unix epoch) */
+
+/* BTHome v2 Object IDs - Variable Length, encoded as [ID][length][bytes] */
+#define BTHOME_ID_TEXT              0x53    /**< Text (UTF-8) */
+#define BTHOME_ID_RAW               0x54    /**< Raw bytes */
+
+/**
+ * @brief Fixed-size objects as X(arg, id, size, scale, is_signed)
+ *
+ * The single definition behind bthome_object_size(), bthome_object_scale()
+ * and bthome_object_is_signed(), the devicetree descriptors of
+ * <zephyr/bthome/dt.h> and the checks of the C++ object tags. X is
+ * expanded once per object, arg is passed through.
+ */
+#define BTHOME_OBJECT_TABLE(X, arg) \
+    X(arg, BTHOME_ID_PACKET,              1, 1,    false) \
+    X(arg, BTHOME_ID_BATTERY,             1, 1,    false) \
+    X(arg, BTHOME_ID_TEMPERATURE_PRECISE, 2, 100,  true)  \
+    X(arg, BTHOME_ID_HUMIDITY_PRECISE,    2, 100,  false) \
+    X(arg, BTHOME_ID_PRESSURE,            3, 100,  false) \
+    X(arg, BTHOME_ID_ILLUMINANCE,         3, 100,  false) \
+    X(arg, BTHOME_ID_MASS,                2, 100,  false) \
+    X(arg, BTHOME_ID_MASS_LB,             2, 100,  false) \
+    X(arg, BTHOME_ID_DEWPOINT,            2, 100,  true)  \
+    X(arg, BTHOME_ID_COUNT,               1, 1,    false) \
+    X(arg, BTHOME_ID_ENERGY,              3, 1000, false) \
+    X(arg, BTHOME_ID_POWER,               3, 100,  false) \
+    X(arg, BTHOME_ID_VOLTAGE,             2, 1000, false) \
+    X(arg, BTHOME_ID_PM25,                2, 1,    false) \
+    X(arg, BTHOME_ID_PM10,                2, 1,    false) \
+    X(arg, BTHOME_STATE_GENERIC_BOOLEAN,  1, 1,    false) \
+    X(arg, BTHOME_STATE_POWER_ON,         1, 1,    false) \
+    X(arg, BTHOME_STATE_OPENING,          1, 1,    false) \
+    X(arg, BTHOME_ID_CO2,                 2, 1,    false) \
+    X(arg, BTHOME_ID_TVOC,                2, 1,    false) \
+    X(arg, BTHOME_ID_MOISTURE_PRECISE,    2, 100,  false) \
+    X(arg, BTHOME_STATE_BATTERY_LOW,      1, 1,    false) \
+    X(arg, BTHOME_STATE_BATTERY_CHARGING, 1, 1,    false) \
+    X(arg, BTHOME_STATE_CO,               1, 1,    false) \
+    X(arg, BTHOME_STATE_COLD,             1, 1,    false) \
+    X(arg, BTHOME_STATE_CONNECTIVITY,     1, 1,    false) \
+    X(arg, BTHOME_STATE_DOOR,             1, 1,    false) \
+    X(arg, BTHOME_STATE_GARAGE_DOOR,      1, 1,    false) \
+    X(arg, BTHOME_STATE_GAS_DETECTED,     1, 1,    false) \
+    X(arg, BTHOME_STATE_HEAT,             1, 1,    false) \
+    X(arg, BTHOME_STATE_LIGHT,            1, 1,    false) \
+    X(arg, BTHOME_STATE_LOCK,             1, 1,    false) \
+    X(arg, BTHOME_STATE_MOISTURE,         1, 1,    false) \
+    X(arg, BTHOME_STATE_MOTION,           1, 1,    false) \
+    X(arg, BTHOME_STATE_MOVING,           1, 1,    false) \
+    X(arg, BTHOME_STATE_OCCUPANCY,        1, 1,    false) \
+    X(arg, BTHOME_STATE_PLUG,             1, 1,    false) \
+    X(arg, BTHOME_STATE_PRESENCE,         1, 1,    false) \
+    X(arg, BTHOME_STATE_PROBLEM,          1, 1,    false) \
+    X(arg, BTHOME_STATE_RUNNING,          1, 1,    false) \
+    X(arg, BTHOME_STATE_SAFETY,           1, 1,    false) \
+    X(arg, BTHOME_STATE_SMOKE,            1, 1,    false) \
+    X(arg, BTHOME_STATE_SOUND,            1, 1,    false) \
+    X(arg, BTHOME_STATE_TAMPER,           1, 1,    false) \
+    X(arg, BTHOME_STATE_VIBRATION,        1, 1,    false) \
+    X(arg, BTHOME_STATE_WINDOW,           1, 1,    false) \
+    X(arg, BTHOME_ID_HUMIDITY,            1, 1,    false) \
+    X(arg, BTHOME_ID_MOISTURE,            1, 1,    false) \
+    X(arg, BTHOME_EVENT_BUTTON,           1, 1,    false) \
+    X(arg, BTHOME_EVENT_DIMMER,           2, 1,    false) \
+    X(arg, BTHOME_ID_COUNT2,              2, 1,    false) \
+    X(arg, BTHOME_ID_COUNT4,              4, 1,    false) \
+    X(arg, BTHOME_ID_ROTATION,            2, 10,   true)  \
+    X(arg, BTHOME_ID_DISTANCE,            2, 1,    false) \
+    X(arg, BTHOME_ID_DISTANCE_M,          2, 10,   false) \
+    X(arg, BTHOME_ID_DURATION,            3, 1000, false) \
+    X(arg, BTHOME_ID_CURRENT,             2, 1000, false) \
+    X(arg, BTHOME_ID_SPEED,               2, 100,  false) \
+    X(arg, BTHOME_ID_TEMPERATURE,         2, 10,   true)  \
+    X(arg, BTHOME_ID_UV,                  1, 10,   false) \
+    X(arg, BTHOME_ID_VOLUME1,             2, 10,   false) \
+    X(arg, BTHOME_ID_VOLUME2,             2, 1,    false) \
+    X(arg, BTHOME_ID_VOLUME_FLOW_RATE,    2, 1000, false) \
+    X(arg, BTHOME_ID_VOLTAGE1,            2, 10,   false) \
+    X(arg, BTHOME_ID_GAS,                 3, 1000, false) \
+    X(arg, BTHOME_ID_GAS4,                4, 1000, false) \
+    X(arg, BTHOME_ID_ENERGY4,             4, 1000, false) \
+    X(arg, BTHOME_ID_VOLUME,              4, 1000, false) \
+    X(arg, BTHOME_ID_WATER,               4, 1000, false) \
+    X(arg, BTHOME_ID_TIMESTAMP,           4, 1,    false)
+
+/** @cond INTERNAL_HIDDEN */
+#define BTHOME_OBJECT_SIZE_IF(id, obj, size, scale, is_signed)  ((id) == (obj)) ? (size) :
+#define BTHOME_OBJECT_SCALE_IF(id, obj, size, scale, is_signed) ((id) == (obj)) ? (scale) :
+/** @endcond */
+
+/**
+ * @brief bthome_object_size() as an integer constant expression
+ */
+#define BTHOME_OBJECT_SIZE(id)      (BTHOME_OBJECT_TABLE(BTHOME_OBJECT_SIZE_IF, id) 0)
+
+/**
+ * @brief bthome_object_scale() as an integer constant expression
+ */
+#define BTHOME_OBJECT_SCALE(id)     (BTHOME_OBJECT_TABLE(BTHOME_OBJECT_SCALE_IF, id) 1)
+
+/* BTHome v2 Event Values */
+#define BTHOME_EVENT_BUTTON_NONE             0x00  /**< No button event */
+#define BTHOME_EVENT_BUTTON_PRESS            0x01  /**< Button press */
+#define BTHOME_EVENT_BUTTON_DOUBLE_PRESS     0x02  /**< Button double press */
+#define BTHOME_EVENT_BUTTON_TRIPLE_PRESS     0x03  /**< Button triple press */
+#define BTHOME_EVENT_BUTTON_LONG_PRESS       0x04  /**< Button long press */
+#define BTHOME_EVENT_BUTTON_LONG_DOUBLE_PRESS 0x05 /**< Button long double press */
+#define BTHOME_EVENT_BUTTON_LONG_TRIPLE_PRESS 0x06 /**< Button long triple press */
+
+#define BTHOME_EVENT_DIMMER_NONE    0x00    /**< No dimmer event */
+#define BTHOME_EVENT_DIMMER_LEFT    0x01    /**< Dimmer rotate left */
+#define BTHOME_EVENT_DIMMER_RIGHT   0x02    /**< Dimmer rotate right */
+
+/* BTHome v2 State Values */
+#define BTHOME_STATE_OFF            0x00    /**< State: OFF */
+#define BTHOME_STATE_ON             0x01    /**< State: ON */
+
+/* Counter (4) + MIC (4) appended after the encrypted objects */
+#define BTHOME_CRYPTO_OVERHEAD      8       /**< Encryption overhead in bytes */
+
+/** Service data: UUID (2) + device info (1) + payload */
+#define BTHOME_SERVICE_DATA_MAX     (3 + BTHOME_MAX_PAYLOAD_SIZE)
+
+#define BTHOME_CCM_NONCE_LEN        13      /**< AES-CCM nonce length */
+
+/* Use Kconfig for max decoded objects if available, otherwise default */
+#ifdef CONFIG_BTHOME_DECODE_MAX_OBJECTS
+#define BTHOME_DECODE_MAX_OBJECTS   CONFIG_BTHOME_DECODE_MAX_OBJECTS
+#else
+#define BTHOME_DECODE_MAX_OBJECTS   12      /**< Default max objects per decoded packet */
+#endif
+
+/**
+ * @brief Get the encoded value size of an object
+ *
+ * @param object_id BTHome object ID
+ * @return Value size in bytes, 0 for variable-length or unknown objects
+ */
+uint8_t bthome_object_size(uint8_t object_id);
+
+/**
+ * @brief Get the scale factor of an object
+ *
+ * @param object_id BTHome object ID
+ * @return Raw units per physical unit, 1 for unscaled objects
+ */
+uint16_t bthome_object_scale(uint8_t object_id);
+
+/**
+ * @brief Check whether an object carries a signed value
+ *
+ * @param object_id BTHome object ID
+ * @return true for two's complement values
+ */
+bool bthome_object_is_signed(uint8_t object_id);
+
+/**
+ * @brief Check whether an object is encoded as [ID][length][bytes]
+ *
+ * @param object_id BTHome object ID
+ * @return true for text and raw objects
+ */
+bool bthome_object_is_variable(uint8_t object_id);
+
+/**
+ * @brief Move the last object of a payload to its sorted position
+ *
+ * Objects are kept in ascending object ID order, after objects with the
+ * same ID. Unknown fixed-size objects are assumed to be 2 bytes, as the
+ * encoder does.
+ *
+ * @param buf Payload, sorted except for the last object
+ * @param len Length of the sorted part
+ * @param object_len Encoded length of the object at buf[len]
+ */
+void bthome_payload_sort_last(uint8_t *buf, uint8_t len, uint8_t object_len);
+
+/**
+ * @brief Append an object to a payload in sorted position
+ *
+ * @param buf Payload buffer
+ * @param len Payload length, updated
+ * @param max Maximum payload length (BTHOME_MAX_PAYLOAD_SIZE or
+ *            BTHOME_MAX_PAYLOAD_ENC)
+ * @param object_id BTHome object ID
+ * @param value Little-endian value bytes
+ * @param value_len Number of value bytes, must match the object size for
+ *                  fixed-size objects
+ * @return 0 on success, -EINVAL on a size mismatch, -ENOSPC if the object
+ *         does not fit
+ */
+int bthome_payload_append(uint8_t *buf, uint8_t *len, uint8_t max, uint8_t object_id,
+                          const uint8_t *value, uint8_t value_len);
+
+/**
+ * @brief AES-128 block cipher hook
+ *
+ * Embed in a backend structure and fill in the two callbacks. The codec
+ * tracks the loaded key so a cipher only rekeys when the sender changes.
+ * One instance must not be used from several threads at once.
+ */
+struct bthome_aes {
+    /** Load a 128-bit key */
+    int (*set_key)(struct bthome_aes *aes, const uint8_t key[16]);
+    /** Encrypt one block with the loaded key */
+    int (*encrypt)(struct bthome_aes *aes, const uint8_t in[16], uint8_t out[16]);
+    uint8_t key[16];                /**< Loaded key, managed by the codec */
+    bool key_valid;                 /**< key holds the loaded key */
+};
+
+/**
+ * @brief Load a key unless it is loaded already
+ *
+ * @param aes Cipher
+ * @param key 128-bit key
+ * @return 0 on success, negative error code from the backend
+ */
+int bthome_aes_load_key(struct bthome_aes *aes, const uint8_t key[16]);
+
+/**
+ * @brief Build the BTHome AES-CCM nonce
+ *
+ * @param nonce Output
+ * @param mac Sender address in bt_addr_t (little endian) order
+ * @param device_info Device info byte
+ * @param counter Encryption counter
+ */
+void bthome_ccm_nonce(uint8_t nonce[BTHOME_CCM_NONCE_LEN], const uint8_t mac[6],
+                      uint8_t device_info, uint32_t counter);
+
+/**
+ * @brief Compute the CTR keystream blocks S0 (MIC) and S1 (payload)
+ *
+ * Independent of the payload, so devices can compute it ahead of time.
+ *
+ * @param aes Cipher with the bind key loaded
+ * @param nonce Nonce of the packet
+ * @param s Keystream blocks
+ * @return 0 on success, negative error code from the backend
+ */
+int bthome_ccm_keystream(struct bthome_aes *aes, const uint8_t nonce[BTHOME_CCM_NONCE_LEN],
+                         uint8_t s[2][16]);
+
+/**
+ * @brief Encrypt a payload with a precomputed keystream
+ *
+ * @param aes Cipher with the bind key loaded
+ * @param nonce Nonce of the packet
+ * @param s Keystream from bthome_ccm_keystream() for this nonce
+ * @param plain Payload
+ * @param len Payload length, at most BTHOME_MAX_PAYLOAD_ENC
+ * @param counter Encryption counter contained in the nonce
+ * @param out Ciphertext, counter and MIC (len + BTHOME_CRYPTO_OVERHEAD)
+ * @return Number of bytes written, -EMSGSIZE if the payload is too long
+ */
+int bthome_ccm_seal(struct bthome_aes *aes, const uint8_t nonce[BTHOME_CCM_NONCE_LEN],
+                    const uint8_t s[2][16], const uint8_t *plain, uint8_t len,
+                    uint32_t counter, uint8_t *out);
+
+/**
+ * @brief Verify and decrypt ciphertext, counter and MIC
+ *
+ * @param aes Cipher with the bind key loaded
+ * @param mac Sender address in bt_addr_t (little endian) order
+ * @param device_info Device info byte
+ * @param in Ciphertext, counter and MIC
+ * @param len Length of in
+ * @param out Plaintext, at least len - BTHOME_CRYPTO_OVERHEAD bytes
+ * @param counter Encryption counter of the packet
+ * @return Plaintext length, -EBADMSG if malformed or the MIC does not
+ *         match, other negative error code from the backend
+ */
+int bthome_ccm_open(struct bthome_aes *aes, const uint8_t mac[6], uint8_t device_info,
+                    const uint8_t *in, uint8_t len, uint8_t *out, uint32_t *counter);
+
+/**
+ * @brief Encode BTHome service data
+ *
+ * @param aes Cipher, only used if key is set
+ * @param key Bind key, NULL for an unencrypted packet
+ * @param mac Sender address in bt_addr_t order, only used with key
+ * @param device_info Device info byte
+ * @param counter Encryption counter, only used with key
+ * @param payload Objects
+ * @param len Payload length
+ * @param out Service data starting with the 16-bit UUID
+ * @param size Size of out
+ * @return Number of bytes written, -EMSGSIZE if the payload is too long,
+ *         -ENOMEM if out is too small, negative error code on failure
+ */
+int bthome_codec_encode(struct bthome_aes *aes, const uint8_t key[16], const uint8_t mac[6],
+                        uint8_t device_info, uint32_t counter, const uint8_t *payload,
+                        uint8_t len, uint8_t *out, size_t size);
+
+/**
+ * @brief One decoded object
+ */
+struct bthome_object {
+    uint8_t object_id;              /**< BTHome object ID */
+    uint8_t len;                    /**< Value size in bytes */
+    /** Value, sign extended for signed objects; 0 for text and raw */
+    int64_t raw;
+    /** Value bytes inside bthome_packet.plain */
+    const uint8_t *data;
+};
+
+/**
+ * @brief Decoded BTHome packet
+ */
+struct bthome_packet {
+    uint8_t device_info;            /**< Device info byte */
+    bool encrypted;                 /**< Packet was encrypted */
+    bool trigger_based;             /**< Trigger-based device */
+    uint32_t counter;               /**< Encryption counter, 0 if plain */
+    uint8_t plain[BTHOME_MAX_PAYLOAD_SIZE]; /**< Plaintext payload */
+    uint8_t plain_len;              /**< Plaintext payload length */
+    uint8_t count;                  /**< Number of objects */
+    /** Objects in payload order */
+    struct bthome_object objects[BTHOME_DECODE_MAX_OBJECTS];
+};
+
+/**
+ * @brief Decode BTHome service data
+ *
+ * @param service_data Service data starting with the 16-bit UUID
+ * @param len Length of the service data
+ * @param mac Sender address in bt_addr_t (little endian) order, only
+ *            used for encrypted packets
+ * @param key Bind key of the sender, NULL if unknown
+ * @param aes Cipher for encrypted packets, NULL if not supported
+ * @param pkt Decoded packet
+ * @return 0 on success, -EBADMSG if the data is malformed or fails
+ *         authentication, -ENOTSUP for other UUIDs or versions, unknown
+ *         object IDs and encrypted packets without key or cipher,
+ *         -ENOMEM if the packet has more than BTHOME_DECODE_MAX_OBJECTS
+ *         objects
+ */
+int bthome_codec_decode(const uint8_t *service_data, size_t len, const uint8_t mac[6],
+                        const uint8_t key[16], struct bthome_aes *aes,
+                        struct bthome_packet *pkt);
+
+/**
+ * @brief Look up an object in a decoded packet
+ *
+ * @param pkt Decoded packet
+ * @param object_id BTHome object ID
+ * @return First object with that ID, NULL if not present
+ */
+const struct bthome_object *bthome_packet_find(const struct bthome_packet *pkt,
+                                               uint8_t object_id);
+
+/**
+ * @brief Hash a device address
+ *
+ * FNV-1a, stable across builds and reboots. Used for sensor tables,
+ * engine shards and advertising slots.
+ *
+ * @param mac Address in bt_addr_t (little endian) order
+ * @return 32-bit hash
+ */
+uint32_t bthome_mac_hash(const uint8_t mac[6]);
+
+/**
+ * @brief Per-sender state for dropping repeated receptions
+ *
+ * Zero-initialize before the first packet.
+ */
+struct bthome_dedup {
+    uint32_t last_counter;          /**< Counter of the last encrypted packet */
+    uint8_t last_packet_id;         /**< Packet ID of the last plain packet */
+    bool seen;                      /**< A packet has been accepted */
+};
+
+/**
+ * @brief Check whether a packet repeats an earlier one
+ *
+ * Scanners receive every advertisement on up to three channels. An
+ * encrypted packet is a repeat unless its counter is above the last
+ * accepted one, which also rejects replays and late packets. A plain
+ * packet is a repeat if it carries the same packet ID as the last one.
+ * Plain packets without a packet ID are always accepted.
+ *
+ * @param dedup State of the sender
+ * @param pkt Decoded packet
+ * @return true for a repeat, false if the packet was accepted and
+ *         remembered
+ */
+bool bthome_dedup_check(struct bthome_dedup *dedup, const struct bthome_packet *pkt);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BTHOME_CODEC_H_ */
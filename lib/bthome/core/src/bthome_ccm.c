@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <bthome_codec.h>
+
+#include <errno.h>
+#include <string.h>
+
+/*
+ * BTHome v2 uses AES-128-CCM with a 4-byte MIC (M = 4), a 2-byte length
+ * field (L = 2) and no associated data. The 13-byte nonce is
+ * MAC (6, as displayed) + UUID (2, little endian) + device info (1) +
+ * counter (4, little endian). Everything except the MAC-only part of
+ * the CBC-MAC is known before the measurement, so S0/S1 can be computed
+ * ahead of time and the hot path is one XOR plus two AES blocks.
+ */
+#define CCM_MIC_LEN         4
+#define CCM_FLAGS_CTR       0x01    /* L' = L - 1 */
+#define CCM_FLAGS_B0        0x09    /* M' = (M - 2) / 2 << 3 | L' */
+
+static void put_le32(uint32_t val, uint8_t *dst)
+{
+    dst[0] = val;
+    dst[1] = val >> 8;
+    dst[2] = val >> 16;
+    dst[3] = val >> 24;
+}
+
+static uint32_t get_le32(const uint8_t *src)
+{
+    return (uint32_t)src[0] | (uint32_t)src[1] << 8 | (uint32_t)src[2] << 16 |
+           (uint32_t)src[3] << 24;
+}
+
+int bthome_aes_load_key(struct bthome_aes *aes, const uint8_t key[16])
+{
+    int err;
+
+    if (aes->key_valid && memcmp(aes->key, key, sizeof(aes->key)) == 0) {
+        return 0;
+    }
+
+    err = aes->set_key(aes, key);
+    if (err) {
+        aes->key_valid = false;
+        return err;
+    }
+
+    memcpy(aes->key, key, sizeof(aes->key));
+    aes->key_valid = true;
+
+    return 0;
+}
+
+void bthome_ccm_nonce(uint8_t nonce[BTHOME_CCM_NONCE_LEN], const uint8_t mac[6],
+                      uint8_t device_info, uint32_t counter)
+{
+    /* bt_addr_t order to display order */
+    for (int i = 0; i < 6; i++) {
+        nonce[i] = mac[5 - i];
+    }
+    nonce[6] = BTHOME_SERVICE_UUID & 0xFF;
+    nonce[7] = BTHOME_SERVICE_UUID >> 8;
+    nonce[8] = device_info;
+    put_le32(counter, &nonce[9]);
+}
+
+int bthome_ccm_keystream(struct bthome_aes *aes, const uint8_t nonce[BTHOME_CCM_NONCE_LEN],
+                         uint8_t s[2][16])
+{
+    uint8_t block[16];
+    int err;
+
+    /* A_i = flags | nonce | i (big endian) */
+    block[0] = CCM_FLAGS_CTR;
+    memcpy(&block[1], nonce, BTHOME_CCM_NONCE_LEN);
+
+    for (uint8_t i = 0; i < 2; i++) {
+        block[14] = 0;
+        block[15] = i;
+        err = aes->encrypt(aes, block, s[i]);
+        if (err) {
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+/* CBC-MAC over at most one block of plaintext: T = E(E(B0) ^ B1) */
+static int ccm_tag(struct bthome_aes *aes, const uint8_t nonce[BTHOME_CCM_NONCE_LEN],
+                   const uint8_t *plain, uint8_t len, uint8_t tag[16])
+{
+    uint8_t block[16];
+    int err;
+
+    block[0] = CCM_FLAGS_B0;
+    memcpy(&block[1], nonce, BTHOME_CCM_NONCE_LEN);
+    block[14] = 0;
+    block[15] = len;
+    err = aes->encrypt(aes, block, tag);
+    if (err) {
+        return err;
+    }
+
+    for (uint8_t i = 0; i < len; i++) {
+        tag[i] ^= plain[i];
+    }
+
+    return aes->encrypt(aes, tag, tag);
+}
+
+int bthome_ccm_seal(struct bthome_aes *aes, const uint8_t nonce[BTHOME_CCM_NONCE_LEN],
+                    const uint8_t s[2][16], const uint8_t *plain, uint8_t len,
+                    uint32_t counter, uint8_t *out)
+{
+    uint8_t tag[16];
+    int err;
+
+    if (len > BTHOME_MAX_PAYLOAD_ENC) {
+        return -EMSGSIZE;
+    }
+
+    err = ccm_tag(aes, nonce, plain, len, tag);
+    if (err) {
+        return err;
+    }
+
+    /* CTR: C = P ^ S1, MIC = T ^ S0 */
+    for (uint8_t i = 0; i < len; i++) {
+        out[i] = plain[i] ^ s[1][i];
+    }
+    put_le32(counter, &out[len]);
+    for (uint8_t i = 0; i < CCM_MIC_LEN; i++) {
+        out[len + 4 + i] = tag[i] ^ s[0][i];
+    }
+
+    return len + BTHOME_CRYPTO_OVERHEAD;
+}
+
+int bthome_ccm_open(struct bthome_aes *aes, const uint8_t mac[6], uint8_t device_info,
+                    const uint8_t *in, uint8_t len, uint8_t *out, uint32_t *counter)
+{
+    uint8_t nonce[BTHOME_CCM_NONCE_LEN];
+    uint8_t s[2][16];
+    uint8_t tag[16];
+    uint8_t diff = 0;
+    uint8_t plain_len;
+    int err;
+
+    if (len < BTHOME_CRYPTO_OVERHEAD ||
+        len - BTHOME_CRYPTO_OVERHEAD > BTHOME_MAX_PAYLOAD_ENC) {
+        return -EBADMSG;
+    }
+
+    plain_len = len - BTHOME_CRYPTO_OVERHEAD;
+    *counter = get_le32(&in[plain_len]);
+
+    bthome_ccm_nonce(nonce, mac, device_info, *counter);
+    err = bthome_ccm_keystream(aes, nonce, s);
+    if (err) {
+        return err;
+    }
+
+    for (uint8_t i = 0; i < plain_len; i++) {
+        out[i] = in[i] ^ s[1][i];
+    }
+
+    err = ccm_tag(aes, nonce, out, plain_len, tag);
+    if (err) {
+        return err;
+    }
+
+    /* Constant time MIC comparison */
+    for (uint8_t i = 0; i < CCM_MIC_LEN; i++) {
+        diff |= in[plain_len + 4 + i] ^ tag[i] ^ s[0][i];
+    }
+
+    return diff ? -EBADMSG : plain_len;
+}
@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <bthome_codec.h>
+
+#include <errno.h>
+#include <string.h>
+
+#define BTHOME_INFO_ENCRYPT     0x01
+#define BTHOME_INFO_TRIGGER     0x04
+#define BTHOME_INFO_VERSION(x)  ((x) >> 5)
+
+/* The switches compile to lookup tables */
+#define BTHOME_OBJECT_SIZE_CASE(arg, obj, size, scale, is_signed)   case obj: return size;
+#define BTHOME_OBJECT_SCALE_CASE(arg, obj, size, scale, is_signed)  case obj: return scale;
+#define BTHOME_OBJECT_SIGNED_CASE(arg, obj, size, scale, is_signed) case obj: return is_signed;
+
+uint8_t bthome_object_size(uint8_t object_id)
+{
+    switch (object_id) {
+    BTHOME_OBJECT_TABLE(BTHOME_OBJECT_SIZE_CASE, _)
+    default:
+        return 0;
+    }
+}
+
+uint16_t bthome_object_scale(uint8_t object_id)
+{
+    switch (object_id) {
+    BTHOME_OBJECT_TABLE(BTHOME_OBJECT_SCALE_CASE, _)
+    default:
+        return 1;  /* No scaling */
+    }
+}
+
+bool bthome_object_is_signed(uint8_t object_id)
+{
+    switch (object_id) {
+    BTHOME_OBJECT_TABLE(BTHOME_OBJECT_SIGNED_CASE, _)
+    default:
+        return false;
+    }
+}
+
+bool bthome_object_is_variable(uint8_t object_id)
+{
+    return object_id == BTHOME_ID_TEXT || object_id == BTHOME_ID_RAW;
+}
+
+/* Encoded length including the ID, unknown fixed-size IDs count as 2 bytes */
+static uint8_t bthome_object_len(const uint8_t *object)
+{
+    uint8_t size;
+
+    if (bthome_object_is_variable(object[0])) {
+        return 2 + object[1];
+    }
+
+    size = bthome_object_size(object[0]);
+
+    return 1 + (size ? size : 2);
+}
+
+static void bthome_reverse(uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len / 2; i++) {
+        uint8_t tmp = buf[i];
+
+        buf[i] = buf[len - 1 - i];
+        buf[len - 1 - i] = tmp;
+    }
+}
+
+/* The payload is at most a few dozen bytes, so an in-place rotation is
+ * cheaper than any index structure.
+ */
+void bthome_payload_sort_last(uint8_t *buf, uint8_t len, uint8_t object_len)
+{
+    uint8_t pos = 0;
+
+    while (pos < len && buf[pos] <= buf[len]) {
+        pos += bthome_object_len(&buf[pos]);
+    }
+
+    if (pos >= len) {
+        return;
+    }
+
+    /* Rotate [pos, len + object_len) right by object_len */
+    bthome_reverse(&buf[pos], len - pos);
+    bthome_reverse(&buf[len], object_len);
+    bthome_reverse(&buf[pos], len + object_len - pos);
+}
+
+int bthome_payload_append(uint8_t *buf, uint8_t *len, uint8_t max, uint8_t object_id,
+                          const uint8_t *value, uint8_t value_len)
+{
+    uint8_t header = bthome_object_is_variable(object_id) ? 2 : 1;
+
+    if (header == 1 && value_len != bthome_object_size(object_id)) {
+        return -EINVAL;
+    }
+
+    if (*len + header + value_len > max) {
+        return -ENOSPC;
+    }
+
+    buf[*len] = object_id;
+    if (header == 2) {
+        buf[*len + 1] = value_len;
+    }
+    memcpy(&buf[*len + header], value, value_len);
+
+    bthome_payload_sort_last(buf, *len, header + value_len);
+    *len += header + value_len;
+
+    return 0;
+}
+
+int bthome_codec_encode(struct bthome_aes *aes, const uint8_t key[16], const uint8_t mac[6],
+                        uint8_t device_info, uint32_t counter, const uint8_t *payload,
+                        uint8_t len, uint8_t *out, size_t size)
+{
+    size_t needed = 3 + len + (key ? BTHOME_CRYPTO_OVERHEAD : 0);
+
+    if (len > (key ? BTHOME_MAX_PAYLOAD_ENC : BTHOME_MAX_PAYLOAD_SIZE)) {
+        return -EMSGSIZE;
+    }
+
+    if (size < needed) {
+        return -ENOMEM;
+    }
+
+    out[0] = BTHOME_SERVICE_UUID & 0xFF;
+    out[1] = BTHOME_SERVICE_UUID >> 8;
+    out[2] = device_info;
+
+    if (key) {
+        uint8_t nonce[BTHOME_CCM_NONCE_LEN];
+        uint8_t s[2][16];
+        int err;
+
+        if (!aes || !mac) {
+            return -EINVAL;
+        }
+
+        err = bthome_aes_load_key(aes, key);
+        if (err) {
+            return err;
+        }
+
+        bthome_ccm_nonce(nonce, mac, device_info, counter);
+        err = bthome_ccm_keystream(aes, nonce, s);
+        if (err) {
+            return err;
+        }
+
+        err = bthome_ccm_seal(aes, nonce, s, payload, len, counter, &out[3]);
+        return err < 0 ? err : 3 + err;
+    }
+
+    memcpy(&out[3], payload, len);
+
+    return 3 + len;
+}
+
+static int64_t bthome_decode_value(uint8_t object_id, const uint8_t *data, uint8_t len)
+{
+    uint64_t value = 0;
+
+    for (uint8_t i = 0; i < len; i++) {
+        value |= (uint64_t)data[i] << (8 * i);
+    }
+
+    if (bthome_object_is_signed(object_id) && len < sizeof(value) &&
+        (value & (1ULL << (8 * len - 1)))) {
+        value |= ~((1ULL << (8 * len)) - 1);
+    }
+
+    return (int64_t)value;
+}
+
+static int bthome_decode_objects(struct bthome_packet *pkt)
+{
+    uint8_t pos = 0;
+
+    pkt->count = 0;
+
+    while (pos < pkt->plain_len) {
+        uint8_t object_id = pkt->plain[pos++];
+        bool variable = bthome_object_is_variable(object_id);
+        struct bthome_object *obj;
+        uint8_t len;
+
+        if (variable) {
+            if (pos >= pkt->plain_len) {
+                return -EBADMSG;
+            }
+            len = pkt->plain[pos++];
+        } else {
+            len = bthome_object_size(object_id);
+            if (len == 0) {
+                /* Size unknown: the rest of the packet cannot be parsed */
+                return -ENOTSUP;
+            }
+        }
+
+        if (len > pkt->plain_len - pos) {
+            return -EBADMSG;
+        }
+
+        if (pkt->count == BTHOME_DECODE_MAX_OBJECTS) {
+            return -ENOMEM;
+        }
+
+        obj = &pkt->objects[pkt->count++];
+        obj->object_id = object_id;
+        obj->len = len;
+        obj->data = &pkt->plain[pos];
+        obj->raw = variable ? 0 : bthome_decode_value(object_id, obj->data, len);
+
+        pos += len;
+    }
+
+    return 0;
+}
+
+int bthome_codec_decode(const uint8_t *service_data, size_t len, const uint8_t mac[6],
+                        const uint8_t key[16], struct bthome_aes *aes,
+                        struct bthome_packet *pkt)
+{
+    const uint8_t *payload;
+    size_t payload_len;
+
+    if (!service_data || !pkt) {
+        return -EINVAL;
+    }
+
+    if (len < 3) {
+        return -EBADMSG;
+    }
+
+    if ((service_data[0] | service_data[1] << 8) != BTHOME_SERVICE_UUID ||
+        BTHOME_INFO_VERSION(service_data[2]) != 2) {
+        return -ENOTSUP;
+    }
+
+    pkt->device_info = service_data[2];
+    pkt->encrypted = pkt->device_info & BTHOME_INFO_ENCRYPT;
+    pkt->trigger_based = pkt->device_info & BTHOME_INFO_TRIGGER;
+    pkt->counter = 0;
+
+    payload = &service_data[3];
+    payload_len = len - 3;
+
+    if (pkt->encrypted) {
+        int ret;
+
+        if (!key || !mac || !aes) {
+            return -ENOTSUP;
+        }
+
+        if (payload_len > BTHOME_MAX_PAYLOAD_ENC + BTHOME_CRYPTO_OVERHEAD) {
+            return -EBADMSG;
+        }
+
+        ret = bthome_aes_load_key(aes, key);
+        if (ret) {
+            return ret;
+        }
+
+        ret = bthome_ccm_open(aes, mac, pkt->device_info, payload, payload_len,
+                              pkt->plain, &pkt->counter);
+        if (ret < 0) {
+            return ret;
+        }
+        pkt->plain_len = ret;
+    } else {
+        if (payload_len > sizeof(pkt->plain)) {
+            return -EBADMSG;
+        }
+
+        memcpy(pkt->plain, payload, payload_len);
+        pkt->plain_len = payload_len;
+    }
+
+    return bthome_decode_objects(pkt);
+}
+
+const struct bthome_object *bthome_packet_find(const struct bthome_packet *pkt,
+                                               uint8_t object_id)
+{
+    for (uint8_t i = 0; i < pkt->count; i++) {
+        if (pkt->objects[i].object_id == object_id) {
+            return &pkt->objects[i];
+        }
+    }
+
+    return NULL;
+}
+
+uint32_t bthome_mac_hash(const uint8_t mac[6])
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; i < 6; i++) {
+        hash = (hash ^ mac[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+bool bthome_dedup_check(struct bthome_dedup *dedup, const struct bthome_packet *pkt)
+{
+    const struct bthome_object *id = bthome_packet_find(pkt, BTHOME_ID_PACKET);
+
+    if (pkt->encrypted) {
+        /* Counter also protects against replays */
+        if (dedup->seen && pkt->counter <= dedup->last_counter) {
+            return true;
+        }
+        dedup->last_counter = pkt->counter;
+    } else if (id) {
+        if (dedup->seen && id->raw == dedup->last_packet_id) {
+            return true;
+        }
+        dedup->last_packet_id = id->raw;
+    }
+
+    dedup->seen = true;
+
+    return false;
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BTHOME_ARCHIVE_H_
+#define BTHOME_ARCHIVE_H_
+
+#include <bthome_batch.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Chunked columnar archive of decoded BTHome readings
+ *
+ * An archive is an 8-byte file header followed by self-contained chunks.
+ * A chunk holds up to chunk_rows rows. Its header has the row count,
+ * min/max timestamp and address, a bitmap of the object IDs it contains
+ * and a CRC-32. Its body holds four encoded columns:
+ *
+ * - timestamp: zigzag varint of the delta to the previous row
+ * - mac: per-chunk dictionary of addresses, varint index per row
+ * - object_id: one byte per row
+ * - raw: zigzag varint of the delta to the previous row with the same
+ *   object ID
+ *
+ * value is not stored. Readers rebuild it with bthome_batch_scale().
+ * Chunks are only appended, so a crash can at most truncate the last
+ * chunk. Readers ignore such a chunk and writers cut it off on reopen.
+ */
+
+/**
+ * @defgroup bthome_archive BTHome columnar archive
+ * @{
+ */
+
+/** Default rows per chunk */
+#define BTHOME_ARCHIVE_CHUNK_ROWS   65536
+
+/**
+ * @brief Archive writer
+ */
+struct bthome_archive_writer {
+    FILE *file;                     /**< Output file */
+    size_t chunk_rows;              /**< Rows per chunk */
+    struct bthome_columns pending;  /**< Rows not yet written */
+    uint64_t chunks;                /**< Chunks written since open */
+    uint64_t bytes;                 /**< Bytes written since open */
+};
+
+/**
+ * @brief Open an archive for appending, creating it if needed
+ *
+ * An incomplete chunk at the end of an existing archive is truncated.
+ *
+ * @param w Writer
+ * @param path File name
+ * @param chunk_rows Rows per chunk, 0 for BTHOME_ARCHIVE_CHUNK_ROWS
+ * @return 0 on success, -EBADMSG if the file is not an archive, -errno
+ */
+int bthome_archive_create(struct bthome_archive_writer *w, const char *path,
+                          size_t chunk_rows);
+
+/**
+ * @brief Append rows
+ *
+ * Rows are buffered and written as full chunks.
+ *
+ * @param w Writer
+ * @param cols Rows, value is ignored
+ * @return 0 on success, -errno on failure
+ */
+int bthome_archive_append(struct bthome_archive_writer *w, const struct bthome_columns *cols);
+
+/**
+ * @brief Write buffered rows as a (short) chunk
+ *
+ * @param w Writer
+ * @return 0 on success, -errno on failure
+ */
+int bthome_archive_flush(struct bthome_archive_writer *w);
+
+/**
+ * @brief Flush and close a writer
+ *
+ * @param w Writer
+ * @return 0 on success, -errno on failure
+ */
+int bthome_archive_finish(struct bthome_archive_writer *w);
+
+/**
+ * @brief Index entry of one chunk
+ */
+struct bthome_archive_chunk {
+    size_t offset;                  /**< Chunk header in the mapping */
+    uint32_t rows;                  /**< Rows in the chunk */
+    uint64_t ts_min;                /**< Earliest timestamp */
+    uint64_t ts_max;                /**< Latest timestamp */
+    uint64_t mac_min;               /**< Lowest address */
+    uint64_t mac_max;               /**< Highest address */
+    uint8_t ids[32];                /**< Bitmap of object IDs present */
+};
+
+/**
+ * @brief Memory-mapped archive reader
+ */
+struct bthome_archive {
+    const uint8_t *map;             /**< File contents */
+    size_t size;                    /**< File size */
+    struct bthome_archive_chunk *chunks; /**< Chunk index */
+    size_t count;                   /**< Number of complete chunks */
+    uint64_t rows;                  /**< Rows in all chunks */
+    bool truncated;                 /**< Trailing incomplete chunk ignored */
+};
+
+/**
+ * @brief Map an archive and index its chunk headers
+ *
+ * @param ar Reader
+ * @param path File name
+ * @return 0 on success, -EBADMSG if the file is not an archive, -errno
+ */
+int bthome_archive_open(struct bthome_archive *ar, const char *path);
+
+/**
+ * @brief Unmap an archive
+ *
+ * @param ar Reader
+ */
+void bthome_archive_close(struct bthome_archive *ar);
+
+/**
+ * @brief Row filter, all conditions must match
+ */
+struct bthome_archive_query {
+    uint64_t from_us;               /**< First timestamp, inclusive */
+    uint64_t to_us;                 /**< Last timestamp, exclusive, 0 for no limit */
+    bool match_mac;                 /**< Only rows of mac */
+    uint64_t mac;                   /**< Address as in bthome_columns */
+    int object_id;                  /**< Only this object ID, -1 for all */
+};
+
+/**
+ * @brief Counters of a query
+ */
+struct bthome_archive_stats {
+    size_t chunks;                  /**< Chunks in the archive */
+    size_t skipped;                 /**< Chunks excluded by their index */
+    size_t decoded;                 /**< Chunks decoded */
+    size_t corrupt;                 /**< Chunks with a CRC or encoding error */
+    uint64_t scanned;               /**< Rows decoded */
+};
+
+/**
+ * @brief Append the rows matching a query
+ *
+ * Chunks whose time range, address range or object ID bitmap cannot
+ * match are skipped without touching their body.
+ *
+ * @param ar Reader
+ * @param query Filter
+ * @param out Columns to append to, value included
+ * @param stats Counters, may be NULL
+ * @return Rows appended, -ENOMEM
+ */
+long bthome_archive_query(const struct bthome_archive *ar, const struct bthome_archive_query *query,
+                          struct bthome_columns *out, struct bthome_archive_stats *stats);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BTHOME_ARCHIVE_H_ */
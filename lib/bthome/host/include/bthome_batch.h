@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BTHOME_BATCH_H_
+#define BTHOME_BATCH_H_
+
+#include <bthome_host.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Batch decoding of BTHome frames into columns
+ *
+ * Decodes many frames into one row per numeric object, stored as a
+ * structure of arrays. Parsing and decryption run frame by frame. The
+ * sign extension and scaling of all rows then run as one pass over the
+ * columns with SSE2, AVX2 or NEON.
+ */
+
+/**
+ * @defgroup bthome_batch BTHome batch decoder
+ * @{
+ */
+
+/** Implementations of the scaling pass */
+enum bthome_simd {
+    BTHOME_SIMD_AUTO,               /**< Best one supported by the CPU */
+    BTHOME_SIMD_SCALAR,             /**< Portable C */
+    BTHOME_SIMD_SSE2,               /**< x86-64 baseline, 4 rows per step */
+    BTHOME_SIMD_AVX2,               /**< 8 rows per step */
+    BTHOME_SIMD_NEON,               /**< AArch64, 4 rows per step */
+};
+
+/**
+ * @brief Decoded rows, one per numeric object
+ *
+ * Text and raw objects have no numeric value and are not stored.
+ */
+struct bthome_columns {
+    size_t count;                   /**< Rows in use */
+    size_t cap;                     /**< Rows allocated */
+    uint64_t *timestamp_us;         /**< Capture time of the frame */
+    uint64_t *mac;                  /**< Advertiser, bt_addr_t byte 0 in bits 0-7 */
+    uint8_t *object_id;             /**< BTHome object ID */
+    uint32_t *raw;                  /**< Value bytes, little endian, zero extended */
+    double *value;                  /**< Sign extended and scaled value */
+};
+
+/**
+ * @brief Counters of a batch decode
+ */
+struct bthome_batch_stats {
+    size_t frames;                  /**< Frames in the batch */
+    size_t decoded;                 /**< Frames that produced rows */
+    size_t bad;                     /**< -EBADMSG: malformed or MIC mismatch */
+    size_t unsupported;             /**< -ENOTSUP: unknown object or no key */
+    size_t skipped;                 /**< Text and raw objects not stored */
+};
+
+/**
+ * @brief Allocate columns
+ *
+ * @param cols Columns
+ * @param cap Initial rows, grown as needed
+ * @return 0 on success, -ENOMEM
+ */
+int bthome_columns_init(struct bthome_columns *cols, size_t cap);
+
+/**
+ * @brief Make room for more rows
+ *
+ * @param cols Columns
+ * @param rows Rows to be appended after count
+ * @return 0 on success, -ENOMEM
+ */
+int bthome_columns_reserve(struct bthome_columns *cols, size_t rows);
+
+/**
+ * @brief Free columns
+ *
+ * @param cols Columns
+ */
+void bthome_columns_free(struct bthome_columns *cols);
+
+/**
+ * @brief Decode frames and append their objects as rows
+ *
+ * A frame that fails to decode adds no rows. Encrypted frames need a key
+ * in keys and an aes instance; they are counted as unsupported otherwise.
+ *
+ * @param frames Frames
+ * @param count Number of frames
+ * @param keys Bind keys, may be NULL
+ * @param aes Cipher, may be NULL
+ * @param cols Columns to append to
+ * @param stats Counters, added to, may be NULL
+ * @return Rows appended, -ENOMEM if the columns cannot grow
+ */
+long bthome_batch_decode(const struct bthome_frame *frames, size_t count,
+                         const struct bthome_keys *keys, struct bthome_aes *aes,
+                         struct bthome_columns *cols, struct bthome_batch_stats *stats);
+
+/**
+ * @brief Sign extend and scale raw values
+ *
+ * value[i] = sign_extend(raw[i]) / bthome_object_scale(object_id[i]),
+ * bit-identical across implementations.
+ *
+ * @param object_id Object IDs
+ * @param raw Zero-extended value bytes
+ * @param value Output
+ * @param count Number of rows
+ * @param simd Implementation, unsupported ones fall back to scalar
+ */
+void bthome_batch_scale(const uint8_t *object_id, const uint32_t *raw, double *value,
+                        size_t count, enum bthome_simd simd);
+
+/**
+ * @brief Select the implementation used by bthome_batch_decode()
+ *
+ * @param simd Implementation
+ * @return 0 on success, -ENOTSUP if the CPU or build lacks it
+ */
+int bthome_batch_set_simd(enum bthome_simd simd);
+
+/**
+ * @brief Check whether an implementation is available
+ *
+ * @param simd Implementation
+ * @return true if supported by this build and CPU
+ */
+bool bthome_batch_simd_supported(enum bthome_simd simd);
+
+/**
+ * @brief Name of an implementation
+ *
+ * @param simd Implementation, BTHOME_SIMD_AUTO resolves to the selected one
+ * @return Name, e.g. "avx2"
+ */
+const char *bthome_batch_simd_name(enum bthome_simd simd);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BTHOME_BATCH_H_ */
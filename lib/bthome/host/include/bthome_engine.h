@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BTHOME_ENGINE_H_
+#define BTHOME_ENGINE_H_
+
+#include <bthome_host.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Sharded multithreaded BTHome decode engine
+ *
+ * Frames are assigned to a shard by a hash of the advertiser address. Each
+ * shard has one worker thread. Its bounded lock-free MPSC queue takes
+ * frames from any number of scanner threads. Every sensor is owned by
+ * exactly one shard, so the sensor table, the AES instance and the
+ * statistics of a shard are only touched by its worker and need no locks.
+ */
+
+/**
+ * @defgroup bthome_engine BTHome decode engine
+ * @{
+ */
+
+/** Engine handle */
+struct bthome_engine;
+
+/**
+ * @brief Called on the worker thread for every new decoded packet
+ *
+ * Duplicates (same packet ID or encryption counter as the previous packet
+ * of the sensor) are filtered before the callback.
+ *
+ * @param shard Index of the calling shard
+ * @param frame Advertiser, capture time and service data
+ * @param pkt Decoded packet
+ * @param user User pointer from the configuration
+ */
+typedef void (*bthome_engine_cb)(unsigned int shard, const struct bthome_frame *frame,
+                                 const struct bthome_packet *pkt, void *user);
+
+/**
+ * @brief Engine configuration
+ */
+struct bthome_engine_config {
+    unsigned int shards;            /**< Worker threads, 0 for one per CPU */
+    unsigned int queue_len;         /**< Frames per shard queue, power of two, 0 for 4096 */
+    bool pin;                       /**< Pin worker n to CPU n */
+    const struct bthome_keys *keys; /**< Bind keys, read-only while running, may be NULL */
+    bthome_engine_cb cb;            /**< Packet callback, may be NULL */
+    void *user;                     /**< Passed to cb */
+};
+
+/**
+ * @brief Per-shard counters
+ */
+struct bthome_engine_stats {
+    uint64_t frames;                /**< Frames taken from the queue */
+    uint64_t decoded;               /**< New packets passed to the callback */
+    uint64_t duplicates;            /**< Repeated packet ID or counter */
+    uint64_t objects;               /**< Objects in new packets */
+    uint64_t bad;                   /**< -EBADMSG: malformed or MIC mismatch */
+    uint64_t unsupported;           /**< -ENOTSUP: unknown object or no key */
+    uint64_t stalls;                /**< Submits that found the queue full */
+    uint32_t sensors;               /**< Sensors owned by the shard */
+};
+
+/**
+ * @brief Create the shards and start the workers
+ *
+ * @param engine Output handle
+ * @param cfg Configuration, copied
+ * @return 0 on success, -EINVAL for a bad queue length, -ENOMEM, or
+ *         -errno if a thread cannot be created
+ */
+int bthome_engine_start(struct bthome_engine **engine, const struct bthome_engine_config *cfg);
+
+/**
+ * @brief Queue a frame for decoding
+ *
+ * Safe to call from any number of threads. The service data is copied, so
+ * the frame may be reused as soon as this returns. Yields while the shard
+ * queue is full.
+ *
+ * @param engine Engine
+ * @param frame Frame
+ * @return 0 on success, -EMSGSIZE if the service data is too long,
+ *         -ESHUTDOWN after bthome_engine_stop() has been called
+ */
+int bthome_engine_submit(struct bthome_engine *engine, const struct bthome_frame *frame);
+
+/**
+ * @brief Drain all queues, stop the workers and free the engine
+ *
+ * Call after all producers have returned from bthome_engine_submit().
+ *
+ * @param engine Engine
+ * @param stats Per-shard counters, bthome_engine_shards() entries, may be NULL
+ */
+void bthome_engine_stop(struct bthome_engine *engine, struct bthome_engine_stats *stats);
+
+/**
+ * @brief Number of shards
+ *
+ * @param engine Engine
+ * @return Worker threads
+ */
+unsigned int bthome_engine_shards(const struct bthome_engine *engine);
+
+/**
+ * @brief Shard that owns an advertiser
+ *
+ * @param engine Engine
+ * @param mac Advertiser, bt_addr_t order
+ * @return Shard index
+ */
+unsigned int bthome_engine_shard_of(const struct bthome_engine *engine, const uint8_t mac[6]);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BTHOME_ENGINE_H_ */
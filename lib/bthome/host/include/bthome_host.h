@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BTHOME_HOST_H_
+#define BTHOME_HOST_H_
+
+#include <bthome_codec.h>
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Host (Linux) helpers around the BTHome codec
+ *
+ * Memory-mapped capture files, a bind key table and an OpenSSL AES
+ * backend for struct bthome_aes.
+ */
+
+/**
+ * @defgroup bthome_host BTHome host helpers
+ * @{
+ */
+
+/**
+ * @brief One BTHome service data element found in a capture
+ */
+struct bthome_frame {
+    uint64_t timestamp_us;          /**< Capture time, Unix epoch */
+    uint8_t mac[6];                 /**< Advertiser, bt_addr_t order */
+    uint8_t len;                    /**< Service data length */
+    const uint8_t *data;            /**< Service data from the UUID on */
+};
+
+/** Capture file formats */
+enum bthome_capture_format {
+    BTHOME_CAPTURE_BTSNOOP,         /**< btsnoop, HCI H4 or unencapsulated */
+    BTHOME_CAPTURE_PCAP,            /**< pcap, HCI H4 or LE link layer */
+};
+
+/**
+ * @brief Memory-mapped capture file
+ */
+struct bthome_capture {
+    const uint8_t *map;             /**< File contents */
+    size_t size;                    /**< File size */
+    enum bthome_capture_format format; /**< Detected format */
+    uint32_t linktype;              /**< btsnoop datalink or pcap DLT */
+    bool swapped;                   /**< pcap written with other endianness */
+    bool nsec;                      /**< pcap timestamps in nanoseconds */
+};
+
+/** Callback for every BTHome element, non-zero stops the scan */
+typedef int (*bthome_frame_cb)(const struct bthome_frame *frame, void *user);
+
+/**
+ * @brief Map a btsnoop or pcap file
+ *
+ * @param cap Capture
+ * @param path File name
+ * @return 0 on success, -errno if the file cannot be mapped, -ENOTSUP
+ *         for unknown formats or link types
+ */
+int bthome_capture_open(struct bthome_capture *cap, const char *path);
+
+/**
+ * @brief Unmap a capture
+ *
+ * @param cap Capture
+ */
+void bthome_capture_close(struct bthome_capture *cap);
+
+/**
+ * @brief Find all BTHome service data elements
+ *
+ * Walks HCI LE advertising reports (legacy and extended) or link layer
+ * advertising PDUs and calls cb for every service data element with the
+ * BTHome UUID. Frames point into the mapping and stay valid until
+ * bthome_capture_close().
+ *
+ * @param cap Capture
+ * @param cb Callback
+ * @param user Passed to cb
+ * @return Number of frames, -EBADMSG if the file is truncated, or the
+ *         non-zero value returned by cb
+ */
+long bthome_capture_scan(const struct bthome_capture *cap, bthome_frame_cb cb, void *user);
+
+/**
+ * @brief Capture writer
+ */
+struct bthome_capture_writer {
+    FILE *file;                     /**< Output file */
+    enum bthome_capture_format format; /**< Output format */
+};
+
+/**
+ * @brief Create a capture with HCI H4 packets
+ *
+ * @param w Writer
+ * @param path File name
+ * @param format btsnoop (datalink 1002) or pcap (DLT 201)
+ * @return 0 on success, -errno on failure
+ */
+int bthome_capture_create(struct bthome_capture_writer *w, const char *path,
+                          enum bthome_capture_format format);
+
+/**
+ * @brief Write service data as an HCI LE advertising report
+ *
+ * @param w Writer
+ * @param frame Advertiser, time and service data
+ * @return 0 on success, -errno on failure
+ */
+int bthome_capture_write(struct bthome_capture_writer *w, const struct bthome_frame *frame);
+
+/**
+ * @brief Close a capture writer
+ *
+ * @param w Writer
+ * @return 0 on success, -errno on failure
+ */
+int bthome_capture_finish(struct bthome_capture_writer *w);
+
+/**
+ * @brief Bind key of one device
+ */
+struct bthome_key {
+    uint8_t mac[6];                 /**< Device, bt_addr_t order */
+    uint8_t key[16];                /**< Bind key */
+};
+
+/**
+ * @brief Bind keys sorted by address
+ */
+struct bthome_keys {
+    struct bthome_key *entries;     /**< Sorted entries */
+    size_t count;                   /**< Number of entries */
+};
+
+/**
+ * @brief Parse "AA:BB:CC:DD:EE:FF" into bt_addr_t order
+ *
+ * @param str Address as displayed
+ * @param mac Output
+ * @return 0 on success, -EINVAL if malformed
+ */
+int bthome_parse_mac(const char *str, uint8_t mac[6]);
+
+/**
+ * @brief Add a key given as "AA:BB:CC:DD:EE:FF=<32 hex digits>"
+ *
+ * @param keys Key table
+ * @param spec Address and key
+ * @return 0 on success, -EINVAL if malformed, -ENOMEM
+ */
+int bthome_keys_add(struct bthome_keys *keys, const char *spec);
+
+/**
+ * @brief Load keys from a file, one "MAC=KEY" per line, '#' comments
+ *
+ * @param keys Key table
+ * @param path File name
+ * @return Number of keys read, negative error code on failure
+ */
+int bthome_keys_load(struct bthome_keys *keys, const char *path);
+
+/**
+ * @brief Look up the key of a device
+ *
+ * @param keys Key table
+ * @param mac Device, bt_addr_t order
+ * @return Key, NULL if unknown
+ */
+const uint8_t *bthome_keys_find(const struct bthome_keys *keys, const uint8_t mac[6]);
+
+/**
+ * @brief Free a key table
+ *
+ * @param keys Key table
+ */
+void bthome_keys_free(struct bthome_keys *keys);
+
+/**
+ * @brief Create an AES backend for the codec
+ *
+ * Uses OpenSSL if the library was built with it. Each thread needs its
+ * own instance.
+ *
+ * @return Cipher, NULL if no AES implementation is available
+ */
+struct bthome_aes *bthome_host_aes_new(void);
+
+/**
+ * @brief Free an AES backend
+ *
+ * @param aes Cipher from bthome_host_aes_new(), may be NULL
+ */
+void bthome_host_aes_free(struct bthome_aes *aes);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BTHOME_HOST_H_ */
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BTHOME_MQTT_H_
+#define BTHOME_MQTT_H_
+
+#include <bthome_batch.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Batched, pipelined MQTT 3.1.1 publisher for decoded readings
+ *
+ * Readings are grouped per sensor into one QoS 1 PUBLISH on
+ * "<prefix>/<MAC>". The payload is a JSON array of
+ * {"t":seconds,"id":object_id,"v":value}. A batch is sent when it is
+ * full or older than the flush interval. Up to window publishes stay
+ * unacknowledged at a time, so throughput is not bound by the broker
+ * round trip.
+ *
+ * Each batch is formatted straight from the columns into its packet
+ * buffer, which has headroom for the MQTT header. The buffer is sent as
+ * is and kept until the PUBACK arrives. No further copies are made.
+ *
+ * A lost connection, a missing CONNACK or PINGRESP, or a protocol error
+ * makes the publisher reconnect. The unacknowledged window is then sent
+ * again with the DUP flag and its original packet IDs, ahead of the
+ * queued publishes. The broker starts a clean session, so a reading may
+ * arrive twice but none is lost.
+ */
+
+/**
+ * @defgroup bthome_mqtt BTHome MQTT publisher
+ * @{
+ */
+
+/** Publisher handle */
+struct bthome_mqtt;
+
+/**
+ * @brief Publisher configuration
+ */
+struct bthome_mqtt_config {
+    const char *host;               /**< Broker host name or address */
+    uint16_t port;                  /**< Broker port, 0 for 1883 */
+    const char *client_id;          /**< Client identifier, NULL for "bthome-<pid>" */
+    const char *prefix;             /**< Topic prefix, NULL for "bthome" */
+    unsigned int window;            /**< Unacknowledged publishes, 0 for 64 */
+    unsigned int batch;             /**< Readings per publish, 0 for 32 */
+    unsigned int flush_ms;          /**< Longest a reading waits in a batch, 0 for 100 */
+    uint16_t keepalive;             /**< Keep alive in seconds, 0 for 60 */
+    unsigned int timeout_ms;        /**< Wait for CONNACK and PINGRESP, 0 for 5000 */
+    unsigned int retry_ms;          /**< Delay between reconnect attempts, 0 for 1000 */
+    int reconnects;                 /**< Attempts per reconnect, 0 for 5, negative for none */
+};
+
+/**
+ * @brief Publisher counters
+ */
+struct bthome_mqtt_stats {
+    uint64_t readings;              /**< Rows queued */
+    uint64_t publishes;             /**< PUBLISH packets sent, not counting retransmits */
+    uint64_t acked;                 /**< PUBACKs received */
+    uint64_t bytes;                 /**< Bytes sent */
+    uint64_t reconnects;            /**< Successful reconnects */
+    uint64_t retransmits;           /**< Publishes sent again with the DUP flag */
+    unsigned int max_inflight;      /**< Highest number of unacknowledged publishes */
+};
+
+/**
+ * @brief Connect to a broker
+ *
+ * Blocks until the CONNACK arrives. The first connection is not retried.
+ *
+ * @param mqtt Output handle
+ * @param cfg Configuration, copied with the host and client ID strings
+ * @return 0 on success, -ECONNREFUSED if the broker rejects the client,
+ *         -ETIMEDOUT without a CONNACK, -EINVAL for a host or client ID
+ *         that is too long, -ENOMEM, or -errno from name resolution or
+ *         the socket
+ */
+int bthome_mqtt_connect(struct bthome_mqtt **mqtt, const struct bthome_mqtt_config *cfg);
+
+/**
+ * @brief Queue rows for publishing
+ *
+ * Adds each row to the batch of its sensor and sends full batches. Waits
+ * for acknowledgements while too many publishes are queued.
+ *
+ * @param mqtt Publisher
+ * @param cols Decoded rows, value must be filled in
+ * @return 0 on success, -ENOMEM, or the error of the lost connection if
+ *         every reconnect attempt failed
+ */
+int bthome_mqtt_publish(struct bthome_mqtt *mqtt, const struct bthome_columns *cols);
+
+/**
+ * @brief Send what the window allows, read acknowledgements, flush old batches
+ *
+ * Call regularly, also when no new rows arrive: keep alive and the
+ * PINGRESP timeout are handled here. Reconnects block for up to
+ * reconnects * retry_ms.
+ *
+ * @param mqtt Publisher
+ * @param timeout_ms Longest wait for the socket, 0 to only poll
+ * @return 0 on success, -ETIMEDOUT, -EPROTO or -errno of the lost
+ *         connection if every reconnect attempt failed
+ */
+int bthome_mqtt_poll(struct bthome_mqtt *mqtt, int timeout_ms);
+
+/**
+ * @brief Send all batches and wait until every publish is acknowledged
+ *
+ * @param mqtt Publisher
+ * @param timeout_ms Longest total wait
+ * @return 0 on success, -ETIMEDOUT, -EPROTO or -errno
+ */
+int bthome_mqtt_drain(struct bthome_mqtt *mqtt, int timeout_ms);
+
+/**
+ * @brief Disconnect and free the publisher
+ *
+ * Unacknowledged publishes are dropped; call bthome_mqtt_drain() first.
+ *
+ * @param mqtt Publisher
+ * @param stats Counters, may be NULL
+ */
+void bthome_mqtt_close(struct bthome_mqtt *mqtt, struct bthome_mqtt_stats *stats);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BTHOME_MQTT_H_ */
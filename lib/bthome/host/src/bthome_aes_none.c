@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <bthome_host.h>
+
+/* Built without OpenSSL: encrypted packets are rejected with -ENOTSUP */
+struct bthome_aes *bthome_host_aes_new(void)
+{
+    return NULL;
+}
+
+void bthome_host_aes_free(struct bthome_aes *aes)
+{
+    (void)aes;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <bthome_host.h>
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <openssl/evp.h>
+
+struct openssl_aes {
+    struct bthome_aes aes;
+    EVP_CIPHER_CTX *ctx;
+};
+
+#define TO_OPENSSL(a) ((struct openssl_aes *)((char *)(a) - offsetof(struct openssl_aes, aes)))
+
+static int openssl_set_key(struct bthome_aes *aes, const uint8_t key[16])
+{
+    EVP_CIPHER_CTX *ctx = TO_OPENSSL(aes)->ctx;
+
+    if (EVP_EncryptInit_ex(ctx, EVP_aes_128_ecb(), NULL, key, NULL) != 1) {
+        return -EIO;
+    }
+
+    EVP_CIPHER_CTX_set_padding(ctx, 0);
+
+    return 0;
+}
+
+static int openssl_encrypt(struct bthome_aes *aes, const uint8_t in[16], uint8_t out[16])
+{
+    int len;
+
+    if (EVP_EncryptUpdate(TO_OPENSSL(aes)->ctx, out, &len, in, 16) != 1 || len != 16) {
+        return -EIO;
+    }
+
+    return 0;
+}
+
+struct bthome_aes *bthome_host_aes_new(void)
+{
+    struct openssl_aes *o = calloc(1, sizeof(*o));
+
+    if (!o) {
+        return NULL;
+    }
+
+    o->ctx = EVP_CIPHER_CTX_new();
+    if (!o->ctx) {
+        free(o);
+        return NULL;
+    }
+
+    o->aes.set_key = openssl_set_key;
+    o->aes.encrypt = openssl_encrypt;
+
+    return &o->aes;
+}
+
+void bthome_host_aes_free(struct bthome_aes *aes)
+{
+    if (aes) {
+        EVP_CIPHER_CTX_free(TO_OPENSSL(aes)->ctx);
+        free(TO_OPENSSL(aes));
+    }
+}
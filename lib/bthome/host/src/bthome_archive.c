@@ -0,0 +1,627 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <bthome_archive.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FILE_MAGIC          "BTHA"
+#define FILE_VERSION        1
+#define FILE_HEADER_SIZE    8
+
+/*
+ * Chunk header, little endian:
+ *   0  "BTHC"          4  rows          8  body size     12 body CRC-32
+ *  16  ts_min         24  ts_max       32  mac_min       40 mac_max
+ *  48  column sizes (timestamp, mac, object_id, raw), 4 x u32
+ *  64  object ID bitmap, 32 bytes
+ *  96  header CRC-32 over bytes 0-95
+ */
+#define CHUNK_MAGIC         "BTHC"
+#define CHUNK_HEADER_SIZE   100
+#define COLUMNS             4
+
+#define VARINT_MAX          10
+
+static uint32_t crc_table[256];
+static pthread_once_t crc_once = PTHREAD_ONCE_INIT;
+
+static void crc_init(void)
+{
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+
+        for (int k = 0; k < 8; k++) {
+            c = c & 1 ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+        }
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t crc32(const uint8_t *data, size_t len)
+{
+    uint32_t c = 0xFFFFFFFFU;
+
+    pthread_once(&crc_once, crc_init);
+
+    for (size_t i = 0; i < len; i++) {
+        c = crc_table[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    }
+
+    return c ^ 0xFFFFFFFFU;
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) {
+        p[i] = v >> (8 * i);
+    }
+}
+
+static void put_le64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++) {
+        p[i] = v >> (8 * i);
+    }
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint64_t get_le64(const uint8_t *p)
+{
+    return (uint64_t)get_le32(p) | (uint64_t)get_le32(p + 4) << 32;
+}
+
+static uint64_t zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v)
+{
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static uint8_t *put_varint(uint8_t *p, uint64_t v)
+{
+    while (v >= 0x80) {
+        *p++ = v | 0x80;
+        v >>= 7;
+    }
+    *p++ = v;
+
+    return p;
+}
+
+/* Returns the position after the varint, NULL if it runs past end */
+static const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint64_t *v)
+{
+    uint64_t value = 0;
+
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *v = value;
+            return p;
+        }
+    }
+
+    return NULL;
+}
+
+/* Address dictionary of one chunk, open addressing */
+struct dict {
+    uint64_t *keys;
+    uint32_t *index;
+    uint32_t size;
+    uint32_t count;
+    uint64_t *order;                /* Addresses by index */
+};
+
+static int dict_init(struct dict *d, size_t rows)
+{
+    d->size = 16;
+    while (d->size < 2 * rows) {
+        d->size *= 2;
+    }
+
+    d->count = 0;
+    d->keys = malloc(d->size * sizeof(*d->keys));
+    d->index = malloc(d->size * sizeof(*d->index));
+    d->order = malloc(rows * sizeof(*d->order));
+    if (!d->keys || !d->index || !d->order) {
+        return -ENOMEM;
+    }
+
+    memset(d->index, 0xFF, d->size * sizeof(*d->index));
+
+    return 0;
+}
+
+static void dict_free(struct dict *d)
+{
+    free(d->keys);
+    free(d->index);
+    free(d->order);
+}
+
+static uint32_t dict_add(struct dict *d, uint64_t mac)
+{
+    uint32_t pos = (uint32_t)((mac * 0x9E3779B97F4A7C15ULL) >> 32) & (d->size - 1);
+
+    while (d->index[pos] != UINT32_MAX) {
+        if (d->keys[pos] == mac) {
+            return d->index[pos];
+        }
+        pos = (pos + 1) & (d->size - 1);
+    }
+
+    d->keys[pos] = mac;
+    d->index[pos] = d->count;
+    d->order[d->count] = mac;
+
+    return d->count++;
+}
+
+/* Encode rows [0, rows) of cols as one chunk and write it */
+static int write_chunk(struct bthome_archive_writer *w, const struct bthome_columns *cols,
+                       size_t rows)
+{
+    uint8_t header[CHUNK_HEADER_SIZE] = CHUNK_MAGIC;
+    int64_t prev_raw[256] = { 0 };
+    uint32_t sizes[COLUMNS];
+    uint64_t ts_min = UINT64_MAX, ts_max = 0, mac_min = UINT64_MAX, mac_max = 0;
+    uint64_t prev_ts;
+    struct dict dict = { 0 };
+    uint8_t *body;
+    uint8_t *idx;
+    uint8_t *p;
+    uint8_t *q;
+    size_t size;
+    int err = 0;
+
+    for (size_t i = 0; i < rows; i++) {
+        uint64_t ts = cols->timestamp_us[i];
+        uint64_t mac = cols->mac[i];
+
+        ts_min = ts < ts_min ? ts : ts_min;
+        ts_max = ts > ts_max ? ts : ts_max;
+        mac_min = mac < mac_min ? mac : mac_min;
+        mac_max = mac > mac_max ? mac : mac_max;
+        header[64 + cols->object_id[i] / 8] |= 1 << (cols->object_id[i] % 8);
+    }
+
+    /* Worst case: full varints and a dictionary entry per row */
+    body = malloc(rows * (3 * VARINT_MAX + 1 + 6) + VARINT_MAX);
+    idx = malloc(rows * VARINT_MAX);
+    if (!body || !idx || dict_init(&dict, rows)) {
+        err = -ENOMEM;
+        goto out;
+    }
+
+    p = body;
+    prev_ts = ts_min;
+    for (size_t i = 0; i < rows; i++) {
+        p = put_varint(p, zigzag((int64_t)(cols->timestamp_us[i] - prev_ts)));
+        prev_ts = cols->timestamp_us[i];
+    }
+    sizes[0] = p - body;
+
+    /* Dictionary first, so the indexes are staged in idx */
+    q = idx;
+    for (size_t i = 0; i < rows; i++) {
+        q = put_varint(q, dict_add(&dict, cols->mac[i]));
+    }
+
+    p = put_varint(p, dict.count);
+    for (uint32_t k = 0; k < dict.count; k++) {
+        for (int b = 0; b < 6; b++) {
+            *p++ = dict.order[k] >> (8 * b);
+        }
+    }
+    memcpy(p, idx, q - idx);
+    p += q - idx;
+    sizes[1] = p - body - sizes[0];
+
+    memcpy(p, cols->object_id, rows);
+    p += rows;
+    sizes[2] = rows;
+
+    q = p;
+    for (size_t i = 0; i < rows; i++) {
+        uint8_t id = cols->object_id[i];
+
+        p = put_varint(p, zigzag((int64_t)cols->raw[i] - prev_raw[id]));
+        prev_raw[id] = cols->raw[i];
+    }
+    sizes[3] = p - q;
+
+    size = p - body;
+
+    put_le32(&header[4], rows);
+    put_le32(&header[8], size);
+    put_le32(&header[12], crc32(body, size));
+    put_le64(&header[16], ts_min);
+    put_le64(&header[24], ts_max);
+    put_le64(&header[32], mac_min);
+    put_le64(&header[40], mac_max);
+    for (int c = 0; c < COLUMNS; c++) {
+        put_le32(&header[48 + 4 * c], sizes[c]);
+    }
+    put_le32(&header[96], crc32(header, 96));
+
+    if (fwrite(header, sizeof(header), 1, w->file) != 1 ||
+        fwrite(body, size, 1, w->file) != 1) {
+        err = -EIO;
+    } else {
+        w->chunks++;
+        w->bytes += sizeof(header) + size;
+    }
+
+out:
+    dict_free(&dict);
+    free(idx);
+    free(body);
+
+    return err;
+}
+
+int bthome_archive_create(struct bthome_archive_writer *w, const char *path,
+                          size_t chunk_rows)
+{
+    struct bthome_archive ar;
+    size_t end = 0;
+    int err;
+
+    memset(w, 0, sizeof(*w));
+    w->chunk_rows = chunk_rows ? chunk_rows : BTHOME_ARCHIVE_CHUNK_ROWS;
+
+    /* Find the end of the last complete chunk of an existing archive */
+    err = bthome_archive_open(&ar, path);
+    if (err == 0) {
+        end = FILE_HEADER_SIZE;
+        if (ar.count) {
+            const struct bthome_archive_chunk *last = &ar.chunks[ar.count - 1];
+
+            end = last->offset + CHUNK_HEADER_SIZE + get_le32(&ar.map[last->offset + 8]);
+        }
+        bthome_archive_close(&ar);
+    } else if (err != -ENOENT && err != -ENODATA) {
+        return err;
+    }
+
+    if (end) {
+        w->file = fopen(path, "r+b");
+        if (!w->file) {
+            return -errno;
+        }
+        if (ftruncate(fileno(w->file), end) || fseek(w->file, 0, SEEK_END)) {
+            err = -errno;
+            fclose(w->file);
+            return err;
+        }
+    } else {
+        uint8_t header[FILE_HEADER_SIZE] = FILE_MAGIC;
+
+        header[4] = FILE_VERSION;
+
+        w->file = fopen(path, "wb");
+        if (!w->file) {
+            return -errno;
+        }
+        if (fwrite(header, sizeof(header), 1, w->file) != 1) {
+            fclose(w->file);
+            return -EIO;
+        }
+    }
+
+    err = bthome_columns_init(&w->pending, w->chunk_rows);
+    if (err) {
+        fclose(w->file);
+    }
+
+    return err;
+}
+
+int bthome_archive_append(struct bthome_archive_writer *w, const struct bthome_columns *cols)
+{
+    size_t done = 0;
+
+    while (done < cols->count) {
+        struct bthome_columns *p = &w->pending;
+        size_t n = w->chunk_rows - p->count;
+        int err;
+
+        if (n > cols->count - done) {
+            n = cols->count - done;
+        }
+
+        memcpy(&p->timestamp_us[p->count], &cols->timestamp_us[done],
+               n * sizeof(*p->timestamp_us));
+        memcpy(&p->mac[p->count], &cols->mac[done], n * sizeof(*p->mac));
+        memcpy(&p->object_id[p->count], &cols->object_id[done], n);
+        memcpy(&p->raw[p->count], &cols->raw[done], n * sizeof(*p->raw));
+        p->count += n;
+        done += n;
+
+        if (p->count == w->chunk_rows) {
+            err = bthome_archive_flush(w);
+            if (err) {
+                return err;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int bthome_archive_flush(struct bthome_archive_writer *w)
+{
+    int err;
+
+    if (w->pending.count == 0) {
+        return 0;
+    }
+
+    err = write_chunk(w, &w->pending, w->pending.count);
+    w->pending.count = 0;
+
+    return err;
+}
+
+int bthome_archive_finish(struct bthome_archive_writer *w)
+{
+    int err = bthome_archive_flush(w);
+
+    if (fclose(w->file) && !err) {
+        err = -errno;
+    }
+
+    bthome_columns_free(&w->pending);
+
+    return err;
+}
+
+int bthome_archive_open(struct bthome_archive *ar, const char *path)
+{
+    struct stat st;
+    size_t offset = FILE_HEADER_SIZE;
+    size_t cap = 0;
+    int fd;
+
+    memset(ar, 0, sizeof(*ar));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    if (fstat(fd, &st)) {
+        close(fd);
+        return -errno;
+    }
+
+    if (st.st_size == 0) {
+        close(fd);
+        return -ENODATA;
+    }
+
+    ar->size = st.st_size;
+    ar->map = mmap(NULL, ar->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ar->map == MAP_FAILED) {
+        ar->map = NULL;
+        return -errno;
+    }
+
+    if (ar->size < FILE_HEADER_SIZE || memcmp(ar->map, FILE_MAGIC, 4) ||
+        ar->map[4] != FILE_VERSION) {
+        bthome_archive_close(ar);
+        return -EBADMSG;
+    }
+
+    /* Only headers are read here; bodies are touched by queries */
+    while (offset < ar->size) {
+        const uint8_t *h = &ar->map[offset];
+        struct bthome_archive_chunk *c;
+
+        if (ar->size - offset < CHUNK_HEADER_SIZE || memcmp(h, CHUNK_MAGIC, 4) ||
+            get_le32(&h[96]) != crc32(h, 96) ||
+            get_le32(&h[8]) > ar->size - offset - CHUNK_HEADER_SIZE) {
+            ar->truncated = true;
+            break;
+        }
+
+        if (ar->count == cap) {
+            cap = cap ? 2 * cap : 64;
+            c = realloc(ar->chunks, cap * sizeof(*c));
+            if (!c) {
+                bthome_archive_close(ar);
+                return -ENOMEM;
+            }
+            ar->chunks = c;
+        }
+
+        c = &ar->chunks[ar->count++];
+        c->offset = offset;
+        c->rows = get_le32(&h[4]);
+        c->ts_min = get_le64(&h[16]);
+        c->ts_max = get_le64(&h[24]);
+        c->mac_min = get_le64(&h[32]);
+        c->mac_max = get_le64(&h[40]);
+        memcpy(c->ids, &h[64], sizeof(c->ids));
+        ar->rows += c->rows;
+
+        offset += CHUNK_HEADER_SIZE + get_le32(&h[8]);
+    }
+
+    return 0;
+}
+
+void bthome_archive_close(struct bthome_archive *ar)
+{
+    if (ar->map) {
+        munmap((void *)ar->map, ar->size);
+    }
+    free(ar->chunks);
+    memset(ar, 0, sizeof(*ar));
+}
+
+static bool chunk_matches(const struct bthome_archive_chunk *c,
+                          const struct bthome_archive_query *q)
+{
+    if (c->ts_max < q->from_us || (q->to_us && c->ts_min >= q->to_us)) {
+        return false;
+    }
+
+    if (q->match_mac && (q->mac < c->mac_min || q->mac > c->mac_max)) {
+        return false;
+    }
+
+    if (q->object_id >= 0 && !(c->ids[q->object_id / 8] & (1 << (q->object_id % 8)))) {
+        return false;
+    }
+
+    return true;
+}
+
+static bool row_matches(const struct bthome_archive_query *q, uint64_t ts, uint64_t mac,
+                        uint8_t id)
+{
+    return ts >= q->from_us && (!q->to_us || ts < q->to_us) &&
+           (!q->match_mac || mac == q->mac) && (q->object_id < 0 || id == q->object_id);
+}
+
+/* Decode one chunk and append matching rows, -EBADMSG if corrupt */
+static int query_chunk(const struct bthome_archive *ar, const struct bthome_archive_chunk *c,
+                       const struct bthome_archive_query *q, struct bthome_columns *out)
+{
+    const uint8_t *h = &ar->map[c->offset];
+    const uint8_t *body = h + CHUNK_HEADER_SIZE;
+    uint32_t size = get_le32(&h[8]);
+    const uint8_t *col[COLUMNS];
+    const uint8_t *end[COLUMNS];
+    const uint8_t *dict;
+    int64_t prev_raw[256] = { 0 };
+    uint64_t prev_ts = c->ts_min;
+    uint64_t dict_count;
+    size_t offset = 0;
+
+    if (get_le32(&h[12]) != crc32(body, size)) {
+        return -EBADMSG;
+    }
+
+    for (int k = 0; k < COLUMNS; k++) {
+        uint32_t len = get_le32(&h[48 + 4 * k]);
+
+        if (len > size - offset) {
+            return -EBADMSG;
+        }
+        col[k] = body + offset;
+        end[k] = col[k] + len;
+        offset += len;
+    }
+
+    if (get_le32(&h[56]) != c->rows) {
+        return -EBADMSG;
+    }
+
+    col[1] = get_varint(col[1], end[1], &dict_count);
+    if (!col[1] || dict_count > (uint64_t)(end[1] - col[1]) / 6) {
+        return -EBADMSG;
+    }
+    dict = col[1];
+    col[1] += 6 * dict_count;
+
+    if (bthome_columns_reserve(out, c->rows)) {
+        return -ENOMEM;
+    }
+
+    for (uint32_t i = 0; i < c->rows; i++) {
+        uint64_t delta, index, raw_delta;
+        uint64_t mac = 0;
+        uint8_t id = col[2][i];
+        uint64_t raw;
+
+        col[0] = get_varint(col[0], end[0], &delta);
+        col[1] = col[0] ? get_varint(col[1], end[1], &index) : NULL;
+        col[3] = col[1] ? get_varint(col[3], end[3], &raw_delta) : NULL;
+        if (!col[3] || index >= dict_count) {
+            return -EBADMSG;
+        }
+
+        prev_ts += unzigzag(delta);
+        raw = prev_raw[id] + unzigzag(raw_delta);
+        prev_raw[id] = raw;
+
+        for (int b = 5; b >= 0; b--) {
+            mac = mac << 8 | dict[6 * index + b];
+        }
+
+        if (row_matches(q, prev_ts, mac, id)) {
+            size_t row = out->count++;
+
+            out->timestamp_us[row] = prev_ts;
+            out->mac[row] = mac;
+            out->object_id[row] = id;
+            out->raw[row] = (uint32_t)raw;
+        }
+    }
+
+    return 0;
+}
+
+long bthome_archive_query(const struct bthome_archive *ar, const struct bthome_archive_query *query,
+                          struct bthome_columns *out, struct bthome_archive_stats *stats)
+{
+    struct bthome_archive_stats local = { .chunks = ar->count };
+    size_t first = out->count;
+
+    for (size_t i = 0; i < ar->count; i++) {
+        const struct bthome_archive_chunk *c = &ar->chunks[i];
+        size_t before = out->count;
+        int err;
+
+        if (!chunk_matches(c, query)) {
+            local.skipped++;
+            continue;
+        }
+
+        err = query_chunk(ar, c, query, out);
+        if (err == -ENOMEM) {
+            return err;
+        } else if (err) {
+            /* Drop rows of a partly decoded chunk */
+            out->count = before;
+            local.corrupt++;
+            continue;
+        }
+
+        local.decoded++;
+        local.scanned += c->rows;
+    }
+
+    bthome_batch_scale(&out->object_id[first], &out->raw[first], &out->value[first],
+                       out->count - first, BTHOME_SIMD_AUTO);
+
+    if (stats) {
+        *stats = local;
+    }
+
+    return (long)(out->count - first);
+}
@@ -0,0 +1,468 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <bthome_batch.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define HAVE_SSE2           1
+#define HAVE_AVX2           1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HAVE_NEON           1
+#endif
+
+#define BTHOME_INFO_ENCRYPT 0x01
+
+/* Frames parsed before their rows are scaled, keeps the rows in cache */
+#define CHUNK_FRAMES        256
+
+/* At most one row per two payload bytes */
+#define ROWS_PER_FRAME_MAX  (BTHOME_MAX_PAYLOAD_SIZE / 2)
+
+static const uint32_t width_mask[5] = { 0, 0xFF, 0xFFFF, 0xFFFFFF, 0xFFFFFFFF };
+
+/* Per object ID: sign bit of signed objects and the divisor */
+static uint32_t sign_table[256];
+static double scale_table[256];
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+static enum bthome_simd selected = BTHOME_SIMD_AUTO;
+
+static void tables_init(void)
+{
+    for (int id = 0; id < 256; id++) {
+        uint8_t size = bthome_object_size(id);
+
+        if (size && bthome_object_is_signed(id)) {
+            sign_table[id] = 1U << (8 * size - 1);
+        }
+        scale_table[id] = bthome_object_scale(id);
+    }
+}
+
+/*
+ * All implementations compute raw - 2 * (raw & sign) exactly in double
+ * precision and divide by the scale, so results are bit-identical.
+ */
+static void scale_scalar(const uint8_t *id, const uint32_t *raw, double *value, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        int64_t v = (int64_t)raw[i] - 2 * (int64_t)(raw[i] & sign_table[id[i]]);
+
+        value[i] = (double)v / scale_table[id[i]];
+    }
+}
+
+#ifdef HAVE_SSE2
+/* Two doubles from lanes 0 and 1 of r, treated as unsigned */
+static inline __m128d sse2_signed_pd(__m128i r, __m128i sign)
+{
+    const __m128i bias = _mm_set1_epi32((int)0x80000000U);
+    __m128d u = _mm_add_pd(_mm_cvtepi32_pd(_mm_xor_si128(r, bias)),
+                           _mm_set1_pd(2147483648.0));
+    /* (raw & sign) may be 2^31, halve it to stay in int32 */
+    __m128d neg = _mm_cvtepi32_pd(_mm_srli_epi32(_mm_and_si128(r, sign), 1));
+
+    return _mm_sub_pd(u, _mm_mul_pd(neg, _mm_set1_pd(4.0)));
+}
+
+static void scale_sse2(const uint8_t *id, const uint32_t *raw, double *value, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i r = _mm_loadu_si128((const __m128i *)&raw[i]);
+        __m128i sign = _mm_set_epi32(sign_table[id[i + 3]], sign_table[id[i + 2]],
+                                     sign_table[id[i + 1]], sign_table[id[i]]);
+        __m128d lo = sse2_signed_pd(r, sign);
+        __m128d hi = sse2_signed_pd(_mm_shuffle_epi32(r, 0xEE), _mm_shuffle_epi32(sign, 0xEE));
+
+        _mm_storeu_pd(&value[i], _mm_div_pd(lo, _mm_set_pd(scale_table[id[i + 1]],
+                                                           scale_table[id[i]])));
+        _mm_storeu_pd(&value[i + 2], _mm_div_pd(hi, _mm_set_pd(scale_table[id[i + 3]],
+                                                               scale_table[id[i + 2]])));
+    }
+
+    scale_scalar(&id[i], &raw[i], &value[i], count - i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256d avx2_signed_pd(__m128i r, __m128i sign)
+{
+    const __m128i bias = _mm_set1_epi32((int)0x80000000U);
+    __m256d u = _mm256_add_pd(_mm256_cvtepi32_pd(_mm_xor_si128(r, bias)),
+                              _mm256_set1_pd(2147483648.0));
+    __m256d neg = _mm256_cvtepi32_pd(_mm_srli_epi32(_mm_and_si128(r, sign), 1));
+
+    return _mm256_sub_pd(u, _mm256_mul_pd(neg, _mm256_set1_pd(4.0)));
+}
+
+__attribute__((target("avx2")))
+static void scale_avx2(const uint8_t *id, const uint32_t *raw, double *value, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i r = _mm256_loadu_si256((const __m256i *)&raw[i]);
+        __m256i sign = _mm256_setr_epi32(sign_table[id[i]], sign_table[id[i + 1]],
+                                         sign_table[id[i + 2]], sign_table[id[i + 3]],
+                                         sign_table[id[i + 4]], sign_table[id[i + 5]],
+                                         sign_table[id[i + 6]], sign_table[id[i + 7]]);
+        __m256d lo = avx2_signed_pd(_mm256_castsi256_si128(r), _mm256_castsi256_si128(sign));
+        __m256d hi = avx2_signed_pd(_mm256_extracti128_si256(r, 1),
+                                    _mm256_extracti128_si256(sign, 1));
+
+        /* Table lookups beat vgatherdpd for 256-entry tables on most cores */
+        __m256d div_lo = _mm256_setr_pd(scale_table[id[i]], scale_table[id[i + 1]],
+                                        scale_table[id[i + 2]], scale_table[id[i + 3]]);
+        __m256d div_hi = _mm256_setr_pd(scale_table[id[i + 4]], scale_table[id[i + 5]],
+                                        scale_table[id[i + 6]], scale_table[id[i + 7]]);
+
+        _mm256_storeu_pd(&value[i], _mm256_div_pd(lo, div_lo));
+        _mm256_storeu_pd(&value[i + 4], _mm256_div_pd(hi, div_hi));
+    }
+
+    scale_scalar(&id[i], &raw[i], &value[i], count - i);
+}
+#endif /* HAVE_SSE2 */
+
+#ifdef HAVE_NEON
+/* Two doubles from the low half of r and sign, widened to int64 */
+static inline float64x2_t neon_signed_pd(uint32x2_t r, uint32x2_t sign)
+{
+    int64x2_t u = vreinterpretq_s64_u64(vmovl_u32(r));
+    int64x2_t neg = vreinterpretq_s64_u64(vmovl_u32(vand_u32(r, sign)));
+
+    return vcvtq_f64_s64(vsubq_s64(u, vshlq_n_s64(neg, 1)));
+}
+
+static void scale_neon(const uint8_t *id, const uint32_t *raw, double *value, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        const uint32_t s[4] = { sign_table[id[i]], sign_table[id[i + 1]],
+                                sign_table[id[i + 2]], sign_table[id[i + 3]] };
+        const double d[4] = { scale_table[id[i]], scale_table[id[i + 1]],
+                              scale_table[id[i + 2]], scale_table[id[i + 3]] };
+        uint32x4_t r = vld1q_u32(&raw[i]);
+        uint32x4_t sign = vld1q_u32(s);
+
+        vst1q_f64(&value[i], vdivq_f64(neon_signed_pd(vget_low_u32(r), vget_low_u32(sign)),
+                                       vld1q_f64(&d[0])));
+        vst1q_f64(&value[i + 2], vdivq_f64(neon_signed_pd(vget_high_u32(r),
+                                                          vget_high_u32(sign)),
+                                           vld1q_f64(&d[2])));
+    }
+
+    scale_scalar(&id[i], &raw[i], &value[i], count - i);
+}
+#endif /* HAVE_NEON */
+
+bool bthome_batch_simd_supported(enum bthome_simd simd)
+{
+    switch (simd) {
+    case BTHOME_SIMD_AUTO:
+    case BTHOME_SIMD_SCALAR:
+        return true;
+#ifdef HAVE_SSE2
+    case BTHOME_SIMD_SSE2:
+        return true;
+    case BTHOME_SIMD_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#ifdef HAVE_NEON
+    case BTHOME_SIMD_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+static enum bthome_simd resolve(enum bthome_simd simd)
+{
+    static const enum bthome_simd order[] = {
+        BTHOME_SIMD_AVX2, BTHOME_SIMD_NEON, BTHOME_SIMD_SSE2,
+    };
+
+    if (simd != BTHOME_SIMD_AUTO) {
+        return bthome_batch_simd_supported(simd) ? simd : BTHOME_SIMD_SCALAR;
+    }
+
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+        if (bthome_batch_simd_supported(order[i])) {
+            return order[i];
+        }
+    }
+
+    return BTHOME_SIMD_SCALAR;
+}
+
+int bthome_batch_set_simd(enum bthome_simd simd)
+{
+    if (!bthome_batch_simd_supported(simd)) {
+        return -ENOTSUP;
+    }
+
+    selected = simd;
+
+    return 0;
+}
+
+const char *bthome_batch_simd_name(enum bthome_simd simd)
+{
+    switch (simd == BTHOME_SIMD_AUTO ? resolve(selected) : simd) {
+    case BTHOME_SIMD_SSE2:
+        return "sse2";
+    case BTHOME_SIMD_AVX2:
+        return "avx2";
+    case BTHOME_SIMD_NEON:
+        return "neon";
+    default:
+        return "scalar";
+    }
+}
+
+void bthome_batch_scale(const uint8_t *object_id, const uint32_t *raw, double *value,
+                        size_t count, enum bthome_simd simd)
+{
+    pthread_once(&tables_once, tables_init);
+
+    switch (resolve(simd)) {
+#ifdef HAVE_SSE2
+    case BTHOME_SIMD_SSE2:
+        scale_sse2(object_id, raw, value, count);
+        break;
+    case BTHOME_SIMD_AVX2:
+        scale_avx2(object_id, raw, value, count);
+        break;
+#endif
+#ifdef HAVE_NEON
+    case BTHOME_SIMD_NEON:
+        scale_neon(object_id, raw, value, count);
+        break;
+#endif
+    default:
+        scale_scalar(object_id, raw, value, count);
+        break;
+    }
+}
+
+int bthome_columns_init(struct bthome_columns *cols, size_t cap)
+{
+    memset(cols, 0, sizeof(*cols));
+
+    cols->timestamp_us = malloc(cap * sizeof(*cols->timestamp_us));
+    cols->mac = malloc(cap * sizeof(*cols->mac));
+    cols->object_id = malloc(cap * sizeof(*cols->object_id));
+    cols->raw = malloc(cap * sizeof(*cols->raw));
+    cols->value = malloc(cap * sizeof(*cols->value));
+
+    if (!cols->timestamp_us || !cols->mac || !cols->object_id || !cols->raw || !cols->value) {
+        bthome_columns_free(cols);
+        return -ENOMEM;
+    }
+
+    cols->cap = cap;
+
+    return 0;
+}
+
+void bthome_columns_free(struct bthome_columns *cols)
+{
+    free(cols->timestamp_us);
+    free(cols->mac);
+    free(cols->object_id);
+    free(cols->raw);
+    free(cols->value);
+    memset(cols, 0, sizeof(*cols));
+}
+
+int bthome_columns_reserve(struct bthome_columns *cols, size_t rows)
+{
+    size_t cap = cols->cap ? cols->cap : 1024;
+    void *p;
+
+    if (cols->count + rows <= cols->cap) {
+        return 0;
+    }
+
+    while (cap < cols->count + rows) {
+        cap *= 2;
+    }
+
+#define GROW(col)                                                       \
+    do {                                                                \
+        p = realloc(cols->col, cap * sizeof(*cols->col));               \
+        if (!p) {                                                       \
+            return -ENOMEM;                                             \
+        }                                                               \
+        cols->col = p;                                                  \
+    } while (0)
+
+    GROW(timestamp_us);
+    GROW(mac);
+    GROW(object_id);
+    GROW(raw);
+    GROW(value);
+
+#undef GROW
+
+    cols->cap = cap;
+
+    return 0;
+}
+
+/* Parse one frame into rows after cols->count; commits them on success */
+static int decode_frame(const struct bthome_frame *frame, const struct bthome_keys *keys,
+                        struct bthome_aes *aes, struct bthome_columns *cols,
+                        size_t *skipped)
+{
+    /* Room for a 4-byte load at the last object */
+    uint8_t plain[BTHOME_MAX_PAYLOAD_SIZE + 4];
+    const uint8_t *sd = frame->data;
+    uint64_t mac = 0;
+    size_t row = cols->count;
+    size_t variable = 0;
+    uint8_t plain_len;
+    uint8_t pos = 0;
+
+    if (frame->len < 3) {
+        return -EBADMSG;
+    }
+
+    if ((sd[0] | sd[1] << 8) != BTHOME_SERVICE_UUID || (sd[2] >> 5) != 2) {
+        return -ENOTSUP;
+    }
+
+    if (sd[2] & BTHOME_INFO_ENCRYPT) {
+        const uint8_t *key = keys ? bthome_keys_find(keys, frame->mac) : NULL;
+        uint32_t counter;
+        int ret;
+
+        if (!key || !aes) {
+            return -ENOTSUP;
+        }
+
+        if (frame->len - 3 > BTHOME_MAX_PAYLOAD_ENC + BTHOME_CRYPTO_OVERHEAD) {
+            return -EBADMSG;
+        }
+
+        ret = bthome_aes_load_key(aes, key);
+        if (ret) {
+            return ret;
+        }
+
+        ret = bthome_ccm_open(aes, frame->mac, sd[2], &sd[3], frame->len - 3, plain, &counter);
+        if (ret < 0) {
+            return ret;
+        }
+        plain_len = ret;
+    } else {
+        if (frame->len - 3 > BTHOME_MAX_PAYLOAD_SIZE) {
+            return -EBADMSG;
+        }
+
+        plain_len = frame->len - 3;
+        memcpy(plain, &sd[3], plain_len);
+    }
+
+    memset(&plain[plain_len], 0, 4);
+
+    for (int i = 5; i >= 0; i--) {
+        mac = mac << 8 | frame->mac[i];
+    }
+
+    while (pos < plain_len) {
+        uint8_t object_id = plain[pos++];
+        const uint8_t *p;
+        uint8_t size;
+
+        if (bthome_object_is_variable(object_id)) {
+            if (pos >= plain_len || plain[pos] > plain_len - pos - 1) {
+                return -EBADMSG;
+            }
+            pos += 1 + plain[pos];
+            variable++;
+            continue;
+        }
+
+        size = bthome_object_size(object_id);
+        if (size == 0) {
+            /* Size unknown: the rest of the packet cannot be parsed */
+            return -ENOTSUP;
+        }
+
+        if (size > plain_len - pos) {
+            return -EBADMSG;
+        }
+
+        p = &plain[pos];
+        cols->timestamp_us[row] = frame->timestamp_us;
+        cols->mac[row] = mac;
+        cols->object_id[row] = object_id;
+        cols->raw[row] = ((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+                          (uint32_t)p[3] << 24) & width_mask[size];
+        row++;
+        pos += size;
+    }
+
+    cols->count = row;
+    *skipped += variable;
+
+    return 0;
+}
+
+long bthome_batch_decode(const struct bthome_frame *frames, size_t count,
+                         const struct bthome_keys *keys, struct bthome_aes *aes,
+                         struct bthome_columns *cols, struct bthome_batch_stats *stats)
+{
+    struct bthome_batch_stats local = { 0 };
+    enum bthome_simd simd = resolve(selected);
+    size_t first = cols->count;
+
+    for (size_t start = 0; start < count; start += CHUNK_FRAMES) {
+        size_t end = count - start < CHUNK_FRAMES ? count : start + CHUNK_FRAMES;
+        size_t chunk_first = cols->count;
+
+        if (bthome_columns_reserve(cols, (end - start) * ROWS_PER_FRAME_MAX)) {
+            return -ENOMEM;
+        }
+
+        for (size_t i = start; i < end; i++) {
+            int err = decode_frame(&frames[i], keys, aes, cols, &local.skipped);
+
+            if (err == 0) {
+                local.decoded++;
+            } else if (err == -EBADMSG) {
+                local.bad++;
+            } else {
+                local.unsupported++;
+            }
+        }
+
+        bthome_batch_scale(&cols->object_id[chunk_first], &cols->raw[chunk_first],
+                           &cols->value[chunk_first], cols->count - chunk_first, simd);
+    }
+
+    local.frames = count;
+    if (stats) {
+        stats->frames += local.frames;
+        stats->decoded += local.decoded;
+        stats->bad += local.bad;
+        stats->unsupported += local.unsupported;
+        stats->skipped += local.skipped;
+    }
+
+    return (long)(cols->count - first);
+}
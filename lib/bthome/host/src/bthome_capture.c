@@ -0,0 +1,501 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <bthome_host.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define BTSNOOP_MAGIC           "btsnoop\0"
+#define BTSNOOP_HDR_LEN         16
+#define BTSNOOP_REC_LEN         24
+#define BTSNOOP_HCI_UNENCAP     1001
+#define BTSNOOP_HCI_UART        1002
+#define BTSNOOP_FLAG_CMD_EVT    0x02
+/* btsnoop counts microseconds from 0 AD */
+#define BTSNOOP_EPOCH_US        0x00dcddb30f2f8000ULL
+
+#define PCAP_MAGIC_US           0xa1b2c3d4
+#define PCAP_MAGIC_NS           0xa1b23c4d
+#define PCAP_HDR_LEN            24
+#define PCAP_REC_LEN            16
+#define DLT_BT_HCI_H4_PHDR      201
+#define DLT_BT_LE_LL            251
+#define DLT_BT_LE_LL_PHDR       256
+#define LE_LL_PHDR_LEN          10
+#define LE_ADV_ACCESS_ADDR      0x8e89bed6
+
+#define H4_EVENT                0x04
+#define HCI_EVT_LE_META         0x3e
+#define HCI_LE_ADV_REPORT       0x02
+#define HCI_LE_EXT_ADV_REPORT   0x0d
+#define EXT_ADV_REPORT_HDR_LEN  24
+
+#define AD_SERVICE_DATA16       0x16
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return p[0] | p[1] << 8;
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+           (uint32_t)p[3] << 24;
+}
+
+static uint32_t get_be32(const uint8_t *p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+static uint64_t get_be64(const uint8_t *p)
+{
+    return (uint64_t)get_be32(p) << 32 | get_be32(&p[4]);
+}
+
+static void put_le16(uint16_t val, uint8_t *p)
+{
+    p[0] = val;
+    p[1] = val >> 8;
+}
+
+static void put_le32(uint32_t val, uint8_t *p)
+{
+    put_le16(val, p);
+    put_le16(val >> 16, &p[2]);
+}
+
+static void put_be32(uint32_t val, uint8_t *p)
+{
+    p[0] = val >> 24;
+    p[1] = val >> 16;
+    p[2] = val >> 8;
+    p[3] = val;
+}
+
+static void put_be64(uint64_t val, uint8_t *p)
+{
+    put_be32(val >> 32, p);
+    put_be32(val, &p[4]);
+}
+
+static uint32_t pcap_u32(const struct bthome_capture *cap, const uint8_t *p)
+{
+    return cap->swapped ? get_be32(p) : get_le32(p);
+}
+
+int bthome_capture_open(struct bthome_capture *cap, const char *path)
+{
+    struct stat st;
+    void *map;
+    int fd;
+
+    memset(cap, 0, sizeof(*cap));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    if (fstat(fd, &st) < 0) {
+        int err = -errno;
+
+        close(fd);
+        return err;
+    }
+
+    if (st.st_size < PCAP_HDR_LEN) {
+        close(fd);
+        return -ENOTSUP;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -errno;
+    }
+
+    /* Records are read front to back exactly once per scan */
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    cap->map = map;
+    cap->size = st.st_size;
+
+    if (memcmp(cap->map, BTSNOOP_MAGIC, 8) == 0) {
+        cap->format = BTHOME_CAPTURE_BTSNOOP;
+        cap->linktype = get_be32(&cap->map[12]);
+        if (cap->linktype == BTSNOOP_HCI_UNENCAP || cap->linktype == BTSNOOP_HCI_UART) {
+            return 0;
+        }
+    } else {
+        uint32_t magic = get_le32(cap->map);
+
+        cap->format = BTHOME_CAPTURE_PCAP;
+        if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS) {
+            cap->nsec = magic == PCAP_MAGIC_NS;
+        } else if (get_be32(cap->map) == PCAP_MAGIC_US ||
+                   get_be32(cap->map) == PCAP_MAGIC_NS) {
+            cap->swapped = true;
+            cap->nsec = get_be32(cap->map) == PCAP_MAGIC_NS;
+        } else {
+            bthome_capture_close(cap);
+            return -ENOTSUP;
+        }
+
+        cap->linktype = pcap_u32(cap, &cap->map[20]);
+        if (cap->linktype == DLT_BT_HCI_H4_PHDR || cap->linktype == DLT_BT_LE_LL ||
+            cap->linktype == DLT_BT_LE_LL_PHDR) {
+            return 0;
+        }
+    }
+
+    bthome_capture_close(cap);
+    return -ENOTSUP;
+}
+
+void bthome_capture_close(struct bthome_capture *cap)
+{
+    if (cap->map) {
+        munmap((void *)cap->map, cap->size);
+    }
+
+    cap->map = NULL;
+    cap->size = 0;
+}
+
+struct scan {
+    bthome_frame_cb cb;
+    void *user;
+    long frames;
+};
+
+/* Advertising data: report every BTHome service data element */
+static int scan_ad(struct scan *scan, uint64_t ts, const uint8_t *mac,
+                   const uint8_t *ad, size_t len)
+{
+    size_t pos = 0;
+
+    while (pos < len) {
+        uint8_t field_len = ad[pos];
+        const uint8_t *field = &ad[pos + 1];
+
+        if (field_len == 0 || pos + 1 + field_len > len) {
+            break;
+        }
+
+        if (field[0] == AD_SERVICE_DATA16 && field_len >= 3 &&
+            get_le16(&field[1]) == BTHOME_SERVICE_UUID) {
+            struct bthome_frame frame = {
+                .timestamp_us = ts,
+                .len = field_len - 1,
+                .data = &field[1],
+            };
+            int ret;
+
+            memcpy(frame.mac, mac, 6);
+            scan->frames++;
+
+            ret = scan->cb(&frame, scan->user);
+            if (ret) {
+                return ret;
+            }
+        }
+
+        pos += 1 + field_len;
+    }
+
+    return 0;
+}
+
+/* HCI event without the H4 type byte */
+static int scan_hci_event(struct scan *scan, uint64_t ts, const uint8_t *evt, size_t len)
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    uint8_t reports;
+    int ret;
+
+    if (len < 4 || evt[0] != HCI_EVT_LE_META || evt[1] + 2u > len) {
+        return 0;
+    }
+
+    end = &evt[2 + evt[1]];
+    reports = evt[3];
+    p = &evt[4];
+
+    if (evt[2] == HCI_LE_ADV_REPORT) {
+        /* event type, address type, address, data length, data, RSSI */
+        for (uint8_t i = 0; i < reports; i++) {
+            if (end - p < 9 || end - p < 10 + p[8]) {
+                return 0;
+            }
+
+            ret = scan_ad(scan, ts, &p[2], &p[9], p[8]);
+            if (ret) {
+                return ret;
+            }
+
+            p += 10 + p[8];
+        }
+    } else if (evt[2] == HCI_LE_EXT_ADV_REPORT) {
+        for (uint8_t i = 0; i < reports; i++) {
+            uint8_t data_len;
+
+            if (end - p < EXT_ADV_REPORT_HDR_LEN) {
+                return 0;
+            }
+
+            data_len = p[EXT_ADV_REPORT_HDR_LEN - 1];
+            if (end - p < EXT_ADV_REPORT_HDR_LEN + data_len) {
+                return 0;
+            }
+
+            ret = scan_ad(scan, ts, &p[3], &p[EXT_ADV_REPORT_HDR_LEN], data_len);
+            if (ret) {
+                return ret;
+            }
+
+            p += EXT_ADV_REPORT_HDR_LEN + data_len;
+        }
+    }
+
+    return 0;
+}
+
+/* Link layer advertising channel PDU, access address first, CRC last */
+static int scan_le_ll(struct scan *scan, uint64_t ts, const uint8_t *pkt, size_t len)
+{
+    uint8_t pdu_type;
+    uint8_t pdu_len;
+
+    if (len < 4 + 2 + 6 + 3 || get_le32(pkt) != LE_ADV_ACCESS_ADDR) {
+        return 0;
+    }
+
+    pdu_type = pkt[4] & 0x0f;
+    pdu_len = pkt[5];
+    if (pdu_len < 6 || 6u + pdu_len > len) {
+        return 0;
+    }
+
+    /* ADV_IND, ADV_NONCONN_IND, SCAN_RSP, ADV_SCAN_IND: AdvA + AdvData */
+    if (pdu_type != 0x00 && pdu_type != 0x02 && pdu_type != 0x04 && pdu_type != 0x06) {
+        return 0;
+    }
+
+    return scan_ad(scan, ts, &pkt[6], &pkt[12], pdu_len - 6);
+}
+
+static long scan_btsnoop(const struct bthome_capture *cap, struct scan *scan)
+{
+    size_t pos = BTSNOOP_HDR_LEN;
+
+    while (pos + BTSNOOP_REC_LEN <= cap->size) {
+        const uint8_t *rec = &cap->map[pos];
+        uint32_t incl_len = get_be32(&rec[4]);
+        uint32_t flags = get_be32(&rec[8]);
+        uint64_t ts = get_be64(&rec[16]) - BTSNOOP_EPOCH_US;
+        const uint8_t *pkt = &rec[BTSNOOP_REC_LEN];
+        int ret = 0;
+
+        if (incl_len > cap->size - pos - BTSNOOP_REC_LEN) {
+            return -EBADMSG;
+        }
+
+        if (cap->linktype == BTSNOOP_HCI_UART) {
+            if (incl_len > 1 && pkt[0] == H4_EVENT) {
+                ret = scan_hci_event(scan, ts, &pkt[1], incl_len - 1);
+            }
+        } else if ((flags & BTSNOOP_FLAG_CMD_EVT) && (flags & 0x01)) {
+            /* Unencapsulated: received command/event flags mark events */
+            ret = scan_hci_event(scan, ts, pkt, incl_len);
+        }
+
+        if (ret) {
+            return ret;
+        }
+
+        pos += BTSNOOP_REC_LEN + incl_len;
+    }
+
+    return pos == cap->size ? scan->frames : -EBADMSG;
+}
+
+static long scan_pcap(const struct bthome_capture *cap, struct scan *scan)
+{
+    size_t pos = PCAP_HDR_LEN;
+
+    while (pos + PCAP_REC_LEN <= cap->size) {
+        const uint8_t *rec = &cap->map[pos];
+        uint32_t incl_len = pcap_u32(cap, &rec[8]);
+        uint64_t ts = (uint64_t)pcap_u32(cap, rec) * 1000000 +
+                      pcap_u32(cap, &rec[4]) / (cap->nsec ? 1000 : 1);
+        const uint8_t *pkt = &rec[PCAP_REC_LEN];
+        int ret = 0;
+
+        if (incl_len > cap->size - pos - PCAP_REC_LEN) {
+            return -EBADMSG;
+        }
+
+        switch (cap->linktype) {
+        case DLT_BT_HCI_H4_PHDR:
+            /* 4-byte direction header, then the H4 packet */
+            if (incl_len > 5 && pkt[4] == H4_EVENT) {
+                ret = scan_hci_event(scan, ts, &pkt[5], incl_len - 5);
+            }
+            break;
+        case DLT_BT_LE_LL_PHDR:
+            if (incl_len > LE_LL_PHDR_LEN) {
+                ret = scan_le_ll(scan, ts, &pkt[LE_LL_PHDR_LEN], incl_len - LE_LL_PHDR_LEN);
+            }
+            break;
+        default:
+            ret = scan_le_ll(scan, ts, pkt, incl_len);
+            break;
+        }
+
+        if (ret) {
+            return ret;
+        }
+
+        pos += PCAP_REC_LEN + incl_len;
+    }
+
+    return pos == cap->size ? scan->frames : -EBADMSG;
+}
+
+long bthome_capture_scan(const struct bthome_capture *cap, bthome_frame_cb cb, void *user)
+{
+    struct scan scan = {
+        .cb = cb,
+        .user = user,
+    };
+
+    if (!cap->map) {
+        return -EINVAL;
+    }
+
+    if (cap->format == BTHOME_CAPTURE_BTSNOOP) {
+        return scan_btsnoop(cap, &scan);
+    }
+
+    return scan_pcap(cap, &scan);
+}
+
+int bthome_capture_create(struct bthome_capture_writer *w, const char *path,
+                          enum bthome_capture_format format)
+{
+    uint8_t hdr[PCAP_HDR_LEN] = { 0 };
+    size_t len;
+
+    w->format = format;
+    w->file = fopen(path, "wb");
+    if (!w->file) {
+        return -errno;
+    }
+
+    if (format == BTHOME_CAPTURE_BTSNOOP) {
+        memcpy(hdr, BTSNOOP_MAGIC, 8);
+        put_be32(1, &hdr[8]);
+        put_be32(BTSNOOP_HCI_UART, &hdr[12]);
+        len = BTSNOOP_HDR_LEN;
+    } else {
+        /* Little-endian pcap, microsecond timestamps */
+        put_le32(PCAP_MAGIC_US, hdr);
+        put_le16(2, &hdr[4]);
+        put_le16(4, &hdr[6]);
+        put_le32(0xffff, &hdr[16]);
+        put_le32(DLT_BT_HCI_H4_PHDR, &hdr[20]);
+        len = PCAP_HDR_LEN;
+    }
+
+    if (fwrite(hdr, len, 1, w->file) != 1) {
+        int err = -errno;
+
+        fclose(w->file);
+        w->file = NULL;
+        return err;
+    }
+
+    return 0;
+}
+
+int bthome_capture_write(struct bthome_capture_writer *w, const struct bthome_frame *frame)
+{
+    uint8_t rec[BTSNOOP_REC_LEN];
+    uint8_t pkt[4 + 1 + 2 + 12 + 31];
+    uint8_t *evt;
+    size_t rec_len;
+    size_t pkt_len;
+    size_t pos;
+    uint8_t ad_len = 3 + 2 + frame->len;
+
+    if (ad_len > 31) {
+        return -EMSGSIZE;
+    }
+
+    /* pcap DLT 201 starts with a direction header: received */
+    pos = 0;
+    if (w->format == BTHOME_CAPTURE_PCAP) {
+        put_be32(1, pkt);
+        pos = 4;
+    }
+
+    /* H4 event: LE meta, one legacy ADV_NONCONN_IND report */
+    pkt[pos] = H4_EVENT;
+    evt = &pkt[pos + 1];
+    evt[0] = HCI_EVT_LE_META;
+    evt[1] = 12 + ad_len;
+    evt[2] = HCI_LE_ADV_REPORT;
+    evt[3] = 1;
+    evt[4] = 0x03;                  /* ADV_NONCONN_IND */
+    evt[5] = 0x01;                  /* random address */
+    memcpy(&evt[6], frame->mac, 6);
+    evt[12] = ad_len;
+    evt[13] = 2;                    /* Flags */
+    evt[14] = 0x01;
+    evt[15] = 0x06;
+    evt[16] = 1 + frame->len;
+    evt[17] = AD_SERVICE_DATA16;
+    memcpy(&evt[18], frame->data, frame->len);
+    evt[18 + frame->len] = (uint8_t)-60;    /* RSSI */
+    pkt_len = pos + 1 + 2 + evt[1];
+
+    memset(rec, 0, sizeof(rec));
+    if (w->format == BTHOME_CAPTURE_BTSNOOP) {
+        put_be32(pkt_len, &rec[0]);
+        put_be32(pkt_len, &rec[4]);
+        put_be32(BTSNOOP_FLAG_CMD_EVT | 0x01, &rec[8]);
+        put_be64(frame->timestamp_us + BTSNOOP_EPOCH_US, &rec[16]);
+        rec_len = BTSNOOP_REC_LEN;
+    } else {
+        put_le32(frame->timestamp_us / 1000000, &rec[0]);
+        put_le32(frame->timestamp_us % 1000000, &rec[4]);
+        put_le32(pkt_len, &rec[8]);
+        put_le32(pkt_len, &rec[12]);
+        rec_len = PCAP_REC_LEN;
+    }
+
+    if (fwrite(rec, rec_len, 1, w->file) != 1 || fwrite(pkt, pkt_len, 1, w->file) != 1) {
+        return -EIO;
+    }
+
+    return 0;
+}
+
+int bthome_capture_finish(struct bthome_capture_writer *w)
+{
+    int err = fclose(w->file) ? -errno : 0;
+
+    w->file = NULL;
+
+    return err;
+}
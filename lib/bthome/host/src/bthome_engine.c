@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <bthome_engine.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CACHE_LINE          64
+#define QUEUE_LEN_DEFAULT   4096
+#define TABLE_SIZE_INITIAL  256
+
+/* Empty polls before a worker yields, and yields before it sleeps */
+#define IDLE_SPINS          256
+#define IDLE_YIELDS         64
+#define IDLE_SLEEP_NS       50000
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax()         __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define cpu_relax()         __asm__ volatile("yield")
+#else
+#define cpu_relax()         do { } while (0)
+#endif
+
+/*
+ * Bounded MPSC queue after Vyukov: each slot carries a sequence number.
+ * A producer claims a slot with one CAS on tail, fills it and publishes
+ * it by advancing seq. The single consumer owns head and needs no atomic
+ * read-modify-write at all.
+ */
+struct slot {
+    atomic_size_t seq;
+    uint64_t timestamp_us;
+    uint8_t mac[6];
+    uint8_t len;
+    uint8_t data[BTHOME_SERVICE_DATA_MAX];
+};
+
+/* Per-sensor state, owned by one shard */
+struct sensor {
+    uint8_t mac[6];
+    bool used;
+    struct bthome_dedup dedup;
+};
+
+struct shard {
+    /* Producer side */
+    _Alignas(CACHE_LINE) atomic_size_t tail;
+    atomic_uint_fast64_t stalls;
+
+    /* Consumer side, only touched by the worker */
+    _Alignas(CACHE_LINE) size_t head;
+    struct slot *slots;
+    size_t mask;
+    struct sensor *table;
+    uint32_t table_size;
+    struct bthome_aes *aes;
+    struct bthome_engine_stats stats;
+    struct bthome_engine *engine;
+    unsigned int index;
+    pthread_t thread;
+};
+
+struct bthome_engine {
+    struct bthome_engine_config cfg;
+    unsigned int shards;
+    atomic_bool stopping;
+    struct shard *shard;
+};
+
+static unsigned int shard_of(const struct bthome_engine *engine, uint32_t hash)
+{
+    /* High bits pick the shard, low bits index the sensor table */
+    return (unsigned int)(((uint64_t)hash * engine->shards) >> 32);
+}
+
+unsigned int bthome_engine_shards(const struct bthome_engine *engine)
+{
+    return engine->shards;
+}
+
+unsigned int bthome_engine_shard_of(const struct bthome_engine *engine, const uint8_t mac[6])
+{
+    return shard_of(engine, bthome_mac_hash(mac));
+}
+
+static int table_grow(struct shard *s)
+{
+    uint32_t size = s->table_size ? 2 * s->table_size : TABLE_SIZE_INITIAL;
+    struct sensor *table = calloc(size, sizeof(*table));
+
+    if (!table) {
+        return -ENOMEM;
+    }
+
+    for (uint32_t i = 0; i < s->table_size; i++) {
+        const struct sensor *e = &s->table[i];
+        uint32_t pos;
+
+        if (!e->used) {
+            continue;
+        }
+
+        pos = bthome_mac_hash(e->mac) & (size - 1);
+        while (table[pos].used) {
+            pos = (pos + 1) & (size - 1);
+        }
+        table[pos] = *e;
+    }
+
+    free(s->table);
+    s->table = table;
+    s->table_size = size;
+
+    return 0;
+}
+
+static struct sensor *sensor_lookup(struct shard *s, const uint8_t mac[6], uint32_t hash)
+{
+    uint32_t pos;
+
+    /* Keep the load factor at or below one half */
+    if (2 * (s->stats.sensors + 1) > s->table_size && table_grow(s)) {
+        return NULL;
+    }
+
+    pos = hash & (s->table_size - 1);
+    while (s->table[pos].used) {
+        if (memcmp(s->table[pos].mac, mac, 6) == 0) {
+            return &s->table[pos];
+        }
+        pos = (pos + 1) & (s->table_size - 1);
+    }
+
+    s->table[pos].used = true;
+    memcpy(s->table[pos].mac, mac, 6);
+    s->stats.sensors++;
+
+    return &s->table[pos];
+}
+
+static void process(struct shard *s, const struct slot *slot)
+{
+    const struct bthome_engine_config *cfg = &s->engine->cfg;
+    struct bthome_packet pkt;
+    struct bthome_frame frame = {
+        .timestamp_us = slot->timestamp_us,
+        .len = slot->len,
+        .data = slot->data,
+    };
+    const uint8_t *key = NULL;
+    struct sensor *e;
+    int err;
+
+    memcpy(frame.mac, slot->mac, 6);
+    s->stats.frames++;
+
+    if (frame.len > 2 && (frame.data[2] & 0x01) && cfg->keys) {
+        key = bthome_keys_find(cfg->keys, frame.mac);
+    }
+
+    err = bthome_codec_decode(frame.data, frame.len, frame.mac, key, s->aes, &pkt);
+    if (err == -EBADMSG) {
+        s->stats.bad++;
+        return;
+    } else if (err) {
+        s->stats.unsupported++;
+        return;
+    }
+
+    e = sensor_lookup(s, frame.mac, bthome_mac_hash(frame.mac));
+    if (e && bthome_dedup_check(&e->dedup, &pkt)) {
+        s->stats.duplicates++;
+        return;
+    }
+
+    s->stats.decoded++;
+    s->stats.objects += pkt.count;
+
+    if (cfg->cb) {
+        cfg->cb(s->index, &frame, &pkt, cfg->user);
+    }
+}
+
+static bool dequeue(struct shard *s)
+{
+    struct slot *slot = &s->slots[s->head & s->mask];
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+    if (seq != s->head + 1) {
+        return false;
+    }
+
+    process(s, slot);
+
+    /* Hand the slot back to producers one lap ahead */
+    atomic_store_explicit(&slot->seq, s->head + s->mask + 1, memory_order_release);
+    s->head++;
+
+    return true;
+}
+
+static void idle(unsigned int *polls)
+{
+    struct timespec ts = { .tv_nsec = IDLE_SLEEP_NS };
+
+    if (*polls < IDLE_SPINS) {
+        cpu_relax();
+    } else if (*polls < IDLE_SPINS + IDLE_YIELDS) {
+        sched_yield();
+    } else {
+        nanosleep(&ts, NULL);
+        return;
+    }
+
+    (*polls)++;
+}
+
+static void *worker(void *arg)
+{
+    struct shard *s = arg;
+    unsigned int polls = 0;
+
+    for (;;) {
+        if (dequeue(s)) {
+            polls = 0;
+            continue;
+        }
+
+        /* Producers are done before stopping is set, so one more empty
+         * poll after seeing it means the queue is drained.
+         */
+        if (atomic_load_explicit(&s->engine->stopping, memory_order_acquire)) {
+            if (!dequeue(s)) {
+                break;
+            }
+            continue;
+        }
+
+        idle(&polls);
+    }
+
+    return NULL;
+}
+
+int bthome_engine_submit(struct bthome_engine *engine, const struct bthome_frame *frame)
+{
+    uint32_t hash = bthome_mac_hash(frame->mac);
+    struct shard *s = &engine->shard[shard_of(engine, hash)];
+    bool stalled = false;
+    struct slot *slot;
+    size_t pos;
+
+    if (frame->len > BTHOME_SERVICE_DATA_MAX) {
+        return -EMSGSIZE;
+    }
+
+    if (atomic_load_explicit(&engine->stopping, memory_order_relaxed)) {
+        return -ESHUTDOWN;
+    }
+
+    pos = atomic_load_explicit(&s->tail, memory_order_relaxed);
+    for (;;) {
+        size_t seq;
+        intptr_t diff;
+
+        slot = &s->slots[pos & s->mask];
+        seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* Full: the worker has not consumed this slot one lap ago */
+            if (!stalled) {
+                atomic_fetch_add_explicit(&s->stalls, 1, memory_order_relaxed);
+                stalled = true;
+            }
+            sched_yield();
+            pos = atomic_load_explicit(&s->tail, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&s->tail, memory_order_relaxed);
+        }
+    }
+
+    slot->timestamp_us = frame->timestamp_us;
+    memcpy(slot->mac, frame->mac, 6);
+    slot->len = frame->len;
+    memcpy(slot->data, frame->data, frame->len);
+
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+
+    return 0;
+}
+
+static void shard_free(struct shard *s)
+{
+    bthome_host_aes_free(s->aes);
+    free(s->slots);
+    free(s->table);
+}
+
+static void pin_thread(pthread_t thread, unsigned int cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu % CPU_SETSIZE, &set);
+    pthread_setaffinity_np(thread, sizeof(set), &set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+int bthome_engine_start(struct bthome_engine **out, const struct bthome_engine_config *cfg)
+{
+    struct bthome_engine *engine;
+    unsigned int queue_len = cfg->queue_len ? cfg->queue_len : QUEUE_LEN_DEFAULT;
+    unsigned int started = 0;
+    int err = 0;
+
+    if (queue_len < 2 || (queue_len & (queue_len - 1))) {
+        return -EINVAL;
+    }
+
+    engine = calloc(1, sizeof(*engine));
+    if (!engine) {
+        return -ENOMEM;
+    }
+
+    engine->cfg = *cfg;
+    engine->shards = cfg->shards;
+    if (engine->shards == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        engine->shards = cpus > 0 ? cpus : 1;
+    }
+    atomic_init(&engine->stopping, false);
+
+    engine->shard = aligned_alloc(CACHE_LINE, engine->shards * sizeof(struct shard));
+    if (!engine->shard) {
+        free(engine);
+        return -ENOMEM;
+    }
+    memset(engine->shard, 0, engine->shards * sizeof(struct shard));
+
+    for (unsigned int i = 0; i < engine->shards; i++) {
+        struct shard *s = &engine->shard[i];
+
+        s->engine = engine;
+        s->index = i;
+        s->mask = queue_len - 1;
+        atomic_init(&s->tail, 0);
+        atomic_init(&s->stalls, 0);
+
+        /* One cipher per shard: its key cache follows the shard's sensors */
+        s->aes = bthome_host_aes_new();
+        s->slots = calloc(queue_len, sizeof(*s->slots));
+        if (!s->slots || table_grow(s)) {
+            err = -ENOMEM;
+            break;
+        }
+
+        for (size_t k = 0; k < queue_len; k++) {
+            atomic_init(&s->slots[k].seq, k);
+        }
+    }
+
+    for (unsigned int i = 0; !err && i < engine->shards; i++) {
+        err = -pthread_create(&engine->shard[i].thread, NULL, worker, &engine->shard[i]);
+        if (!err) {
+            started++;
+            if (cfg->pin) {
+                pin_thread(engine->shard[i].thread, i);
+            }
+        }
+    }
+
+    if (err) {
+        atomic_store(&engine->stopping, true);
+        for (unsigned int i = 0; i < started; i++) {
+            pthread_join(engine->shard[i].thread, NULL);
+        }
+        for (unsigned int i = 0; i < engine->shards; i++) {
+            shard_free(&engine->shard[i]);
+        }
+        free(engine->shard);
+        free(engine);
+        return err;
+    }
+
+    *out = engine;
+
+    return 0;
+}
+
+void bthome_engine_stop(struct bthome_engine *engine, struct bthome_engine_stats *stats)
+{
+    atomic_store_explicit(&engine->stopping, true, memory_order_release);
+
+    for (unsigned int i = 0; i < engine->shards; i++) {
+        struct shard *s = &engine->shard[i];
+
+        pthread_join(s->thread, NULL);
+
+        if (stats) {
+            stats[i] = s->stats;
+            stats[i].stalls = atomic_load(&s->stalls);
+        }
+
+        shard_free(s);
+    }
+
+    free(engine->shard);
+    free(engine);
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <bthome_host.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+
+    c = tolower((unsigned char)c);
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+
+    return -1;
+}
+
+static int hex_byte(const char *str)
+{
+    int hi = hex_digit(str[0]);
+    int lo = hi < 0 ? -1 : hex_digit(str[1]);
+
+    return lo < 0 ? -1 : hi << 4 | lo;
+}
+
+int bthome_parse_mac(const char *str, uint8_t mac[6])
+{
+    for (int i = 0; i < 6; i++) {
+        int byte = hex_byte(&str[3 * i]);
+
+        if (byte < 0 || (i < 5 && str[3 * i + 2] != ':')) {
+            return -EINVAL;
+        }
+
+        /* Displayed most significant byte first */
+        mac[5 - i] = byte;
+    }
+
+    return 0;
+}
+
+static int compare_keys(const void *a, const void *b)
+{
+    return memcmp(a, b, 6);
+}
+
+int bthome_keys_add(struct bthome_keys *keys, const char *spec)
+{
+    struct bthome_key entry;
+    struct bthome_key *entries;
+    size_t pos;
+
+    if (bthome_parse_mac(spec, entry.mac) || spec[17] != '=') {
+        return -EINVAL;
+    }
+
+    for (int i = 0; i < 16; i++) {
+        int byte = hex_byte(&spec[18 + 2 * i]);
+
+        if (byte < 0) {
+            return -EINVAL;
+        }
+        entry.key[i] = byte;
+    }
+
+    entries = realloc(keys->entries, (keys->count + 1) * sizeof(*entries));
+    if (!entries) {
+        return -ENOMEM;
+    }
+    keys->entries = entries;
+
+    /* Insert sorted, the table is built once and searched per frame */
+    pos = keys->count;
+    while (pos > 0 && memcmp(entries[pos - 1].mac, entry.mac, 6) > 0) {
+        entries[pos] = entries[pos - 1];
+        pos--;
+    }
+    entries[pos] = entry;
+    keys->count++;
+
+    return 0;
+}
+
+int bthome_keys_load(struct bthome_keys *keys, const char *path)
+{
+    char line[128];
+    int count = 0;
+    FILE *file;
+
+    file = fopen(path, "r");
+    if (!file) {
+        return -errno;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        char *p = line;
+        int err;
+
+        while (isspace((unsigned char)*p)) {
+            p++;
+        }
+
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+
+        err = bthome_keys_add(keys, p);
+        if (err) {
+            fclose(file);
+            return err;
+        }
+        count++;
+    }
+
+    fclose(file);
+
+    return count;
+}
+
+const uint8_t *bthome_keys_find(const struct bthome_keys *keys, const uint8_t mac[6])
+{
+    const struct bthome_key *entry;
+
+    if (keys->count == 0) {
+        return NULL;
+    }
+
+    entry = bsearch(mac, keys->entries, keys->count, sizeof(*entry), compare_keys);
+
+    return entry ? entry->key : NULL;
+}
+
+void bthome_keys_free(struct bthome_keys *keys)
+{
+    free(keys->entries);
+    keys->entries = NULL;
+    keys->count = 0;
+}
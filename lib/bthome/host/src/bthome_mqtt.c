@@ -0,0 +1,891 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <bthome_mqtt.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MQTT_CONNECT        0x10
+#define MQTT_CONNACK        0x20
+#define MQTT_PUBLISH_QOS1   0x32
+#define MQTT_PUBACK         0x40
+#define MQTT_PINGREQ        0xC0
+#define MQTT_PINGRESP       0xD0
+#define MQTT_DISCONNECT     0xE0
+#define MQTT_DUP            0x08
+
+#define PORT_DEFAULT        1883
+#define WINDOW_DEFAULT      64
+#define BATCH_DEFAULT       32
+#define FLUSH_MS_DEFAULT    100
+#define KEEPALIVE_DEFAULT   60
+#define TIMEOUT_MS_DEFAULT  5000
+#define RETRY_MS_DEFAULT    1000
+#define RECONNECTS_DEFAULT  5
+
+/* {"t":1735689600.123456,"id":255,"v":-1234567.891}, */
+#define READING_MAX         64
+
+/* Publishes queued behind the window before bthome_mqtt_publish() waits */
+#define QUEUE_WINDOWS       4
+
+/* Publishes handed to one sendmsg() */
+#define IOV_MAX_SEND        64
+
+/* Largest sensor table, more sensors fail with -ENOMEM */
+#define SENSORS_MAX         (1 << 20)
+
+/*
+ * One PUBLISH. buf holds headroom for the fixed header, topic and packet
+ * ID, then the payload formatted in place. At seal time the header is
+ * written right-aligned in front of the payload, so the packet is
+ * buf[head, len).
+ */
+struct msg {
+    struct msg *next;               /* Send queue or free list */
+    struct msg *open_prev;          /* Open batches, oldest first */
+    struct msg *open_next;
+    struct sensor *sensor;          /* Owner while open */
+    uint64_t opened_ms;
+    size_t head;
+    size_t len;
+    size_t sent;
+    uint16_t count;
+    uint16_t pid;                   /* Packet ID while in the window, else 0 */
+    uint8_t buf[];
+};
+
+struct sensor {
+    uint64_t mac;
+    bool used;
+    struct msg *open;
+};
+
+struct bthome_mqtt {
+    struct bthome_mqtt_config cfg;
+    char host[256];
+    char client_id[65];
+    char prefix[64];
+    size_t prefix_len;
+    size_t topic_len;
+    size_t headroom;
+    size_t msg_size;
+    int fd;
+
+    struct sensor *sensors;
+    uint32_t sensors_size;
+    uint32_t sensors_count;
+
+    struct msg *free_list;
+    struct msg *open_head;
+    struct msg *open_tail;
+    struct msg *queue_head;         /* Sealed, not yet fully sent */
+    struct msg *queue_tail;
+    size_t queued;
+
+    struct msg *inflight[65536];    /* By packet ID */
+    unsigned int inflight_count;
+    uint16_t next_pid;
+
+    uint8_t rbuf[512];
+    size_t rlen;
+    uint64_t last_send_ms;
+    uint64_t ping_ms;               /* PINGREQ awaiting its PINGRESP, 0 if none */
+
+    struct bthome_mqtt_stats stats;
+};
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static size_t put_length(uint8_t *p, size_t len)
+{
+    size_t n = 0;
+
+    do {
+        p[n] = len & 0x7F;
+        len >>= 7;
+        if (len) {
+            p[n] |= 0x80;
+        }
+        n++;
+    } while (len);
+
+    return n;
+}
+
+static int send_all(int fd, const uint8_t *buf, size_t len)
+{
+    while (len) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        buf += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+static struct msg *msg_get(struct bthome_mqtt *m)
+{
+    struct msg *msg = m->free_list;
+
+    if (msg) {
+        m->free_list = msg->next;
+    } else {
+        msg = malloc(sizeof(*msg) + m->msg_size);
+        if (!msg) {
+            return NULL;
+        }
+    }
+
+    msg->next = NULL;
+    msg->count = 0;
+    msg->sent = 0;
+    msg->pid = 0;
+    msg->len = m->headroom;
+    msg->buf[msg->len++] = '[';
+
+    return msg;
+}
+
+static void msg_put(struct bthome_mqtt *m, struct msg *msg)
+{
+    msg->next = m->free_list;
+    m->free_list = msg;
+}
+
+static void open_unlink(struct bthome_mqtt *m, struct msg *msg)
+{
+    if (msg->open_prev) {
+        msg->open_prev->open_next = msg->open_next;
+    } else {
+        m->open_head = msg->open_next;
+    }
+
+    if (msg->open_next) {
+        msg->open_next->open_prev = msg->open_prev;
+    } else {
+        m->open_tail = msg->open_prev;
+    }
+}
+
+/* Close the payload, write the header in front of it and queue the packet */
+static void seal(struct bthome_mqtt *m, struct msg *msg)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    uint64_t mac = msg->sensor->mac;
+    uint8_t fixed[5];
+    size_t fixed_len;
+    uint8_t *p;
+
+    open_unlink(m, msg);
+    msg->sensor->open = NULL;
+
+    /* Trailing comma becomes the closing bracket */
+    msg->buf[msg->len - 1] = ']';
+
+    fixed[0] = MQTT_PUBLISH_QOS1;
+    fixed_len = 1 + put_length(&fixed[1], 2 + m->topic_len + 2 + msg->len - m->headroom);
+
+    msg->head = m->headroom - 2 - m->topic_len - 2 - fixed_len;
+    p = &msg->buf[msg->head];
+    memcpy(p, fixed, fixed_len);
+    p += fixed_len;
+    *p++ = m->topic_len >> 8;
+    *p++ = m->topic_len & 0xFF;
+    memcpy(p, m->prefix, m->prefix_len);
+    p += m->prefix_len;
+    *p++ = '/';
+    for (int i = 5; i >= 0; i--) {
+        uint8_t byte = mac >> (8 * i);
+
+        *p++ = hex[byte >> 4];
+        *p++ = hex[byte & 0xF];
+    }
+    /* Packet ID follows when the publish enters the window */
+
+    msg->next = NULL;
+    if (m->queue_tail) {
+        m->queue_tail->next = msg;
+    } else {
+        m->queue_head = msg;
+    }
+    m->queue_tail = msg;
+    m->queued++;
+}
+
+static struct sensor *sensor_find(struct bthome_mqtt *m, uint64_t mac)
+{
+    uint32_t pos;
+
+    if (2 * (m->sensors_count + 1) > m->sensors_size) {
+        uint32_t size = m->sensors_size ? 2 * m->sensors_size : 1024;
+        struct sensor *table;
+
+        if (size > SENSORS_MAX) {
+            return NULL;
+        }
+
+        table = calloc(size, sizeof(*table));
+        if (!table) {
+            return NULL;
+        }
+
+        for (uint32_t i = 0; i < m->sensors_size; i++) {
+            const struct sensor *s = &m->sensors[i];
+
+            if (!s->used) {
+                continue;
+            }
+
+            pos = (uint32_t)((s->mac * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);
+            while (table[pos].used) {
+                pos = (pos + 1) & (size - 1);
+            }
+            table[pos] = *s;
+            if (s->open) {
+                s->open->sensor = &table[pos];
+            }
+        }
+
+        free(m->sensors);
+        m->sensors = table;
+        m->sensors_size = size;
+    }
+
+    pos = (uint32_t)((mac * 0x9E3779B97F4A7C15ULL) >> 32) & (m->sensors_size - 1);
+    while (m->sensors[pos].used) {
+        if (m->sensors[pos].mac == mac) {
+            return &m->sensors[pos];
+        }
+        pos = (pos + 1) & (m->sensors_size - 1);
+    }
+
+    m->sensors[pos].used = true;
+    m->sensors[pos].mac = mac;
+    m->sensors_count++;
+
+    return &m->sensors[pos];
+}
+
+/* Hand as many queued packets to the socket as the window allows */
+static int send_queued(struct bthome_mqtt *m)
+{
+    while (m->queue_head) {
+        struct iovec iov[IOV_MAX_SEND];
+        struct msghdr mh = { .msg_iov = iov };
+        struct msg *msg = m->queue_head;
+        unsigned int window = m->inflight_count;
+        ssize_t n;
+
+        /* Gather packets: partly sent and retransmitted ones are in the window */
+        for (; msg && mh.msg_iovlen < IOV_MAX_SEND; msg = msg->next) {
+            if (msg->pid == 0) {
+                uint16_t pid;
+
+                if (window >= m->cfg.window) {
+                    break;
+                }
+
+                do {
+                    pid = ++m->next_pid;
+                } while (pid == 0 || m->inflight[pid]);
+
+                msg->buf[m->headroom - 2] = pid >> 8;
+                msg->buf[m->headroom - 1] = pid & 0xFF;
+                msg->pid = pid;
+                m->inflight[pid] = msg;
+                m->inflight_count++;
+                m->stats.publishes++;
+                window++;
+                if (m->inflight_count > m->stats.max_inflight) {
+                    m->stats.max_inflight = m->inflight_count;
+                }
+            }
+
+            iov[mh.msg_iovlen].iov_base = &msg->buf[msg->head + msg->sent];
+            iov[mh.msg_iovlen].iov_len = msg->len - msg->head - msg->sent;
+            mh.msg_iovlen++;
+        }
+
+        if (mh.msg_iovlen == 0) {
+            return 0;
+        }
+
+        n = sendmsg(m->fd, &mh, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            } else if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+
+        m->stats.bytes += n;
+        m->last_send_ms = now_ms();
+
+        /* Retire fully sent packets; they stay in the window until acked */
+        while (n > 0) {
+            size_t left;
+
+            msg = m->queue_head;
+            left = msg->len - msg->head - msg->sent;
+            if ((size_t)n < left) {
+                msg->sent += n;
+                return 0;
+            }
+
+            n -= left;
+            msg->sent += left;
+            m->queue_head = msg->next;
+            if (!m->queue_head) {
+                m->queue_tail = NULL;
+            }
+            m->queued--;
+        }
+    }
+
+    return 0;
+}
+
+static int handle_packet(struct bthome_mqtt *m, uint8_t type, const uint8_t *body, size_t len)
+{
+    if (type == MQTT_PUBACK && len == 2) {
+        uint16_t pid = body[0] << 8 | body[1];
+        struct msg *msg = m->inflight[pid];
+
+        if (!msg || msg->sent < msg->len - msg->head) {
+            return -EPROTO;
+        }
+
+        m->inflight[pid] = NULL;
+        m->inflight_count--;
+        m->stats.acked++;
+        msg_put(m, msg);
+
+        return 0;
+    }
+
+    if (type == MQTT_PINGRESP) {
+        m->ping_ms = 0;
+        return 0;
+    }
+
+    return -EPROTO;
+}
+
+static int receive(struct bthome_mqtt *m)
+{
+    for (;;) {
+        ssize_t n = recv(m->fd, &m->rbuf[m->rlen], sizeof(m->rbuf) - m->rlen, 0);
+        size_t pos = 0;
+
+        if (n == 0) {
+            return -ECONNRESET;
+        } else if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return 0;
+            } else if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+
+        m->rlen += n;
+
+        /* Broker to client packets here are all short: one length byte */
+        while (m->rlen - pos >= 2) {
+            uint8_t len = m->rbuf[pos + 1];
+            int err;
+
+            if (len & 0x80) {
+                return -EPROTO;
+            }
+            if (m->rlen - pos < 2u + len) {
+                break;
+            }
+
+            err = handle_packet(m, m->rbuf[pos], &m->rbuf[pos + 2], len);
+            if (err) {
+                return err;
+            }
+            pos += 2 + len;
+        }
+
+        memmove(m->rbuf, &m->rbuf[pos], m->rlen - pos);
+        m->rlen -= pos;
+    }
+}
+
+static int reconnect(struct bthome_mqtt *m, int err);
+
+static int poll_once(struct bthome_mqtt *m, int timeout_ms)
+{
+    struct pollfd pfd = { .fd = m->fd, .events = POLLIN };
+    uint64_t now = now_ms();
+    uint64_t deadline;
+    int err;
+
+    while (m->open_head && now - m->open_head->opened_ms >= m->cfg.flush_ms) {
+        seal(m, m->open_head);
+    }
+
+    if (m->ping_ms && now - m->ping_ms >= m->cfg.timeout_ms) {
+        return -ETIMEDOUT;
+    }
+
+    /* Idle or stuck on a full window, but not inside a packet */
+    if (!m->ping_ms && now - m->last_send_ms >= 500ULL * m->cfg.keepalive &&
+        !(m->queue_head && m->queue_head->sent)) {
+        static const uint8_t ping[2] = { MQTT_PINGREQ, 0 };
+
+        err = send_all(m->fd, ping, sizeof(ping));
+        if (err) {
+            return err;
+        }
+        m->last_send_ms = now;
+        m->ping_ms = now;
+    }
+
+    err = send_queued(m);
+    if (err) {
+        return err;
+    }
+
+    if (m->queue_head && m->inflight_count < m->cfg.window) {
+        pfd.events |= POLLOUT;
+    }
+
+    /* Wake up for the next keep alive or the PINGRESP deadline */
+    deadline = m->ping_ms ? m->ping_ms + m->cfg.timeout_ms :
+                            m->last_send_ms + 500ULL * m->cfg.keepalive;
+    if (deadline > now && (timeout_ms < 0 || deadline - now < (uint64_t)timeout_ms)) {
+        timeout_ms = (int)(deadline - now);
+    }
+
+    if (poll(&pfd, 1, timeout_ms) < 0) {
+        return errno == EINTR ? 0 : -errno;
+    }
+
+    if (pfd.revents & (POLLERR | POLLHUP)) {
+        return -ECONNRESET;
+    }
+
+    if (pfd.revents & POLLIN) {
+        err = receive(m);
+        if (err) {
+            return err;
+        }
+    }
+
+    /* Acks may have opened the window */
+    return send_queued(m);
+}
+
+int bthome_mqtt_poll(struct bthome_mqtt *m, int timeout_ms)
+{
+    int err = poll_once(m, timeout_ms);
+
+    if (err) {
+        err = reconnect(m, err);
+    }
+
+    return err;
+}
+
+int bthome_mqtt_publish(struct bthome_mqtt *m, const struct bthome_columns *cols)
+{
+    uint64_t now = now_ms();
+
+    for (size_t i = 0; i < cols->count; i++) {
+        struct sensor *s = sensor_find(m, cols->mac[i]);
+        struct msg *msg;
+        int len;
+
+        if (!s) {
+            return -ENOMEM;
+        }
+
+        msg = s->open;
+        if (!msg) {
+            msg = msg_get(m);
+            if (!msg) {
+                return -ENOMEM;
+            }
+
+            msg->sensor = s;
+            msg->opened_ms = now;
+            msg->open_prev = m->open_tail;
+            msg->open_next = NULL;
+            if (m->open_tail) {
+                m->open_tail->open_next = msg;
+            } else {
+                m->open_head = msg;
+            }
+            m->open_tail = msg;
+            s->open = msg;
+        }
+
+        len = snprintf((char *)&msg->buf[msg->len], READING_MAX,
+                       "{\"t\":%llu.%06llu,\"id\":%u,\"v\":%.10g},",
+                       (unsigned long long)(cols->timestamp_us[i] / 1000000),
+                       (unsigned long long)(cols->timestamp_us[i] % 1000000),
+                       cols->object_id[i], cols->value[i]);
+        msg->len += len < READING_MAX ? len : READING_MAX - 1;
+        msg->count++;
+        m->stats.readings++;
+
+        if (msg->count == m->cfg.batch) {
+            seal(m, msg);
+        }
+
+        /* Backpressure: let the broker catch up */
+        while (m->queued > QUEUE_WINDOWS * m->cfg.window) {
+            int err = bthome_mqtt_poll(m, 10);
+
+            if (err) {
+                return err;
+            }
+        }
+    }
+
+    return bthome_mqtt_poll(m, 0);
+}
+
+int bthome_mqtt_drain(struct bthome_mqtt *m, int timeout_ms)
+{
+    uint64_t deadline = now_ms() + timeout_ms;
+
+    while (m->open_head) {
+        seal(m, m->open_head);
+    }
+
+    while (m->queue_head || m->inflight_count) {
+        uint64_t now = now_ms();
+        int err;
+
+        if (now >= deadline) {
+            return -ETIMEDOUT;
+        }
+
+        err = bthome_mqtt_poll(m, (int)(deadline - now));
+        if (err) {
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+static int mqtt_handshake(struct bthome_mqtt *m)
+{
+    uint64_t deadline = now_ms() + m->cfg.timeout_ms;
+    uint8_t pkt[128];
+    uint8_t ack[4];
+    size_t id_len = strlen(m->client_id);
+    size_t pos = 0;
+    size_t got = 0;
+    int err;
+
+    pkt[pos++] = MQTT_CONNECT;
+    pos += put_length(&pkt[pos], 10 + 2 + id_len);
+    memcpy(&pkt[pos], "\0\4MQTT\4", 7);
+    pos += 7;
+    pkt[pos++] = 0x02;              /* Clean session */
+    pkt[pos++] = m->cfg.keepalive >> 8;
+    pkt[pos++] = m->cfg.keepalive & 0xFF;
+    pkt[pos++] = id_len >> 8;
+    pkt[pos++] = id_len & 0xFF;
+    memcpy(&pkt[pos], m->client_id, id_len);
+    pos += id_len;
+
+    err = send_all(m->fd, pkt, pos);
+    if (err) {
+        return err;
+    }
+
+    while (got < sizeof(ack)) {
+        struct pollfd pfd = { .fd = m->fd, .events = POLLIN };
+        uint64_t now = now_ms();
+        ssize_t n;
+
+        if (now >= deadline) {
+            return -ETIMEDOUT;
+        }
+
+        n = poll(&pfd, 1, (int)(deadline - now));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        } else if (n == 0) {
+            continue;
+        }
+
+        n = recv(m->fd, &ack[got], sizeof(ack) - got, 0);
+        if (n <= 0) {
+            return n == 0 ? -ECONNRESET : -errno;
+        }
+        got += n;
+    }
+
+    if (ack[0] != MQTT_CONNACK || ack[1] != 2) {
+        return -EPROTO;
+    }
+
+    return ack[3] == 0 ? 0 : -ECONNREFUSED;
+}
+
+/* Open the socket and wait for the CONNACK */
+static int mqtt_open(struct bthome_mqtt *m)
+{
+    struct addrinfo hints = { .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res;
+    char port[8];
+    int one = 1;
+    int err;
+
+    snprintf(port, sizeof(port), "%u", m->cfg.port);
+    err = getaddrinfo(m->host, port, &hints, &res);
+    if (err) {
+        return err == EAI_SYSTEM ? -errno : -EHOSTUNREACH;
+    }
+
+    m->fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (m->fd < 0 || connect(m->fd, res->ai_addr, res->ai_addrlen)) {
+        err = -errno;
+        freeaddrinfo(res);
+        if (m->fd >= 0) {
+            close(m->fd);
+            m->fd = -1;
+        }
+        return err;
+    }
+    freeaddrinfo(res);
+
+    /* Packets are already coalesced by sendmsg() */
+    setsockopt(m->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    err = mqtt_handshake(m);
+    if (err) {
+        close(m->fd);
+        m->fd = -1;
+        return err;
+    }
+
+    fcntl(m->fd, F_SETFL, fcntl(m->fd, F_GETFL) | O_NONBLOCK);
+    m->last_send_ms = now_ms();
+
+    return 0;
+}
+
+/*
+ * Connect again after err and put the unacknowledged window back in
+ * front of the queue, oldest first, with the original packet IDs. The
+ * broker starts a clean session, so it may deliver a publish twice,
+ * which QoS 1 allows.
+ */
+static int reconnect(struct bthome_mqtt *m, int err)
+{
+    struct msg *head = NULL;
+    struct msg *tail = NULL;
+    struct msg *msg;
+    size_t queued = 0;
+
+    close(m->fd);
+    m->fd = -1;
+    m->rlen = 0;
+    m->ping_ms = 0;
+
+    for (int attempt = 0; err; attempt++) {
+        struct timespec delay = {
+            .tv_sec = m->cfg.retry_ms / 1000,
+            .tv_nsec = (long)(m->cfg.retry_ms % 1000) * 1000000,
+        };
+
+        if (m->cfg.reconnects < 0 || attempt == m->cfg.reconnects) {
+            return err;
+        }
+
+        if (attempt) {
+            nanosleep(&delay, NULL);
+        }
+
+        err = mqtt_open(m);
+    }
+
+    m->stats.reconnects++;
+
+    /* Oldest packet IDs first: they are handed out in ascending order */
+    for (uint32_t i = 1; i <= 65536; i++) {
+        uint16_t pid = m->next_pid + i;
+
+        msg = m->inflight[pid];
+        if (!msg) {
+            continue;
+        }
+
+        if (msg->sent) {
+            msg->buf[msg->head] |= MQTT_DUP;
+            msg->sent = 0;
+            m->stats.retransmits++;
+        }
+
+        msg->next = NULL;
+        if (tail) {
+            tail->next = msg;
+        } else {
+            head = msg;
+        }
+        tail = msg;
+        queued++;
+    }
+
+    /* Then the publishes that never entered the window */
+    for (msg = m->queue_head; msg; msg = msg->next) {
+        if (msg->pid) {
+            continue;
+        }
+
+        if (tail) {
+            tail->next = msg;
+        } else {
+            head = msg;
+        }
+        tail = msg;
+        queued++;
+    }
+
+    if (tail) {
+        tail->next = NULL;
+    }
+    m->queue_head = head;
+    m->queue_tail = tail;
+    m->queued = queued;
+
+    return 0;
+}
+
+int bthome_mqtt_connect(struct bthome_mqtt **out, const struct bthome_mqtt_config *cfg)
+{
+    struct bthome_mqtt *m;
+    int err;
+
+    m = calloc(1, sizeof(*m));
+    if (!m) {
+        return -ENOMEM;
+    }
+
+    m->cfg = *cfg;
+    m->cfg.port = cfg->port ? cfg->port : PORT_DEFAULT;
+    m->cfg.window = cfg->window ? cfg->window : WINDOW_DEFAULT;
+    m->cfg.batch = cfg->batch ? cfg->batch : BATCH_DEFAULT;
+    m->cfg.flush_ms = cfg->flush_ms ? cfg->flush_ms : FLUSH_MS_DEFAULT;
+    m->cfg.keepalive = cfg->keepalive ? cfg->keepalive : KEEPALIVE_DEFAULT;
+    m->cfg.timeout_ms = cfg->timeout_ms ? cfg->timeout_ms : TIMEOUT_MS_DEFAULT;
+    m->cfg.retry_ms = cfg->retry_ms ? cfg->retry_ms : RETRY_MS_DEFAULT;
+    m->cfg.reconnects = cfg->reconnects ? cfg->reconnects : RECONNECTS_DEFAULT;
+    if (m->cfg.window > 65535 || m->cfg.batch > 65535 || strlen(cfg->host) >= sizeof(m->host) ||
+        (cfg->client_id && strlen(cfg->client_id) >= sizeof(m->client_id))) {
+        free(m);
+        return -EINVAL;
+    }
+
+    strcpy(m->host, cfg->host);
+    if (cfg->client_id) {
+        strcpy(m->client_id, cfg->client_id);
+    } else {
+        snprintf(m->client_id, sizeof(m->client_id), "bthome-%ld", (long)getpid());
+    }
+    m->cfg.host = m->host;
+    m->cfg.client_id = m->client_id;
+
+    snprintf(m->prefix, sizeof(m->prefix), "%s", cfg->prefix ? cfg->prefix : "bthome");
+    m->prefix_len = strlen(m->prefix);
+    m->topic_len = m->prefix_len + 1 + 12;
+    /* Fixed header (up to 5), topic length, topic, packet ID */
+    m->headroom = 5 + 2 + m->topic_len + 2;
+    m->msg_size = m->headroom + 2 + (size_t)m->cfg.batch * READING_MAX;
+
+    err = mqtt_open(m);
+    if (err) {
+        free(m);
+        return err;
+    }
+
+    *out = m;
+
+    return 0;
+}
+
+void bthome_mqtt_close(struct bthome_mqtt *m, struct bthome_mqtt_stats *stats)
+{
+    static const uint8_t disconnect[2] = { MQTT_DISCONNECT, 0 };
+    struct msg *msg;
+
+    if (m->fd >= 0) {
+        fcntl(m->fd, F_SETFL, fcntl(m->fd, F_GETFL) & ~O_NONBLOCK);
+        send_all(m->fd, disconnect, sizeof(disconnect));
+        close(m->fd);
+    }
+
+    if (stats) {
+        *stats = m->stats;
+    }
+
+    /* Every message is in exactly one of these places */
+    while (m->open_head) {
+        msg = m->open_head;
+        open_unlink(m, msg);
+        free(msg);
+    }
+    while (m->queue_head) {
+        msg = m->queue_head;
+        m->queue_head = msg->next;
+        /* Queued packets in the window are freed below */
+        if (!msg->pid) {
+            free(msg);
+        }
+    }
+    for (size_t pid = 0; pid < 65536; pid++) {
+        free(m->inflight[pid]);
+    }
+    while (m->free_list) {
+        msg = m->free_list;
+        m->free_list = msg->next;
+        free(msg);
+    }
+
+    free(m->sensors);
+    free(m);
+}
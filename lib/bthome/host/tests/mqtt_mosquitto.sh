@@ -0,0 +1,59 @@
+#!/bin/sh
+# Copyright (c) 2025 BTHome v2 for Zephyr
+# SPDX-License-Identifier: Apache-2.0
+#
+# Publish a generated capture through a local mosquitto and check that
+# every reading arrives: bthome_gateway fails unless all publishes are
+# acknowledged, and a subscriber counts the readings it receives.
+#
+# Usage: mqtt_mosquitto.sh <bthome_capgen> <bthome_gateway> <mosquitto> [mosquitto_sub]
+
+set -eu
+
+capgen=$1
+gateway=$2
+mosquitto=$3
+sub=${4:-}
+
+dir=$(mktemp -d)
+port=$((20000 + $$ % 20000))
+broker=
+
+cleanup() {
+    [ -n "$broker" ] && kill "$broker" 2>/dev/null || true
+    rm -rf "$dir"
+}
+trap cleanup EXIT
+
+printf 'listener %s 127.0.0.1\nallow_anonymous true\n' "$port" > "$dir/mosquitto.conf"
+"$mosquitto" -c "$dir/mosquitto.conf" > "$dir/broker.log" 2>&1 &
+broker=$!
+sleep 0.5
+
+"$capgen" -n 200 -c 20000 -e 25 -K "$dir/keys.txt" "$dir/farm.btsnoop" > /dev/null
+
+if [ -n "$sub" ]; then
+    "$sub" -h 127.0.0.1 -p "$port" -q 1 -t 'bthome/#' -W 30 > "$dir/sub.txt" 2>/dev/null &
+    subscriber=$!
+    sleep 0.5
+fi
+
+# No pipe: its status would be the one of the last command
+status=0
+"$gateway" -h 127.0.0.1 -p "$port" -K "$dir/keys.txt" "$dir/farm.btsnoop" > "$dir/gateway.txt" ||
+    status=$?
+cat "$dir/gateway.txt"
+if [ "$status" -ne 0 ]; then
+    echo "bthome_gateway failed with status $status"
+    exit 1
+fi
+
+if [ -n "$sub" ]; then
+    sleep 1
+    kill "$subscriber" 2>/dev/null || true
+    wait "$subscriber" 2>/dev/null || true
+    expected=$(sed -n 's/^\([0-9]*\) readings.*/\1/p' "$dir/gateway.txt")
+    received=$(grep -o '"id":' "$dir/sub.txt" | wc -l)
+    echo "subscriber received $received of $expected readings"
+    [ "$received" -eq "$expected" ]
+fi
@@ -0,0 +1,378 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Write decoded captures to a columnar archive and query it:
+ *   bthome_archive write [-K keys] [-c rows] [-T text] archive capture...
+ *   bthome_archive query [-f from] [-t to] [-m mac] [-o id] [-v count] archive
+ *   bthome_archive info archive
+ */
+
+#include <bthome_archive.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH_FRAMES        4096
+
+struct frames {
+    struct bthome_frame *list;
+    size_t count;
+    size_t cap;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int collect(const struct bthome_frame *frame, void *user)
+{
+    struct frames *frames = user;
+
+    if (frames->count == frames->cap) {
+        size_t cap = frames->cap ? 2 * frames->cap : 4096;
+        struct bthome_frame *list = realloc(frames->list, cap * sizeof(*list));
+
+        if (!list) {
+            return -ENOMEM;
+        }
+
+        frames->list = list;
+        frames->cap = cap;
+    }
+
+    frames->list[frames->count++] = *frame;
+
+    return 0;
+}
+
+/* One text line per row, as the gateway logs readings today */
+static int format_row(char *line, size_t size, const struct bthome_columns *cols, size_t i)
+{
+    uint64_t mac = cols->mac[i];
+
+    return snprintf(line, size, "%llu.%06llu %02X:%02X:%02X:%02X:%02X:%02X %02x=%g\n",
+                    (unsigned long long)(cols->timestamp_us[i] / 1000000),
+                    (unsigned long long)(cols->timestamp_us[i] % 1000000),
+                    (unsigned int)(mac >> 40) & 0xFF, (unsigned int)(mac >> 32) & 0xFF,
+                    (unsigned int)(mac >> 24) & 0xFF, (unsigned int)(mac >> 16) & 0xFF,
+                    (unsigned int)(mac >> 8) & 0xFF, (unsigned int)mac & 0xFF,
+                    cols->object_id[i], cols->value[i]);
+}
+
+static int cmd_write(int argc, char **argv)
+{
+    struct bthome_batch_stats stats = { 0 };
+    struct bthome_archive_writer w;
+    struct bthome_keys keys = { 0 };
+    struct bthome_columns cols;
+    struct bthome_aes *aes;
+    const char *text_path = NULL;
+    FILE *text = NULL;
+    size_t chunk_rows = 0;
+    uint64_t rows = 0, text_bytes = 0;
+    uint64_t archive_ns = 0, text_ns = 0;
+    int opt;
+    int err;
+
+    while ((opt = getopt(argc, argv, "k:K:c:T:")) != -1) {
+        switch (opt) {
+        case 'k':
+            if (bthome_keys_add(&keys, optarg)) {
+                fprintf(stderr, "Invalid key: %s\n", optarg);
+                return 2;
+            }
+            break;
+        case 'K':
+            err = bthome_keys_load(&keys, optarg);
+            if (err < 0) {
+                fprintf(stderr, "%s: %s\n", optarg, strerror(-err));
+                return 2;
+            }
+            break;
+        case 'c':
+            chunk_rows = strtoul(optarg, NULL, 0);
+            break;
+        case 'T':
+            text_path = optarg;
+            break;
+        default:
+            return 2;
+        }
+    }
+
+    if (argc - optind < 2) {
+        return 2;
+    }
+
+    err = bthome_archive_create(&w, argv[optind], chunk_rows);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(-err));
+        return 1;
+    }
+
+    if (text_path) {
+        text = fopen(text_path, "a");
+        if (!text) {
+            perror(text_path);
+            return 1;
+        }
+    }
+
+    aes = bthome_host_aes_new();
+    if (bthome_columns_init(&cols, BATCH_FRAMES * BTHOME_DECODE_MAX_OBJECTS)) {
+        return 1;
+    }
+
+    for (int a = optind + 1; a < argc; a++) {
+        struct frames frames = { 0 };
+        struct bthome_capture cap;
+        long count;
+
+        err = bthome_capture_open(&cap, argv[a]);
+        if (err) {
+            fprintf(stderr, "%s: %s\n", argv[a], strerror(-err));
+            return 1;
+        }
+
+        count = bthome_capture_scan(&cap, collect, &frames);
+        if (count < 0) {
+            fprintf(stderr, "%s: %s\n", argv[a], strerror((int)-count));
+            return 1;
+        }
+
+        for (size_t i = 0; i < frames.count; i += BATCH_FRAMES) {
+            size_t n = frames.count - i < BATCH_FRAMES ? frames.count - i : BATCH_FRAMES;
+            uint64_t start;
+
+            cols.count = 0;
+            if (bthome_batch_decode(&frames.list[i], n, &keys, aes, &cols, &stats) < 0) {
+                fprintf(stderr, "Out of memory\n");
+                return 1;
+            }
+            rows += cols.count;
+
+            start = now_ns();
+            err = bthome_archive_append(&w, &cols);
+            archive_ns += now_ns() - start;
+            if (err) {
+                fprintf(stderr, "%s: %s\n", argv[optind], strerror(-err));
+                return 1;
+            }
+
+            if (text) {
+                char line[64];
+
+                start = now_ns();
+                for (size_t r = 0; r < cols.count; r++) {
+                    int len = format_row(line, sizeof(line), &cols, r);
+
+                    fwrite(line, len, 1, text);
+                    text_bytes += len;
+                }
+                text_ns += now_ns() - start;
+            }
+        }
+
+        free(frames.list);
+        bthome_capture_close(&cap);
+    }
+
+    {
+        uint64_t start = now_ns();
+
+        err = bthome_archive_finish(&w);
+        archive_ns += now_ns() - start;
+    }
+    if (err) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(-err));
+        return 1;
+    }
+
+    printf("%zu frames: %zu decoded, %zu bad, %zu unsupported, %zu text/raw objects skipped\n",
+           stats.frames, stats.decoded, stats.bad, stats.unsupported, stats.skipped);
+    printf("archive: %lu rows in %lu chunks, %lu bytes, %.2f bytes/row, %.1f ms, "
+           "%.1f Mrows/s\n", (unsigned long)rows, (unsigned long)w.chunks,
+           (unsigned long)w.bytes, rows ? (double)w.bytes / rows : 0.0, archive_ns / 1e6,
+           archive_ns ? rows * 1e3 / archive_ns : 0.0);
+
+    if (text) {
+        uint64_t start = now_ns();
+
+        fclose(text);
+        text_ns += now_ns() - start;
+        printf("text:    %lu bytes, %.2f bytes/row, %.1f ms, %.1f Mrows/s\n",
+               (unsigned long)text_bytes, rows ? (double)text_bytes / rows : 0.0,
+               text_ns / 1e6, text_ns ? rows * 1e3 / text_ns : 0.0);
+    }
+
+    bthome_columns_free(&cols);
+    bthome_host_aes_free(aes);
+    bthome_keys_free(&keys);
+
+    return 0;
+}
+
+static int cmd_query(int argc, char **argv)
+{
+    struct bthome_archive_query query = { .object_id = -1 };
+    struct bthome_archive_stats stats;
+    struct bthome_columns cols;
+    struct bthome_archive ar;
+    long print = 0;
+    uint64_t start;
+    uint64_t elapsed;
+    long rows;
+    int opt;
+    int err;
+
+    while ((opt = getopt(argc, argv, "f:t:m:o:v:")) != -1) {
+        switch (opt) {
+        case 'f':
+            query.from_us = strtod(optarg, NULL) * 1e6;
+            break;
+        case 't':
+            query.to_us = strtod(optarg, NULL) * 1e6;
+            break;
+        case 'm': {
+            uint8_t mac[6];
+
+            if (bthome_parse_mac(optarg, mac)) {
+                fprintf(stderr, "Invalid address: %s\n", optarg);
+                return 2;
+            }
+            query.match_mac = true;
+            for (int b = 5; b >= 0; b--) {
+                query.mac = query.mac << 8 | mac[b];
+            }
+            break;
+        }
+        case 'o':
+            query.object_id = strtol(optarg, NULL, 0) & 0xFF;
+            break;
+        case 'v':
+            print = strtol(optarg, NULL, 0);
+            break;
+        default:
+            return 2;
+        }
+    }
+
+    if (argc - optind != 1) {
+        return 2;
+    }
+
+    err = bthome_archive_open(&ar, argv[optind]);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(-err));
+        return 1;
+    }
+
+    if (bthome_columns_init(&cols, 4096)) {
+        return 1;
+    }
+
+    start = now_ns();
+    rows = bthome_archive_query(&ar, &query, &cols, &stats);
+    elapsed = now_ns() - start;
+    if (rows < 0) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    for (long i = 0; i < rows && i < print; i++) {
+        char line[64];
+
+        format_row(line, sizeof(line), &cols, i);
+        fputs(line, stdout);
+    }
+
+    printf("%ld rows, %lu of %lu rows scanned; chunks: %zu decoded, %zu skipped, "
+           "%zu corrupt of %zu; %.2f ms\n", rows, (unsigned long)stats.scanned,
+           (unsigned long)ar.rows, stats.decoded, stats.skipped, stats.corrupt, stats.chunks,
+           elapsed / 1e6);
+
+    bthome_columns_free(&cols);
+    bthome_archive_close(&ar);
+
+    return 0;
+}
+
+static int cmd_info(int argc, char **argv)
+{
+    struct bthome_archive ar;
+    int err;
+
+    if (argc != 2) {
+        return 2;
+    }
+
+    err = bthome_archive_open(&ar, argv[1]);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", argv[1], strerror(-err));
+        return 1;
+    }
+
+    printf("%s: %zu bytes, %zu chunks, %lu rows%s\n", argv[1], ar.size, ar.count,
+           (unsigned long)ar.rows, ar.truncated ? ", incomplete last chunk ignored" : "");
+
+    if (ar.count) {
+        uint64_t ts_min = UINT64_MAX, ts_max = 0;
+
+        for (size_t i = 0; i < ar.count; i++) {
+            ts_min = ar.chunks[i].ts_min < ts_min ? ar.chunks[i].ts_min : ts_min;
+            ts_max = ar.chunks[i].ts_max > ts_max ? ar.chunks[i].ts_max : ts_max;
+        }
+
+        printf("time:  %.6f .. %.6f\n", ts_min / 1e6, ts_max / 1e6);
+        printf("bytes: %.2f per row\n", ar.rows ? (double)ar.size / ar.rows : 0.0);
+    }
+
+    bthome_archive_close(&ar);
+
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s write [-k MAC=KEY]... [-K keyfile] [-c rows] [-T text] archive capture...\n"
+            "       %s query [-f from] [-t to] [-m MAC] [-o object_id] [-v count] archive\n"
+            "       %s info archive\n"
+            "  -c  rows per chunk (%d)\n"
+            "  -T  also append text lines to this file, for comparison\n"
+            "  -f  -t  time range in Unix seconds, to is exclusive\n"
+            "  -v  print the first count matching rows\n",
+            prog, prog, prog, BTHOME_ARCHIVE_CHUNK_ROWS);
+}
+
+int main(int argc, char **argv)
+{
+    int ret = 2;
+
+    if (argc >= 2 && strcmp(argv[1], "write") == 0) {
+        ret = cmd_write(argc - 1, argv + 1);
+    } else if (argc >= 2 && strcmp(argv[1], "query") == 0) {
+        ret = cmd_query(argc - 1, argv + 1);
+    } else if (argc >= 2 && strcmp(argv[1], "info") == 0) {
+        ret = cmd_info(argc - 1, argv + 1);
+    }
+
+    if (ret == 2) {
+        usage(argv[0]);
+    }
+
+    return ret;
+}
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Compare the batch decoder against per-frame bthome_codec_decode() that
+ * appends each object to the same columns, for every scaling
+ * implementation the CPU supports. All outputs must be bit-identical.
+ */
+
+#include <bthome_batch.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+struct frames {
+    struct bthome_frame *list;
+    size_t count;
+    size_t cap;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int collect(const struct bthome_frame *frame, void *user)
+{
+    struct frames *frames = user;
+
+    if (frames->count == frames->cap) {
+        size_t cap = frames->cap ? 2 * frames->cap : 4096;
+        struct bthome_frame *list = realloc(frames->list, cap * sizeof(*list));
+
+        if (!list) {
+            return -ENOMEM;
+        }
+
+        frames->list = list;
+        frames->cap = cap;
+    }
+
+    frames->list[frames->count++] = *frame;
+
+    return 0;
+}
+
+/* Reference: one bthome_codec_decode() per frame, rows reshaped one by one */
+static int decode_per_frame(const struct frames *frames, const struct bthome_keys *keys,
+                            struct bthome_aes *aes, struct bthome_columns *cols)
+{
+    struct bthome_packet pkt;
+
+    cols->count = 0;
+
+    for (size_t i = 0; i < frames->count; i++) {
+        const struct bthome_frame *frame = &frames->list[i];
+        const uint8_t *key = NULL;
+        uint64_t mac = 0;
+
+        if (frame->len > 2 && (frame->data[2] & 0x01)) {
+            key = bthome_keys_find(keys, frame->mac);
+        }
+
+        if (bthome_codec_decode(frame->data, frame->len, frame->mac, key, aes, &pkt)) {
+            continue;
+        }
+
+        if (cols->count + pkt.count > cols->cap) {
+            return -ENOMEM;
+        }
+
+        for (int k = 5; k >= 0; k--) {
+            mac = mac << 8 | frame->mac[k];
+        }
+
+        for (uint8_t k = 0; k < pkt.count; k++) {
+            const struct bthome_object *obj = &pkt.objects[k];
+            size_t row = cols->count;
+
+            if (bthome_object_is_variable(obj->object_id)) {
+                continue;
+            }
+
+            cols->timestamp_us[row] = frame->timestamp_us;
+            cols->mac[row] = mac;
+            cols->object_id[row] = obj->object_id;
+            cols->raw[row] = (uint32_t)obj->raw;
+            cols->value[row] = (double)obj->raw / bthome_object_scale(obj->object_id);
+            cols->count++;
+        }
+    }
+
+    return 0;
+}
+
+static bool columns_equal(const struct bthome_columns *a, const struct bthome_columns *b)
+{
+    size_t n = a->count;
+
+    return a->count == b->count &&
+           !memcmp(a->timestamp_us, b->timestamp_us, n * sizeof(*a->timestamp_us)) &&
+           !memcmp(a->mac, b->mac, n * sizeof(*a->mac)) &&
+           !memcmp(a->object_id, b->object_id, n * sizeof(*a->object_id)) &&
+           !memcmp(a->value, b->value, n * sizeof(*a->value));
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-k MAC=KEY]... [-K keyfile] [-r repeats] [-b frames] capture\n"
+            "  -k  bind key of one device\n"
+            "  -K  file with one MAC=KEY per line\n"
+            "  -r  timed passes (10)\n"
+            "  -b  frames per bthome_batch_decode() call (4096)\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    static const enum bthome_simd impls[] = {
+        BTHOME_SIMD_SCALAR, BTHOME_SIMD_SSE2, BTHOME_SIMD_AVX2, BTHOME_SIMD_NEON,
+    };
+    struct bthome_keys keys = { 0 };
+    struct frames frames = { 0 };
+    struct bthome_columns ref;
+    struct bthome_columns cols;
+    struct bthome_capture cap;
+    struct bthome_aes *aes;
+    unsigned long repeats = 10;
+    size_t batch = 4096;
+    double base_ns;
+    uint64_t start;
+    long count;
+    int opt;
+    int err;
+
+    while ((opt = getopt(argc, argv, "k:K:r:b:")) != -1) {
+        switch (opt) {
+        case 'k':
+            if (bthome_keys_add(&keys, optarg)) {
+                fprintf(stderr, "Invalid key: %s\n", optarg);
+                return 2;
+            }
+            break;
+        case 'K':
+            err = bthome_keys_load(&keys, optarg);
+            if (err < 0) {
+                fprintf(stderr, "%s: %s\n", optarg, strerror(-err));
+                return 2;
+            }
+            break;
+        case 'r':
+            repeats = strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            batch = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind != argc - 1 || repeats == 0 || batch == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    err = bthome_capture_open(&cap, argv[optind]);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(-err));
+        return 1;
+    }
+
+    count = bthome_capture_scan(&cap, collect, &frames);
+    if (count <= 0) {
+        fprintf(stderr, "%s: %s\n", argv[optind], count ? strerror((int)-count) : "no frames");
+        return 1;
+    }
+
+    aes = bthome_host_aes_new();
+
+    if (bthome_columns_init(&ref, frames.count * BTHOME_DECODE_MAX_OBJECTS) ||
+        bthome_columns_init(&cols, frames.count * BTHOME_DECODE_MAX_OBJECTS)) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    decode_per_frame(&frames, &keys, aes, &ref);
+    printf("%s: %zu frames, %zu rows, %zu keys, batches of %zu frames\n", argv[optind],
+           frames.count, ref.count, keys.count, batch);
+
+    start = now_ns();
+    for (unsigned long r = 0; r < repeats; r++) {
+        decode_per_frame(&frames, &keys, aes, &ref);
+    }
+    base_ns = (double)(now_ns() - start) / repeats;
+
+    printf("decoder     ns/frame  Mrows/s  speedup  scale ns/row  identical\n");
+    printf("per-frame   %8.1f  %7.2f  %7.2f  %12s  %s\n", base_ns / frames.count,
+           ref.count * 1e3 / base_ns, 1.0, "-", "-");
+
+    for (size_t k = 0; k < sizeof(impls) / sizeof(impls[0]); k++) {
+        enum bthome_simd simd = impls[k];
+        double decode_ns;
+        double scale_ns;
+        bool same;
+
+        if (bthome_batch_set_simd(simd)) {
+            continue;
+        }
+
+        start = now_ns();
+        for (unsigned long r = 0; r < repeats; r++) {
+            cols.count = 0;
+            for (size_t i = 0; i < frames.count; i += batch) {
+                size_t n = frames.count - i < batch ? frames.count - i : batch;
+
+                if (bthome_batch_decode(&frames.list[i], n, &keys, aes, &cols, NULL) < 0) {
+                    fprintf(stderr, "Out of memory\n");
+                    return 1;
+                }
+            }
+        }
+        decode_ns = (double)(now_ns() - start) / repeats;
+        same = columns_equal(&ref, &cols);
+
+        /* Scaling pass alone, over the columns just produced */
+        start = now_ns();
+        for (unsigned long r = 0; r < repeats; r++) {
+            bthome_batch_scale(cols.object_id, cols.raw, cols.value, cols.count, simd);
+        }
+        scale_ns = (double)(now_ns() - start) / repeats;
+
+        printf("batch %-6s%8.1f  %7.2f  %7.2f  %12.2f  %s\n", bthome_batch_simd_name(simd),
+               decode_ns / frames.count, cols.count * 1e3 / decode_ns, base_ns / decode_ns,
+               cols.count ? scale_ns / cols.count : 0.0, same ? "yes" : "NO");
+
+        if (!same) {
+            return 1;
+        }
+    }
+
+    bthome_columns_free(&ref);
+    bthome_columns_free(&cols);
+    bthome_host_aes_free(aes);
+    bthome_keys_free(&keys);
+    bthome_capture_close(&cap);
+    free(frames.list);
+
+    return 0;
+}
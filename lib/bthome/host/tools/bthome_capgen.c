@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Generate a btsnoop or pcap capture of BTHome advertisements from
+ * simulated sensors, for bthome_replay when no real capture is at hand.
+ */
+
+#include <bthome_host.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* 2025-01-01 00:00:00 UTC */
+#define START_US            1735689600000000ULL
+
+struct sensor {
+    uint8_t mac[6];
+    uint8_t key[16];
+    bool encrypted;
+    uint8_t schema;
+    uint8_t packet_id;
+    uint32_t counter;
+    uint32_t value;
+};
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+    /* xorshift32, same sequence on every host */
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+
+    return rng_state;
+}
+
+static int add(uint8_t *buf, uint8_t *len, uint8_t max, uint8_t object_id, uint32_t raw)
+{
+    uint8_t value[4] = { raw, raw >> 8, raw >> 16, raw >> 24 };
+
+    return bthome_payload_append(buf, len, max, object_id, value,
+                                 bthome_object_size(object_id));
+}
+
+/* Same five schemas as the native_sim sensor farm */
+static int build_payload(struct sensor *s, uint8_t *buf, uint8_t *len)
+{
+    uint8_t max = s->encrypted ? BTHOME_MAX_PAYLOAD_ENC : BTHOME_MAX_PAYLOAD_SIZE;
+    char text[8];
+    int err;
+
+    *len = 0;
+    err = add(buf, len, max, BTHOME_ID_PACKET, s->packet_id++);
+
+    switch (s->schema) {
+    case 0:
+        s->value += rng() % 21;
+        err = err ? err : add(buf, len, max, BTHOME_ID_TEMPERATURE,
+                              (uint16_t)(-100 + (int)(s->value % 400)));
+        err = err ? err : add(buf, len, max, BTHOME_ID_HUMIDITY_PRECISE,
+                              4000 + s->value % 3000);
+        err = err ? err : add(buf, len, max, BTHOME_ID_BATTERY, 100 - s->value / 1000 % 100);
+        break;
+    case 1:
+        s->value += rng() % 5001;
+        err = err ? err : add(buf, len, max, BTHOME_ID_POWER, rng() % 300001);
+        err = err ? err : add(buf, len, max, BTHOME_ID_ENERGY4, s->value);
+        break;
+    case 2:
+        err = err ? err : add(buf, len, max, BTHOME_STATE_WINDOW, rng() & 1);
+        err = err ? err : add(buf, len, max, BTHOME_ID_BATTERY, 87);
+        break;
+    case 3:
+        s->value += rng() % 4;
+        err = err ? err : add(buf, len, max, BTHOME_ID_COUNT4, s->value);
+        break;
+    default:
+        snprintf(text, sizeof(text), "n%05u", (unsigned int)(s->value % 100000));
+        err = err ? err : bthome_payload_append(buf, len, max, BTHOME_ID_TEXT,
+                                                (const uint8_t *)text, 6);
+        err = err ? err : add(buf, len, max, BTHOME_ID_TEMPERATURE, (uint16_t)-55);
+        break;
+    }
+
+    return err;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-n sensors] [-c packets] [-e percent] [-s seed] [-K keyfile] "
+            "[-p] output\n"
+            "  -n  number of sensors (500)\n"
+            "  -c  number of packets (1000000)\n"
+            "  -e  share of encrypted sensors in percent (25)\n"
+            "  -s  random seed (1)\n"
+            "  -K  write the bind keys of encrypted sensors to keyfile\n"
+            "  -p  write pcap (DLT 201) instead of btsnoop\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    enum bthome_capture_format format = BTHOME_CAPTURE_BTSNOOP;
+    struct bthome_capture_writer w;
+    struct bthome_aes *aes;
+    const char *keyfile = NULL;
+    struct sensor *sensors;
+    unsigned long count = 1000000;
+    unsigned int num = 500;
+    unsigned int encrypted = 25;
+    uint64_t ts = START_US;
+    int opt;
+    int err;
+
+    while ((opt = getopt(argc, argv, "n:c:e:s:K:p")) != -1) {
+        switch (opt) {
+        case 'n':
+            num = strtoul(optarg, NULL, 0);
+            break;
+        case 'c':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        case 'e':
+            encrypted = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            rng_state = strtoul(optarg, NULL, 0);
+            if (rng_state == 0) {
+                rng_state = 1;
+            }
+            break;
+        case 'K':
+            keyfile = optarg;
+            break;
+        case 'p':
+            format = BTHOME_CAPTURE_PCAP;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind != argc - 1 || num == 0 || num > 65536) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    aes = bthome_host_aes_new();
+    if (!aes && encrypted) {
+        fprintf(stderr, "No AES backend, generating plain packets only\n");
+        encrypted = 0;
+    }
+
+    sensors = calloc(num, sizeof(*sensors));
+    if (!sensors) {
+        return 1;
+    }
+
+    for (unsigned int i = 0; i < num; i++) {
+        struct sensor *s = &sensors[i];
+
+        /* Static random address: two top bits set */
+        s->mac[0] = i;
+        s->mac[1] = i >> 8;
+        for (int k = 2; k < 6; k++) {
+            s->mac[k] = rng();
+        }
+        s->mac[5] |= 0xC0;
+        for (int k = 0; k < 16; k++) {
+            s->key[k] = rng();
+        }
+        s->encrypted = rng() % 100 < encrypted;
+        s->schema = i % 5;
+        s->packet_id = rng();
+        s->value = rng() % 1000;
+    }
+
+    if (keyfile) {
+        FILE *f = fopen(keyfile, "w");
+
+        if (!f) {
+            perror(keyfile);
+            return 1;
+        }
+
+        for (unsigned int i = 0; i < num; i++) {
+            const struct sensor *s = &sensors[i];
+
+            if (!s->encrypted) {
+                continue;
+            }
+
+            fprintf(f, "%02X:%02X:%02X:%02X:%02X:%02X=", s->mac[5], s->mac[4],
+                    s->mac[3], s->mac[2], s->mac[1], s->mac[0]);
+            for (int k = 0; k < 16; k++) {
+                fprintf(f, "%02x", s->key[k]);
+            }
+            fprintf(f, "\n");
+        }
+        fclose(f);
+    }
+
+    err = bthome_capture_create(&w, argv[optind], format);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(-err));
+        return 1;
+    }
+
+    for (unsigned long n = 0; n < count; n++) {
+        struct sensor *s = &sensors[rng() % num];
+        uint8_t payload[BTHOME_MAX_PAYLOAD_SIZE];
+        uint8_t out[BTHOME_SERVICE_DATA_MAX];
+        struct bthome_frame frame;
+        uint8_t len;
+        int ret;
+
+        err = build_payload(s, payload, &len);
+        if (err) {
+            fprintf(stderr, "Payload error %d\n", err);
+            return 1;
+        }
+
+        ret = bthome_codec_encode(aes, s->encrypted ? s->key : NULL, s->mac,
+                                  s->encrypted ? BTHOME_ENCRYPT : BTHOME_NO_ENCRYPT,
+                                  s->counter, payload, len, out, sizeof(out));
+        if (ret < 0) {
+            fprintf(stderr, "Encode error %d\n", ret);
+            return 1;
+        }
+        s->counter += s->encrypted;
+
+        ts += rng() % 2000;
+        frame.timestamp_us = ts;
+        memcpy(frame.mac, s->mac, 6);
+        frame.len = ret;
+        frame.data = out;
+
+        err = bthome_capture_write(&w, &frame);
+        if (err) {
+            fprintf(stderr, "Write error %d\n", err);
+            return 1;
+        }
+    }
+
+    err = bthome_capture_finish(&w);
+    bthome_host_aes_free(aes);
+    free(sensors);
+
+    if (err) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(-err));
+        return 1;
+    }
+
+    printf("%lu packets from %u sensors written to %s\n", count, num, argv[optind]);
+
+    return 0;
+}
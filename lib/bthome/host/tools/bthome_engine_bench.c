@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Feed a btsnoop or pcap capture through the sharded decode engine with
+ * 1..N shards and report throughput and scaling. Producer threads play
+ * the scanners: each submits the frames of its own share of the sensors
+ * in capture order, so every sensor's packets still arrive in order and
+ * the duplicate count matches a single producer.
+ */
+
+#include <bthome_engine.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SHARDS_MAX          256
+#define PRODUCERS_MAX       64
+
+struct frames {
+    struct bthome_frame *list;
+    size_t count;
+    size_t cap;
+};
+
+struct producer {
+    pthread_t thread;
+    struct bthome_engine *engine;
+    struct frames frames;
+    unsigned long repeats;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int collect(const struct bthome_frame *frame, void *user)
+{
+    struct frames *frames = user;
+
+    if (frames->count == frames->cap) {
+        size_t cap = frames->cap ? 2 * frames->cap : 4096;
+        struct bthome_frame *list = realloc(frames->list, cap * sizeof(*list));
+
+        if (!list) {
+            return -ENOMEM;
+        }
+
+        frames->list = list;
+        frames->cap = cap;
+    }
+
+    frames->list[frames->count++] = *frame;
+
+    return 0;
+}
+
+static void *produce(void *arg)
+{
+    struct producer *p = arg;
+
+    for (unsigned long r = 0; r < p->repeats; r++) {
+        for (size_t i = 0; i < p->frames.count; i++) {
+            bthome_engine_submit(p->engine, &p->frames.list[i]);
+        }
+    }
+
+    return NULL;
+}
+
+/* Deal the frames out by sensor, keeping capture order within each producer */
+static int split(const struct frames *frames, struct producer *prod, unsigned int producers)
+{
+    for (size_t i = 0; i < frames->count; i++) {
+        const struct bthome_frame *frame = &frames->list[i];
+        int err = collect(frame, &prod[bthome_mac_hash(frame->mac) % producers].frames);
+
+        if (err) {
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+/* Run the capture once with the given shard count, returns elapsed ns */
+static int run(struct producer *prod, const struct bthome_engine_config *cfg,
+               unsigned int producers, unsigned long repeats,
+               struct bthome_engine_stats *stats, uint64_t *elapsed)
+{
+    struct bthome_engine *engine;
+    uint64_t start;
+    int err;
+
+    start = now_ns();
+
+    err = bthome_engine_start(&engine, cfg);
+    if (err) {
+        return err;
+    }
+
+    for (unsigned int i = 0; i < producers; i++) {
+        prod[i].engine = engine;
+        prod[i].repeats = repeats;
+        pthread_create(&prod[i].thread, NULL, produce, &prod[i]);
+    }
+
+    for (unsigned int i = 0; i < producers; i++) {
+        pthread_join(prod[i].thread, NULL);
+    }
+
+    bthome_engine_stop(engine, stats);
+    *elapsed = now_ns() - start;
+
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-k MAC=KEY]... [-K keyfile] [-t shards] [-p producers] "
+            "[-r repeats] [-q queue] [-a] capture\n"
+            "  -k  bind key of one device\n"
+            "  -K  file with one MAC=KEY per line\n"
+            "  -t  largest shard count, runs 1..t (online CPUs)\n"
+            "  -p  producer threads, each submitting a share of the sensors (1)\n"
+            "  -r  passes over the capture per run (1)\n"
+            "  -q  queue length per shard, power of two (4096)\n"
+            "  -a  pin shard n to CPU n\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    struct bthome_engine_config cfg = { 0 };
+    struct bthome_engine_stats stats[SHARDS_MAX];
+    struct producer prod[PRODUCERS_MAX] = { 0 };
+    struct bthome_keys keys = { 0 };
+    struct frames frames = { 0 };
+    struct bthome_capture cap;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned int max_shards = cpus > 0 ? cpus : 1;
+    unsigned int producers = 1;
+    unsigned long repeats = 1;
+    uint64_t expect = 0;
+    double base = 0;
+    long count;
+    int opt;
+    int err;
+
+    while ((opt = getopt(argc, argv, "k:K:t:p:r:q:a")) != -1) {
+        switch (opt) {
+        case 'k':
+            if (bthome_keys_add(&keys, optarg)) {
+                fprintf(stderr, "Invalid key: %s\n", optarg);
+                return 2;
+            }
+            break;
+        case 'K':
+            err = bthome_keys_load(&keys, optarg);
+            if (err < 0) {
+                fprintf(stderr, "%s: %s\n", optarg, strerror(-err));
+                return 2;
+            }
+            break;
+        case 't':
+            max_shards = strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            producers = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            repeats = strtoul(optarg, NULL, 0);
+            break;
+        case 'q':
+            cfg.queue_len = strtoul(optarg, NULL, 0);
+            break;
+        case 'a':
+            cfg.pin = true;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind != argc - 1 || max_shards == 0 || max_shards > SHARDS_MAX ||
+        producers == 0 || producers > PRODUCERS_MAX || repeats == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    err = bthome_capture_open(&cap, argv[optind]);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(-err));
+        return 1;
+    }
+
+    count = bthome_capture_scan(&cap, collect, &frames);
+    if (count <= 0) {
+        fprintf(stderr, "%s: %s\n", argv[optind], count ? strerror((int)-count) : "no frames");
+        return 1;
+    }
+
+    if (split(&frames, prod, producers)) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    printf("%s: %ld BTHome frames, %zu keys, %u producer(s), %ld online CPUs\n",
+           argv[optind], count, keys.count, producers, cpus);
+    printf("shards  Mframes/s  speedup  efficiency  decoded   dup       bad  unsup  "
+           "stalls    balance\n");
+
+    cfg.keys = &keys;
+
+    for (unsigned int n = 1; n <= max_shards; n++) {
+        uint64_t frames_in = 0, decoded = 0, dup = 0, bad = 0, unsup = 0, stalls = 0;
+        uint64_t busiest = 0;
+        uint64_t elapsed;
+        double rate;
+
+        cfg.shards = n;
+        err = run(prod, &cfg, producers, repeats, stats, &elapsed);
+        if (err) {
+            fprintf(stderr, "Engine start failed: %s\n", strerror(-err));
+            return 1;
+        }
+
+        for (unsigned int i = 0; i < n; i++) {
+            frames_in += stats[i].frames;
+            decoded += stats[i].decoded;
+            dup += stats[i].duplicates;
+            bad += stats[i].bad;
+            unsup += stats[i].unsupported;
+            stalls += stats[i].stalls;
+            if (stats[i].frames > busiest) {
+                busiest = stats[i].frames;
+            }
+        }
+
+        rate = frames_in * 1e3 / elapsed;
+        if (n == 1) {
+            base = rate;
+            expect = frames_in;
+        }
+
+        /* Balance: busiest shard against a perfectly even split */
+        printf("%6u  %9.2f  %7.2f  %9.0f%%  %-8lu  %-8lu  %-3lu  %-5lu  %-8lu  %.2f\n", n,
+               rate, rate / base, 100.0 * rate / base / n, (unsigned long)decoded,
+               (unsigned long)dup, (unsigned long)bad, (unsigned long)unsup,
+               (unsigned long)stalls, (double)busiest * n / frames_in);
+
+        if (frames_in != expect) {
+            fprintf(stderr, "Lost frames: %lu of %lu\n", (unsigned long)(expect - frames_in),
+                    (unsigned long)expect);
+            return 1;
+        }
+    }
+
+    bthome_keys_free(&keys);
+    bthome_capture_close(&cap);
+    free(frames.list);
+    for (unsigned int i = 0; i < producers; i++) {
+        free(prod[i].frames.list);
+    }
+
+    return 0;
+}
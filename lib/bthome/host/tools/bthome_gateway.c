@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Decode captures and publish the readings to an MQTT broker, as the
+ * gateway does with live scanner input. -r paces the frames to a given
+ * rate; without it frames are published as fast as the broker acks.
+ */
+
+#include <bthome_mqtt.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BATCH_FRAMES        256
+#define DRAIN_TIMEOUT_MS    10000
+
+struct frames {
+    struct bthome_frame *list;
+    size_t count;
+    size_t cap;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int collect(const struct bthome_frame *frame, void *user)
+{
+    struct frames *frames = user;
+
+    if (frames->count == frames->cap) {
+        size_t cap = frames->cap ? 2 * frames->cap : 4096;
+        struct bthome_frame *list = realloc(frames->list, cap * sizeof(*list));
+
+        if (!list) {
+            return -ENOMEM;
+        }
+
+        frames->list = list;
+        frames->cap = cap;
+    }
+
+    frames->list[frames->count++] = *frame;
+
+    return 0;
+}
+
+/* Publish one capture, returns 0 or a negative error code */
+static int publish_capture(struct bthome_mqtt *mqtt, const struct frames *frames,
+                           const struct bthome_keys *keys, struct bthome_aes *aes,
+                           struct bthome_columns *cols, double rate, uint64_t start)
+{
+    static uint64_t sent;
+
+    for (size_t i = 0; i < frames->count; i += BATCH_FRAMES) {
+        size_t n = frames->count - i < BATCH_FRAMES ? frames->count - i : BATCH_FRAMES;
+        int err;
+
+        /* Pace: wait until these frames are due */
+        while (rate > 0 && now_ns() - start < sent * 1e9 / rate) {
+            err = bthome_mqtt_poll(mqtt, 1);
+            if (err) {
+                return err;
+            }
+        }
+
+        cols->count = 0;
+        if (bthome_batch_decode(&frames->list[i], n, keys, aes, cols, NULL) < 0) {
+            return -ENOMEM;
+        }
+        sent += n;
+
+        err = bthome_mqtt_publish(mqtt, cols);
+        if (err) {
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-k MAC=KEY]... [-K keyfile] [-h host] [-p port] [-P prefix] "
+            "[-w window] [-n batch] [-f flush_ms] [-r rate] capture...\n"
+            "  -h  broker (localhost), -p port (1883), -P topic prefix (bthome)\n"
+            "  -w  unacknowledged QoS 1 publishes (64); -w 1 -n 1 publishes synchronously\n"
+            "  -n  readings per publish (32)\n"
+            "  -f  longest time a reading waits for its batch in ms (100)\n"
+            "  -r  replay at this many frames per second (as fast as possible)\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    struct bthome_mqtt_config cfg = { .host = "localhost" };
+    struct bthome_mqtt_stats stats;
+    struct bthome_keys keys = { 0 };
+    struct bthome_columns cols;
+    struct bthome_mqtt *mqtt;
+    struct bthome_aes *aes;
+    double rate = 0;
+    uint64_t start;
+    double elapsed;
+    int opt;
+    int err;
+
+    while ((opt = getopt(argc, argv, "k:K:h:p:P:w:n:f:r:")) != -1) {
+        switch (opt) {
+        case 'k':
+            if (bthome_keys_add(&keys, optarg)) {
+                fprintf(stderr, "Invalid key: %s\n", optarg);
+                return 2;
+            }
+            break;
+        case 'K':
+            err = bthome_keys_load(&keys, optarg);
+            if (err < 0) {
+                fprintf(stderr, "%s: %s\n", optarg, strerror(-err));
+                return 2;
+            }
+            break;
+        case 'h':
+            cfg.host = optarg;
+            break;
+        case 'p':
+            cfg.port = strtoul(optarg, NULL, 0);
+            break;
+        case 'P':
+            cfg.prefix = optarg;
+            break;
+        case 'w':
+            cfg.window = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            cfg.batch = strtoul(optarg, NULL, 0);
+            break;
+        case 'f':
+            cfg.flush_ms = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            rate = strtod(optarg, NULL);
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind == argc) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    err = bthome_mqtt_connect(&mqtt, &cfg);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", cfg.host, strerror(-err));
+        return 1;
+    }
+
+    aes = bthome_host_aes_new();
+    if (bthome_columns_init(&cols, BATCH_FRAMES * BTHOME_DECODE_MAX_OBJECTS)) {
+        return 1;
+    }
+
+    start = now_ns();
+
+    for (int a = optind; a < argc && !err; a++) {
+        struct frames frames = { 0 };
+        struct bthome_capture cap;
+        long count;
+
+        err = bthome_capture_open(&cap, argv[a]);
+        if (err) {
+            fprintf(stderr, "%s: %s\n", argv[a], strerror(-err));
+            return 1;
+        }
+
+        count = bthome_capture_scan(&cap, collect, &frames);
+        if (count < 0) {
+            fprintf(stderr, "%s: %s\n", argv[a], strerror((int)-count));
+            return 1;
+        }
+
+        err = publish_capture(mqtt, &frames, &keys, aes, &cols, rate, start);
+
+        free(frames.list);
+        bthome_capture_close(&cap);
+    }
+
+    if (!err) {
+        err = bthome_mqtt_drain(mqtt, DRAIN_TIMEOUT_MS);
+    }
+    elapsed = (now_ns() - start) / 1e9;
+
+    bthome_mqtt_close(mqtt, &stats);
+
+    printf("%lu readings in %lu publishes (%.1f per publish), %lu acked, %lu bytes\n",
+           (unsigned long)stats.readings, (unsigned long)stats.publishes,
+           stats.publishes ? (double)stats.readings / stats.publishes : 0.0,
+           (unsigned long)stats.acked, (unsigned long)stats.bytes);
+    printf("%.2f s, %.0f readings/s, %.0f publishes/s, up to %u in flight\n", elapsed,
+           stats.readings / elapsed, stats.publishes / elapsed, stats.max_inflight);
+    if (stats.reconnects) {
+        printf("%lu reconnects, %lu publishes retransmitted\n",
+               (unsigned long)stats.reconnects, (unsigned long)stats.retransmits);
+    }
+
+    bthome_columns_free(&cols);
+    bthome_host_aes_free(aes);
+    bthome_keys_free(&keys);
+
+    if (err) {
+        fprintf(stderr, "MQTT: %s\n", strerror(-err));
+        return 1;
+    }
+
+    return stats.acked == stats.publishes ? 0 : 1;
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Replay a btsnoop or pcap capture through the BTHome codec and measure
+ * decode throughput. The capture is memory-mapped and indexed once, the
+ * timed loop then only runs bthome_codec_decode() over the index.
+ */
+
+#include <bthome_host.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+struct frames {
+    struct bthome_frame *list;
+    size_t count;
+    size_t cap;
+};
+
+struct results {
+    unsigned long ok;
+    unsigned long encrypted;
+    unsigned long objects;
+    unsigned long bad;              /* -EBADMSG: malformed or MIC mismatch */
+    unsigned long unsupported;      /* -ENOTSUP: unknown object, no key */
+    unsigned long other;
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int collect(const struct bthome_frame *frame, void *user)
+{
+    struct frames *frames = user;
+
+    if (frames->count == frames->cap) {
+        size_t cap = frames->cap ? 2 * frames->cap : 4096;
+        struct bthome_frame *list = realloc(frames->list, cap * sizeof(*list));
+
+        if (!list) {
+            return -ENOMEM;
+        }
+
+        frames->list = list;
+        frames->cap = cap;
+    }
+
+    frames->list[frames->count++] = *frame;
+
+    return 0;
+}
+
+static void print_packet(const struct bthome_frame *frame, const struct bthome_packet *pkt)
+{
+    printf("%llu.%06llu %02X:%02X:%02X:%02X:%02X:%02X%s",
+           (unsigned long long)(frame->timestamp_us / 1000000),
+           (unsigned long long)(frame->timestamp_us % 1000000),
+           frame->mac[5], frame->mac[4], frame->mac[3], frame->mac[2], frame->mac[1],
+           frame->mac[0], pkt->encrypted ? " enc" : "");
+
+    for (uint8_t i = 0; i < pkt->count; i++) {
+        const struct bthome_object *obj = &pkt->objects[i];
+
+        if (bthome_object_is_variable(obj->object_id)) {
+            printf(" %02x=\"%.*s\"", obj->object_id, obj->len, (const char *)obj->data);
+        } else {
+            printf(" %02x=%lld/%u", obj->object_id, (long long)obj->raw,
+                   bthome_object_scale(obj->object_id));
+        }
+    }
+
+    printf("\n");
+}
+
+static void decode_all(const struct frames *frames, const struct bthome_keys *keys,
+                       struct bthome_aes *aes, struct results *res, long print)
+{
+    struct bthome_packet pkt;
+
+    for (size_t i = 0; i < frames->count; i++) {
+        const struct bthome_frame *frame = &frames->list[i];
+        const uint8_t *key = NULL;
+        int err;
+
+        /* Key lookup only for encrypted packets */
+        if (frame->len > 2 && (frame->data[2] & 0x01)) {
+            key = bthome_keys_find(keys, frame->mac);
+            res->encrypted++;
+        }
+
+        err = bthome_codec_decode(frame->data, frame->len, frame->mac, key, aes, &pkt);
+        switch (err) {
+        case 0:
+            res->ok++;
+            res->objects += pkt.count;
+            if ((long)i < print) {
+                print_packet(frame, &pkt);
+            }
+            break;
+        case -EBADMSG:
+            res->bad++;
+            break;
+        case -ENOTSUP:
+            res->unsupported++;
+            break;
+        default:
+            res->other++;
+            break;
+        }
+    }
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-k MAC=KEY]... [-K keyfile] [-r repeats] [-v count] capture\n"
+            "  -k  bind key of one device, e.g. A4:C1:38:00:00:01=231d39c1d7cc1ab1aee224cd096db932\n"
+            "  -K  file with one MAC=KEY per line\n"
+            "  -r  timed decode passes over the capture (10)\n"
+            "  -v  print the first count decoded packets\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    struct bthome_keys keys = { 0 };
+    struct frames frames = { 0 };
+    struct results res = { 0 };
+    struct bthome_capture cap;
+    struct bthome_aes *aes;
+    unsigned long repeats = 10;
+    long print = 0;
+    uint64_t start;
+    uint64_t index_ns;
+    uint64_t decode_ns;
+    unsigned long total;
+    long count;
+    int opt;
+    int err;
+
+    while ((opt = getopt(argc, argv, "k:K:r:v:")) != -1) {
+        switch (opt) {
+        case 'k':
+            err = bthome_keys_add(&keys, optarg);
+            if (err) {
+                fprintf(stderr, "Invalid key: %s\n", optarg);
+                return 2;
+            }
+            break;
+        case 'K':
+            err = bthome_keys_load(&keys, optarg);
+            if (err < 0) {
+                fprintf(stderr, "%s: %s\n", optarg, strerror(-err));
+                return 2;
+            }
+            break;
+        case 'r':
+            repeats = strtoul(optarg, NULL, 0);
+            break;
+        case 'v':
+            print = strtol(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind != argc - 1 || repeats == 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    err = bthome_capture_open(&cap, argv[optind]);
+    if (err) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror(-err));
+        return 1;
+    }
+
+    start = now_ns();
+    count = bthome_capture_scan(&cap, collect, &frames);
+    index_ns = now_ns() - start;
+    if (count < 0) {
+        fprintf(stderr, "%s: %s\n", argv[optind], strerror((int)-count));
+        return 1;
+    }
+
+    printf("%s: %s, link type %u, %zu bytes, %ld BTHome frames, %zu keys\n",
+           argv[optind], cap.format == BTHOME_CAPTURE_BTSNOOP ? "btsnoop" : "pcap",
+           cap.linktype, cap.size, count, keys.count);
+    printf("index:  %.1f ms, %.0f MB/s, %.2f Mframes/s\n", index_ns / 1e6,
+           index_ns ? cap.size * 1e3 / index_ns : 0.0,
+           index_ns ? count * 1e3 / index_ns : 0.0);
+
+    aes = bthome_host_aes_new();
+    if (!aes) {
+        printf("No AES backend, encrypted frames are not decoded\n");
+    }
+
+    /* Untimed warm-up pass counts results and prints */
+    decode_all(&frames, &keys, aes, &res, print);
+
+    start = now_ns();
+    for (unsigned long r = 0; r < repeats; r++) {
+        struct results pass = { 0 };
+
+        decode_all(&frames, &keys, aes, &pass, 0);
+    }
+    decode_ns = now_ns() - start;
+    total = repeats * frames.count;
+
+    printf("decode: %zu frames (%lu encrypted): %lu ok, %lu objects, %lu bad, "
+           "%lu unsupported, %lu other\n",
+           frames.count, res.encrypted, res.ok, res.objects, res.bad, res.unsupported,
+           res.other);
+    if (total) {
+        printf("        %lu frames in %.1f ms, %.1f ns/frame, %.2f Mframes/s\n", total,
+               decode_ns / 1e6, (double)decode_ns / total, total * 1e3 / decode_ns);
+    }
+
+    bthome_host_aes_free(aes);
+    bthome_keys_free(&keys);
+    bthome_capture_close(&cap);
+    free(frames.list);
+
+    return 0;
+}
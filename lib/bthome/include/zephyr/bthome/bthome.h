@@ -13,6 +13,8 @@
 #include <zephyr/bluetooth/gap.h>
 #include <zephyr/sys/byteorder.h>
 
+#include <bthome_codec.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -34,119 +36,12 @@ extern "C" {
  * @{
  */
 
-/* BTHome v2 Protocol Constants */
-#define BTHOME_SERVICE_UUID         0xFCD2  /**< BTHome service UUID */
-#define BTHOME_MAX_PAYLOAD_SIZE     23      /**< Maximum payload size without encryption */
-#define BTHOME_MAX_PAYLOAD_ENC      15      /**< Maximum payload size with encryption */
-
-/* BTHome v2 Device Info Flags */
-#define BTHOME_NO_ENCRYPT           0x40    /**< BTHome v2, no encryption */
-#define BTHOME_NO_ENCRYPT_TRIGGER   0x44    /**< BTHome v2, no encryption, trigger-based */
-#define BTHOME_ENCRYPT              0x41    /**< BTHome v2, with encryption */
-#define BTHOME_ENCRYPT_TRIGGER      0x45    /**< BTHome v2, with encryption, trigger-based */
-
-/* BTHome v2 Object IDs - Sensor Measurements */
-#define BTHOME_ID_PACKET            0x00    /**< Packet ID (8-bit) */
-#define BTHOME_ID_BATTERY           0x01    /**< Battery (8-bit, %) */
-#define BTHOME_ID_TEMPERATURE_PRECISE 0x02  /**< Temperature precise (16-bit, 0.01°C) */
-#define BTHOME_ID_HUMIDITY_PRECISE  0x03    /**< Humidity precise (16-bit, 0.01%) */
-#define BTHOME_ID_PRESSURE          0x04    /**< Pressure (24-bit, 0.01 hPa) */
-#define BTHOME_ID_ILLUMINANCE       0x05    /**< Illuminance (24-bit, 0.01 lux) */
-#define BTHOME_ID_MASS              0x06    /**< Mass (16-bit, 0.01 kg) */
-#define BTHOME_ID_MASS_LB           0x07    /**< Mass (16-bit, 0.01 lb) */
-#define BTHOME_ID_DEWPOINT          0x08    /**< Dewpoint (16-bit, 0.01°C) */
-#define BTHOME_ID_COUNT             0x09    /**< Count (8-bit) */
-#define BTHOME_ID_ENERGY            0x0A    /**< Energy (24-bit, 0.001 kWh) */
-#define BTHOME_ID_POWER             0x0B    /**< Power (24-bit, 0.01 W) */
-#define BTHOME_ID_VOLTAGE           0x0C    /**< Voltage (16-bit, 0.001 V) */
-#define BTHOME_ID_PM25              0x0D    /**< PM2.5 (16-bit, μg/m³) */
-#define BTHOME_ID_PM10              0x0E    /**< PM10 (16-bit, μg/m³) */
-
-/* BTHome v2 Object IDs - Binary States */
-#define BTHOME_STATE_GENERIC_BOOLEAN 0x0F   /**< Generic boolean (8-bit) */
-#define BTHOME_STATE_POWER_ON       0x10    /**< Power state (8-bit) */
-#define BTHOME_STATE_OPENING        0x11    /**< Opening state (8-bit) */
-
-/* BTHome v2 Object IDs - Gas and Air Quality */
-#define BTHOME_ID_CO2               0x12    /**< CO2 (16-bit, ppm) */
-#define BTHOME_ID_TVOC              0x13    /**< TVOC (16-bit, μg/m³) */
-#define BTHOME_ID_MOISTURE_PRECISE  0x14    /**< Moisture precise (16-bit, 0.01%) */
-
-/* BTHome v2 Object IDs - Device States */
-#define BTHOME_STATE_BATTERY_LOW    0x15    /**< Battery low (8-bit) */
-#define BTHOME_STATE_BATTERY_CHARGING 0x16  /**< Battery charging (8-bit) */
-#define BTHOME_STATE_CO             0x17    /**< CO detected (8-bit) */
-#define BTHOME_STATE_COLD           0x18    /**< Cold detected (8-bit) */
-#define BTHOME_STATE_CONNECTIVITY   0x19    /**< Connectivity (8-bit) */
-#define BTHOME_STATE_DOOR           0x1A    /**< Door state (8-bit) */
-#define BTHOME_STATE_GARAGE_DOOR    0x1B    /**< Garage door (8-bit) */
-#define BTHOME_STATE_GAS_DETECTED   0x1C    /**< Gas detected (8-bit) */
-#define BTHOME_STATE_HEAT           0x1D    /**< Heat detected (8-bit) */
-#define BTHOME_STATE_LIGHT          0x1E    /**< Light state (8-bit) */
-#define BTHOME_STATE_LOCK           0x1F    /**< Lock state (8-bit) */
-#define BTHOME_STATE_MOISTURE       0x20    /**< Moisture detected (8-bit) */
-#define BTHOME_STATE_MOTION         0x21    /**< Motion detected (8-bit) */
-#define BTHOME_STATE_MOVING         0x22    /**< Moving state (8-bit) */
-#define BTHOME_STATE_OCCUPANCY      0x23    /**< Occupancy (8-bit) */
-#define BTHOME_STATE_PLUG           0x24    /**< Plug state (8-bit) */
-#define BTHOME_STATE_PRESENCE       0x25    /**< Presence (8-bit) */
-#define BTHOME_STATE_PROBLEM        0x26    /**< Problem detected (8-bit) */
-#define BTHOME_STATE_RUNNING        0x27    /**< Running state (8-bit) */
-#define BTHOME_STATE_SAFETY         0x28    /**< Safety state (8-bit) */
-#define BTHOME_STATE_SMOKE          0x29    /**< Smoke detected (8-bit) */
-#define BTHOME_STATE_SOUND          0x2A    /**< Sound detected (8-bit) */
-#define BTHOME_STATE_TAMPER         0x2B    /**< Tamper detected (8-bit) */
-#define BTHOME_STATE_VIBRATION      0x2C    /**< Vibration detected (8-bit) */
-#define BTHOME_STATE_WINDOW         0x2D    /**< Window state (8-bit) */
-
-/* BTHome v2 Object IDs - Additional Sensors */
-#define BTHOME_ID_HUMIDITY          0x2E    /**< Humidity (8-bit, %) */
-#define BTHOME_ID_MOISTURE          0x2F    /**< Moisture (8-bit, %) */
-
-/* BTHome v2 Object IDs - Events */
-#define BTHOME_EVENT_BUTTON         0x3A    /**< Button press event */
-#define BTHOME_EVENT_DIMMER         0x3C    /**< Dimmer event */
-
-/* BTHome v2 Object IDs - Extended Counters */
-#define BTHOME_ID_COUNT2            0x3D    /**< Count (16-bit) */
-#define BTHOME_ID_COUNT4            0x3E    /**< Count (32-bit) */
-
-/* BTHome v2 Object IDs - Additional Measurements */
-#define BTHOME_ID_ROTATION          0x3F    /**< Rotation (16-bit, 0.1°) */
-#define BTHOME_ID_DISTANCE          0x40    /**< Distance (16-bit, mm) */
-#define BTHOME_ID_DISTANCE_M        0x41    /**< Distance (16-bit, 0.1 m) */
-#define BTHOME_ID_DURATION          0x42    /**< Duration (24-bit, 0.001 s) */
-#define BTHOME_ID_CURRENT           0x43    /**< Current (16-bit, 0.001 A) */
-#define BTHOME_ID_SPEED             0x44    /**< Speed (16-bit, 0.01 m/s) */
-#define BTHOME_ID_TEMPERATURE       0x45    /**< Temperature (16-bit, 0.1°C) */
-#define BTHOME_ID_UV                0x46    /**< UV index (8-bit, 0.1) */
-#define BTHOME_ID_VOLUME1           0x47    /**< Volume (16-bit, 0.1 L) */
-#define BTHOME_ID_VOLUME2           0x48    /**< Volume (16-bit, mL) */
-#define BTHOME_ID_VOLUME_FLOW_RATE  0x49    /**< Volume flow rate (16-bit, m³/hr) */
-#define BTHOME_ID_VOLTAGE1          0x4A    /**< Voltage (16-bit, 0.1 V) */
-#define BTHOME_ID_GAS               0x4B    /**< Gas (24-bit, 0.001 m³) */
-#define BTHOME_ID_GAS4              0x4C    /**< Gas (32-bit, 0.001 m³) */
-#define BTHOME_ID_ENERGY4           0x4D    /**< Energy (32-bit, 0.001 kWh) */
-#define BTHOME_ID_VOLUME            0x4E    /**< Volume (32-bit, 0.001 m³) */
-#define BTHOME_ID_WATER             0x4F    /**< Water (32-bit, 0.001 L) */
-#define BTHOME_ID_TIMESTAMP         0x50    /**< Timestamp (32-bit, Unix epoch) */
-
-/* BTHome v2 Event Values */
-#define BTHOME_EVENT_BUTTON_NONE             0x00  /**< No button event */
-#define BTHOME_EVENT_BUTTON_PRESS            0x01  /**< Button press */
-#define BTHOME_EVENT_BUTTON_DOUBLE_PRESS     0x02  /**< Button double press */
-#define BTHOME_EVENT_BUTTON_TRIPLE_PRESS     0x03  /**< Button triple press */
-#define BTHOME_EVENT_BUTTON_LONG_PRESS       0x04  /**< Button long press */
-#define BTHOME_EVENT_BUTTON_LONG_DOUBLE_PRESS 0x05 /**< Button long double press */
-#define BTHOME_EVENT_BUTTON_LONG_TRIPLE_PRESS 0x06 /**< Button long triple press */
-
-#define BTHOME_EVENT_DIMMER_NONE    0x00    /**< No dimmer event */
-#define BTHOME_EVENT_DIMMER_LEFT    0x01    /**< Dimmer rotate left */
-#define BTHOME_EVENT_DIMMER_RIGHT   0x02    /**< Dimmer rotate right */
-
-/* BTHome v2 State Values */
-#define BTHOME_STATE_OFF            0x00    /**< State: OFF */
-#define BTHOME_STATE_ON             0x01    /**< State: ON */
+/* Advertising channel selection (struct bthome_config.adv_channels) */
+#define BTHOME_ADV_CHAN_37          BIT(0)  /**< Advertise on channel 37 */
+#define BTHOME_ADV_CHAN_38          BIT(1)  /**< Advertise on channel 38 */
+#define BTHOME_ADV_CHAN_39          BIT(2)  /**< Advertise on channel 39 */
+#define BTHOME_ADV_CHAN_ALL         (BTHOME_ADV_CHAN_37 | BTHOME_ADV_CHAN_38 | \
+                                     BTHOME_ADV_CHAN_39) /**< All channels */
 
 /**
  * @brief BTHome device configuration
@@ -156,6 +51,14 @@ struct bthome_config {
     bool encryption;                /**< Enable encryption */
     bool trigger_based;             /**< Trigger-based device */
     uint8_t bind_key[16];          /**< Encryption key (if encryption enabled) */
+    /**
+     * Advertising channels (BTHOME_ADV_CHAN_*), 0 = all three. Restrict
+     * only in controlled installations where the gateway listens on a
+     * known channel, e.g. the scan driver with the same channels in
+     * bthome_scanner_config: each dropped channel saves a third of the
+     * TX energy, but generic scanners may miss the device.
+     */
+    uint8_t adv_channels;
 };
 
 /**
@@ -174,6 +77,22 @@ struct bthome_measurement {
     uint8_t data_size;             /**< Size of raw data (if applicable) */
 };
 
+#if defined(CONFIG_BTHOME_SLOW_OBJECTS)
+/**
+ * @brief Rarely-changing object with its own cadence
+ */
+struct bthome_slow_object {
+    uint8_t object_id;             /**< BTHome object ID, 0 = unused slot */
+    uint8_t size;                  /**< Encoded value size */
+    uint8_t data[8];               /**< Encoded little-endian value */
+    bool changed;                  /**< Value differs from last sent one */
+    uint16_t every_n;              /**< Send every Nth packet, 0 = never */
+    uint32_t min_interval_ms;      /**< On change, at most once per interval */
+    uint32_t last_packet;          /**< Packet number of last inclusion */
+    int64_t last_sent_ms;          /**< Uptime of last inclusion */
+};
+#endif
+
 /**
  * @brief BTHome device instance
  */
@@ -184,7 +103,25 @@ struct bthome_device {
     bool advertising;              /**< Advertising state */
     uint32_t encrypt_counter;      /**< Encryption counter */
     struct bt_data ad_data[3];     /**< Advertisement data elements */
+    uint8_t service_data[2][BTHOME_SERVICE_DATA_MAX]; /**< Encoded service data, A/B */
+    uint8_t service_front;         /**< Half last handed to the advertiser */
     struct k_work_delayable adv_work; /**< Advertisement work item */
+    uint8_t reserved_len;          /**< Bytes of the pending reservation */
+#if defined(CONFIG_BTHOME_ENCRYPTION)
+    uint8_t keystream[2][16];      /**< Precomputed CCM keystream S0, S1 */
+    uint32_t keystream_counter;    /**< Counter the keystream belongs to */
+    uint8_t keystream_info;        /**< Device info the keystream belongs to */
+    uint8_t keystream_mac[6];      /**< Nonce address the keystream belongs to */
+    bool keystream_valid;          /**< Keystream matches next packet */
+#endif
+#if defined(CONFIG_BTHOME_ENCRYPTION_COUNTER_PERSIST)
+    uint32_t counter_limit;        /**< First counter value not yet reserved in flash */
+#endif
+#if defined(CONFIG_BTHOME_SLOW_OBJECTS)
+    struct bthome_slow_object slow[CONFIG_BTHOME_MAX_SLOW_OBJECTS]; /**< Slow objects */
+    uint32_t packet_count;         /**< Number of packets advertised */
+    uint16_t slow_pending;         /**< Slow objects in the packet being sent */
+#endif
 };
 
 /**
@@ -213,6 +150,33 @@ void bthome_reset_measurements(struct bthome_device *dev);
 int bthome_add_measurement(struct bthome_device *dev, 
                           const struct bthome_measurement *measurement);
 
+/**
+ * @brief Reserve space for an object in the current packet
+ *
+ * Writes the object ID, plus the length byte for the variable-length
+ * text (BTHOME_ID_TEXT) and raw (BTHOME_ID_RAW) objects, and returns a
+ * pointer to len bytes of payload for the caller to fill in place. The
+ * object becomes part of the packet with bthome_payload_commit(). For
+ * fixed-size objects len must match the object size.
+ *
+ * @param dev BTHome device instance
+ * @param object_id BTHome object ID
+ * @param len Number of value bytes
+ * @param ptr Set to the reserved value bytes
+ * @return 0 on success, -ENOSPC if the object does not fit, -EBUSY if
+ *         another reservation is pending
+ */
+int bthome_payload_reserve(struct bthome_device *dev, uint8_t object_id,
+                           uint8_t len, uint8_t **ptr);
+
+/**
+ * @brief Commit the pending reservation
+ *
+ * @param dev BTHome device instance
+ * @return 0 on success, -EINVAL if nothing was reserved
+ */
+int bthome_payload_commit(struct bthome_device *dev);
+
 /**
  * @brief Add a state measurement (binary sensor)
  * 
@@ -235,16 +199,49 @@ int bthome_add_sensor(struct bthome_device *dev, uint8_t object_id, float value)
 
 /**
  * @brief Add an event measurement
- * 
+ *
+ * Button events are encoded as one byte. Dimmer events are encoded as the
+ * two-byte BTHome dimmer object: event type followed by the step count.
+ *
  * @param dev BTHome device instance
  * @param object_id BTHome object ID
  * @param event Event value
- * @param steps Number of steps (for dimmer events, optional)
+ * @param steps Number of steps (dimmer events only, ignored otherwise)
  * @return 0 on success, negative error code on failure
  */
 int bthome_add_event(struct bthome_device *dev, uint8_t object_id, 
                      uint8_t event, uint8_t steps);
 
+#if defined(CONFIG_BTHOME_SLOW_OBJECTS)
+/**
+ * @brief Set a rarely-changing object and its cadence
+ *
+ * Slow objects survive bthome_reset_measurements() and are appended by
+ * bthome_advertise() only on the packets where they are due: every
+ * every_n packets, and when the value changed, at most once per
+ * min_interval_ms. A new object is sent on the next packet. Call again
+ * with the same object ID to update the value or the cadence.
+ *
+ * @param dev BTHome device instance
+ * @param measurement Object ID and value
+ * @param every_n Include every Nth packet, 0 to send on change only
+ * @param min_interval_ms Minimum time between on-change inclusions
+ * @return 0 on success, -ENOMEM if all slots are in use
+ */
+int bthome_set_slow_object(struct bthome_device *dev,
+                           const struct bthome_measurement *measurement,
+                           uint16_t every_n, uint32_t min_interval_ms);
+
+/**
+ * @brief Remove a rarely-changing object
+ *
+ * @param dev BTHome device instance
+ * @param object_id BTHome object ID
+ * @return 0 on success, -ENOENT if the object was not set
+ */
+int bthome_remove_slow_object(struct bthome_device *dev, uint8_t object_id);
+#endif
+
 /**
  * @brief Send current measurements as advertisement
  * 
@@ -254,6 +251,44 @@ int bthome_add_event(struct bthome_device *dev, uint8_t object_id,
  */
 int bthome_advertise(struct bthome_device *dev, uint32_t duration_ms);
 
+/**
+ * @brief Publish the current measurements while advertising
+ *
+ * Builds the packet into the idle half of the device's double-buffered
+ * service data and hands it to the running advertiser with
+ * bt_le_adv_update_data(). Only once that succeeded does the new half
+ * become the front one; the half the advertiser was given before is
+ * never written while it may still be in use. Measurements can thus be
+ * updated at the sensor's own rate without restarting advertising, and
+ * may be reset right after this call. The measurements and advertising
+ * state of a device have no locking: fill, advertise and publish one
+ * device from a single thread.
+ *
+ * @param dev BTHome device instance
+ * @return 0 on success, -EALREADY if not advertising, negative error code
+ *         on failure
+ */
+int bthome_publish(struct bthome_device *dev);
+
+/**
+ * @brief Encode the current measurements as BTHome service data
+ *
+ * Writes the UUID, device info byte and payload (encrypted if configured)
+ * to a caller buffer without touching the advertiser. Used to generate
+ * traffic for gateway tests; an encrypted device consumes one counter
+ * value per call.
+ *
+ * @param dev BTHome device instance
+ * @param mac Address used for the encryption nonce in bt_addr_t (little
+ *            endian) order, or NULL for the local identity address
+ * @param out Output buffer
+ * @param size Size of the output buffer
+ * @return Number of bytes written, -ENOMEM if the buffer is too small,
+ *         negative error code on failure
+ */
+int bthome_encode(struct bthome_device *dev, const uint8_t mac[6],
+                  uint8_t *out, size_t size);
+
 /**
  * @brief Stop advertising
  * 
@@ -274,12 +309,55 @@ bool bthome_is_advertising(const struct bthome_device *dev);
  * @brief Set fixed MAC address based on device-specific hardware ID
  * 
  * This function generates a stable MAC address from the device's factory-programmed
- * unique identifier (e.g., Nordic FICR.DEVICEADDR).
+ * unique identifier (Nordic FICR.DEVICEADDR, or FICR.INFO.DEVICEID on the
+ * nRF5340 application core). It must run before
+ * bt_enable(). With CONFIG_BTHOME_AUTO_MAC it is called automatically from
+ * a SYS_INIT hook and applications must not call it again.
  * 
  * @return 0 on success, negative error code on failure
  */
 int bthome_set_fixed_mac(void);
 
+#if defined(CONFIG_BTHOME_STATS)
+/** Estimated HCI commands per bt_le_adv_start() (params, data, enable) */
+#define BTHOME_HCI_CMDS_EST_ADV_START   3
+/** Estimated HCI commands per bt_le_adv_stop() */
+#define BTHOME_HCI_CMDS_EST_ADV_STOP    1
+/** Estimated HCI commands per bt_le_adv_update_data() */
+#define BTHOME_HCI_CMDS_EST_ADV_UPDATE  1
+
+/**
+ * @brief Controller traffic caused by the library
+ *
+ * The host does not expose an HCI command counter, so hci_commands_est
+ * is an estimate: the API calls counted here times the commands of the
+ * legacy, non-scannable advertising path. Extra commands such as a
+ * random address update are not included. Check the real traffic with
+ * the Bluetooth monitor (CONFIG_BT_DEBUG_MONITOR_RTT and btmon). On
+ * split-controller SoCs such as the nRF5340 every command and its
+ * completion event cross the IPC link.
+ */
+struct bthome_stats {
+    uint32_t packets;              /**< Packets built */
+    uint32_t adv_starts;           /**< Successful bt_le_adv_start() calls */
+    uint32_t adv_stops;            /**< Successful bt_le_adv_stop() calls */
+    uint32_t data_updates;         /**< Successful bt_le_adv_update_data() calls */
+    uint32_t hci_commands_est;     /**< Estimated HCI commands for the above */
+};
+
+/**
+ * @brief Get the library statistics
+ *
+ * @param stats Filled with the counters since boot or the last reset
+ */
+void bthome_get_stats(struct bthome_stats *stats);
+
+/**
+ * @brief Reset the library statistics
+ */
+void bthome_reset_stats(void);
+#endif
+
 /**
  * @}
  */
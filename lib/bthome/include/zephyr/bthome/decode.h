@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_BTHOME_DECODE_H_
+#define ZEPHYR_INCLUDE_BTHOME_DECODE_H_
+
+#include <zephyr/bthome/bthome.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Gateway side: parse received BTHome service data
+ *
+ * The decoder takes the service data element of an advertisement (UUID
+ * included), verifies and decrypts encrypted packets and splits the
+ * payload into objects. Parsing is done by the freestanding codec
+ * (bthome_codec.h), which also provides struct bthome_packet and
+ * bthome_packet_find(); this wrapper supplies the configured AES backend.
+ */
+
+/**
+ * @addtogroup bthome
+ * @{
+ */
+
+/**
+ * @brief Decode BTHome service data
+ *
+ * @param service_data Service data starting with the 16-bit UUID
+ * @param len Length of the service data
+ * @param mac Sender address in bt_addr_t (little endian) order, only
+ *            used for encrypted packets
+ * @param key Bind key of the sender, NULL if unknown
+ * @param pkt Decoded packet
+ * @return 0 on success, -EBADMSG if the data is malformed or fails
+ *         authentication, -ENOTSUP for other UUIDs or versions, unknown
+ *         object IDs and encrypted packets without key, -ENOMEM if the
+ *         packet has more than CONFIG_BTHOME_DECODE_MAX_OBJECTS objects
+ */
+int bthome_decode(const uint8_t *service_data, size_t len, const uint8_t mac[6],
+                  const uint8_t key[16], struct bthome_packet *pkt);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_BTHOME_DECODE_H_ */
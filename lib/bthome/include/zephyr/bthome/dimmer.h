@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_BTHOME_DIMMER_H_
+#define ZEPHYR_INCLUDE_BTHOME_DIMMER_H_
+
+#include <zephyr/bthome/bthome.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Rotary encoder to BTHome dimmer events
+ *
+ * On Nordic SoCs the QDEC peripheral decodes the encoder and accumulates
+ * the position in its ACC register with all interrupts disabled, so knob
+ * spins never wake the CPU per detent. At advertising time the
+ * accumulator is read once and all detents since the previous packet
+ * collapse into a single dimmer event with a step count. The encoder
+ * pins are taken from the pinctrl of the enabled "nordic,nrf-qdec" node,
+ * for example:
+ *
+ * @code{.dts}
+ * &pinctrl {
+ *     qdec_default: qdec_default {
+ *         group1 {
+ *             psels = <NRF_PSEL(QDEC_A, 0, 28)>, <NRF_PSEL(QDEC_B, 0, 29)>;
+ *         };
+ *     };
+ * };
+ *
+ * &qdec {
+ *     status = "okay";
+ *     pinctrl-0 = <&qdec_default>;
+ *     pinctrl-names = "default";
+ *     steps = <24>;
+ *     led-pre = <0>;
+ * };
+ * @endcode
+ *
+ * With CONFIG_BTHOME_DIMMER_EMUL (e.g. on native_sim) rotation is
+ * injected by software through bthome_dimmer_emul_rotate().
+ */
+
+/**
+ * @addtogroup bthome
+ * @{
+ */
+
+/**
+ * @brief Initialize the rotary encoder input
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int bthome_dimmer_init(void);
+
+/**
+ * @brief Read accumulated rotation in steps
+ *
+ * Steps not yet reported are consumed. Partial steps are kept for the
+ * next call.
+ *
+ * @param steps Signed number of steps (positive = right)
+ * @return 0 on success, negative error code on failure
+ */
+int bthome_dimmer_read(int32_t *steps);
+
+/**
+ * @brief Add a dimmer event for the rotation since the previous call
+ *
+ * At most 255 steps are reported per event, the remainder is carried to
+ * the next packet.
+ *
+ * @param dev BTHome device instance
+ * @return 0 on success, -ENODATA if the knob was not turned,
+ *         negative error code on failure
+ */
+int bthome_dimmer_add(struct bthome_device *dev);
+
+#if defined(CONFIG_BTHOME_DIMMER_EMUL)
+/**
+ * @brief Inject encoder counts into the emulated decoder
+ *
+ * @param counts Signed number of quadrature counts (positive = right)
+ */
+void bthome_dimmer_emul_rotate(int32_t counts);
+#endif
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_BTHOME_DIMMER_H_ */
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_BTHOME_DT_H_
+#define ZEPHYR_INCLUDE_BTHOME_DT_H_
+
+#include <zephyr/bthome/bthome.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief BTHome objects declared in devicetree
+ *
+ * A "zephyr,bthome-device" node lists the objects of a packet, the sensor
+ * channel each one is read from, its cadence and its deadband.
+ * BTHOME_DT_OBJECTS_DEFINE() turns the node into a const descriptor table.
+ * Object sizes and scale factors are constants from BTHOME_OBJECT_TABLE,
+ * the table the codec is built from, so unknown object IDs, objects out
+ * of ascending ID order and packets over the (encrypted) payload limit
+ * fail the build.
+ */
+
+/**
+ * @addtogroup bthome
+ * @{
+ */
+
+/**
+ * @brief Object descriptor generated from devicetree
+ */
+struct bthome_dt_object {
+    const struct device *sensor;   /**< Sensor device */
+    uint16_t channel;              /**< enum sensor_channel */
+    uint8_t object_id;             /**< BTHome object ID */
+    uint8_t size;                  /**< Encoded size in bytes */
+    uint32_t scale;                /**< Raw units per channel unit */
+    uint16_t every_n;              /**< Send at least every Nth packet */
+    uint32_t deadband;             /**< Send on change by this many raw units */
+};
+
+/**
+ * @brief Run-time state of one object
+ */
+struct bthome_dt_state {
+    int32_t last;                  /**< Raw value last sent */
+    uint16_t skipped;              /**< Packets since last sent */
+    bool valid;                    /**< Object was sent at least once */
+};
+
+/** @cond INTERNAL_HIDDEN */
+
+#define BTHOME_DT_SIZE(id)  BTHOME_OBJECT_SIZE(id)
+#define BTHOME_DT_SCALE(id) BTHOME_OBJECT_SCALE(id)
+
+#define BTHOME_DT_PROP_OR(node_id, prop, idx, def)                              \
+    COND_CODE_1(DT_PROP_HAS_IDX(node_id, prop, idx),                           \
+                (DT_PROP_BY_IDX(node_id, prop, idx)), (def))
+
+#define BTHOME_DT_OBJECT(node_id, prop, idx)                                    \
+    {                                                                          \
+        .sensor = DEVICE_DT_GET(DT_PHANDLE_BY_IDX(node_id, sensors, idx)),     \
+        .channel = DT_PROP_BY_IDX(node_id, sensor_channels, idx),              \
+        .object_id = DT_PROP_BY_IDX(node_id, prop, idx),                       \
+        .size = BTHOME_DT_SIZE(DT_PROP_BY_IDX(node_id, prop, idx)),            \
+        .scale = BTHOME_DT_SCALE(DT_PROP_BY_IDX(node_id, prop, idx)),          \
+        .every_n = BTHOME_DT_PROP_OR(node_id, every_n, idx, 1),                \
+        .deadband = BTHOME_DT_PROP_OR(node_id, deadband, idx, 0),              \
+    },
+
+#define BTHOME_DT_OBJECT_LEN(node_id, prop, idx)                                \
+    + 1 + BTHOME_DT_SIZE(DT_PROP_BY_IDX(node_id, prop, idx))
+
+#define BTHOME_DT_OBJECT_KNOWN(node_id, prop, idx)                              \
+    && (BTHOME_DT_SIZE(DT_PROP_BY_IDX(node_id, prop, idx)) > 0)
+
+#define BTHOME_DT_OBJECT_ORDERED(node_id, prop, idx)                            \
+    && (DT_PROP_BY_IDX(node_id, prop, idx) >=                                  \
+        DT_PROP_BY_IDX(node_id, prop, UTIL_DEC(idx)))
+
+/** @endcond */
+
+/**
+ * @brief Encoded payload size of a "zephyr,bthome-device" node
+ */
+#define BTHOME_DT_PAYLOAD_SIZE(node_id)                                         \
+    (0 DT_FOREACH_PROP_ELEM(node_id, object_ids, BTHOME_DT_OBJECT_LEN))
+
+/**
+ * @brief Payload limit of a node, lower with the "encrypted" property
+ */
+#define BTHOME_DT_PAYLOAD_MAX(node_id)                                          \
+    (DT_PROP(node_id, encrypted) ? BTHOME_MAX_PAYLOAD_ENC :                    \
+                                   BTHOME_MAX_PAYLOAD_SIZE)
+
+/**
+ * @brief Define the descriptor table and state of a devicetree node
+ *
+ * Defines the arrays name[] and name_state[].
+ *
+ * @param node_id "zephyr,bthome-device" node
+ * @param name Name of the descriptor array
+ */
+#define BTHOME_DT_OBJECTS_DEFINE(node_id, name)                                 \
+    BUILD_ASSERT(DT_PROP_LEN(node_id, sensors) ==                              \
+                 DT_PROP_LEN(node_id, object_ids) &&                           \
+                 DT_PROP_LEN(node_id, sensor_channels) ==                      \
+                 DT_PROP_LEN(node_id, object_ids),                             \
+                 "bthome: one sensor and channel per object required");        \
+    BUILD_ASSERT(1 DT_FOREACH_PROP_ELEM(node_id, object_ids,                   \
+                                        BTHOME_DT_OBJECT_KNOWN),               \
+                 "bthome: unknown or variable-length object ID");              \
+    BUILD_ASSERT(BTHOME_DT_PAYLOAD_SIZE(node_id) <=                            \
+                 BTHOME_DT_PAYLOAD_MAX(node_id),                               \
+                 "bthome: objects exceed the advertising payload");            \
+    BUILD_ASSERT(1 DT_FOREACH_PROP_ELEM(node_id, object_ids,                   \
+                                        BTHOME_DT_OBJECT_ORDERED),             \
+                 "bthome: object-ids must be in ascending order");             \
+    static const struct bthome_dt_object name[] = {                           \
+        DT_FOREACH_PROP_ELEM(node_id, object_ids, BTHOME_DT_OBJECT)            \
+    };                                                                         \
+    static struct bthome_dt_state name##_state[ARRAY_SIZE(name)]
+
+/**
+ * @brief Read the sensors and add the objects that are due
+ *
+ * Fetches every sensor once and appends each object whose cadence
+ * expired or whose value moved by at least its deadband, in table
+ * order. Call after bthome_reset_measurements().
+ *
+ * @param dev BTHome device instance
+ * @param objects Descriptor table
+ * @param state State array of the same length
+ * @param count Number of objects
+ * @return Number of objects added, negative error code on failure
+ */
+int bthome_dt_update(struct bthome_device *dev, const struct bthome_dt_object *objects,
+                     struct bthome_dt_state *state, size_t count);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_BTHOME_DT_H_ */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_BTHOME_PACKER_H_
+#define ZEPHYR_INCLUDE_BTHOME_PACKER_H_
+
+#include <zephyr/bthome/bthome.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Value-based selection of objects for a packet
+ *
+ * Measurements are queued with a priority and the magnitude of their
+ * change. When a packet is built, the packer solves the 0/1 knapsack over
+ * the queued objects with the free payload bytes as budget. Each object
+ * is worth
+ *
+ *     (priority + 1) * (seconds queued + 1) + change
+ *
+ * so stale and fast-moving values win over unchanged ones. Objects that
+ * do not make it stay queued and gain value until they are sent.
+ */
+
+/**
+ * @addtogroup bthome
+ * @{
+ */
+
+/** @cond INTERNAL_HIDDEN */
+struct bthome_packer_entry {
+    struct bthome_measurement measurement;
+    uint8_t priority;
+    uint32_t change;
+    int64_t queued_ms;
+};
+/** @endcond */
+
+/**
+ * @brief Queue of measurements waiting for a packet
+ */
+struct bthome_packer {
+    /** @cond INTERNAL_HIDDEN */
+    struct bthome_packer_entry entries[CONFIG_BTHOME_MAX_MEASUREMENTS];
+    uint8_t count;
+    /** @endcond */
+};
+
+/**
+ * @brief Queue a measurement or update a queued one
+ *
+ * A measurement with an object ID that is already queued replaces the
+ * queued value, keeps its queueing time and accumulates the change.
+ *
+ * @param packer Packer instance
+ * @param measurement Fixed-size measurement to queue
+ * @param priority Importance, 0 = lowest
+ * @param change Magnitude of the change since the value was last sent,
+ *               in raw units
+ * @return 0 on success, -ENOMEM if the queue is full
+ */
+int bthome_packer_queue(struct bthome_packer *packer,
+                        const struct bthome_measurement *measurement,
+                        uint8_t priority, uint32_t change);
+
+/**
+ * @brief Add the most valuable queued objects to the current packet
+ *
+ * Fills the payload space that is still free in dev and removes the
+ * packed objects from the queue.
+ *
+ * @param packer Packer instance
+ * @param dev BTHome device instance
+ * @return Number of objects added, negative error code on failure
+ */
+int bthome_packer_pack(struct bthome_packer *packer, struct bthome_device *dev);
+
+/**
+ * @brief Number of queued objects
+ *
+ * @param packer Packer instance
+ * @return Number of objects waiting for a packet
+ */
+static inline uint8_t bthome_packer_pending(const struct bthome_packer *packer)
+{
+    return packer->count;
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_BTHOME_PACKER_H_ */
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_BTHOME_PACKET_HPP_
+#define ZEPHYR_INCLUDE_BTHOME_PACKET_HPP_
+
+/**
+ * @file
+ * @brief Compile-time BTHome packet layout for C++17
+ *
+ * A packet is declared as a list of typed object tags, for example
+ * @code
+ * using MeterPacket = bthome::Packet<bthome::Power, bthome::Energy4>;
+ *
+ * MeterPacket::write(dev, bthome::scaled<bthome::Power>(230.5f), energy_wh);
+ * bthome_advertise(&dev, 1000);
+ * @endcode
+ * Object sizes, offsets and scale factors are constants, so encoding
+ * compiles down to direct stores into the device payload, and a packet
+ * that does not fit into an advertisement or lists its objects out of
+ * ascending ID order fails to build.
+ *
+ * Requires CONFIG_CPP, CONFIG_STD_CPP17 and a C++ standard library.
+ */
+
+#include <zephyr/bthome/bthome.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace bthome {
+
+/**
+ * @brief Object tag: ID, raw type, scale factor and encoded size
+ *
+ * @tparam Id BTHome object ID
+ * @tparam Raw Integer type of the encoded value
+ * @tparam Scale Raw units per physical unit
+ * @tparam Size Encoded size in bytes, at most sizeof(Raw)
+ */
+template <uint8_t Id, typename Raw, uint32_t Scale, size_t Size = sizeof(Raw)>
+struct Object {
+    static_assert(std::is_integral_v<Raw>, "raw type must be an integer");
+    static_assert(Size >= 1 && Size <= sizeof(Raw), "invalid encoded size");
+    static_assert(Size == BTHOME_OBJECT_SIZE(Id) && Scale == BTHOME_OBJECT_SCALE(Id),
+                  "size or scale differs from BTHOME_OBJECT_TABLE");
+
+    static constexpr uint8_t id = Id;
+    using raw_type = Raw;
+    static constexpr uint32_t scale = Scale;
+    static constexpr size_t size = Size;
+};
+
+/* Sensor measurements */
+struct Battery : Object<BTHOME_ID_BATTERY, uint8_t, 1> {};
+struct Temperature : Object<BTHOME_ID_TEMPERATURE_PRECISE, int16_t, 100> {};
+struct TemperatureCoarse : Object<BTHOME_ID_TEMPERATURE, int16_t, 10> {};
+struct Humidity : Object<BTHOME_ID_HUMIDITY_PRECISE, uint16_t, 100> {};
+struct Pressure : Object<BTHOME_ID_PRESSURE, uint32_t, 100, 3> {};
+struct Illuminance : Object<BTHOME_ID_ILLUMINANCE, uint32_t, 100, 3> {};
+struct Co2 : Object<BTHOME_ID_CO2, uint16_t, 1> {};
+struct Voltage : Object<BTHOME_ID_VOLTAGE, uint16_t, 1000> {};
+struct Current : Object<BTHOME_ID_CURRENT, uint16_t, 1000> {};
+struct Power : Object<BTHOME_ID_POWER, uint32_t, 100, 3> {};
+struct Energy4 : Object<BTHOME_ID_ENERGY4, uint32_t, 1000> {};
+struct VolumeFlowRate : Object<BTHOME_ID_VOLUME_FLOW_RATE, uint16_t, 1000> {};
+struct Volume : Object<BTHOME_ID_VOLUME, uint32_t, 1000> {};
+struct Water : Object<BTHOME_ID_WATER, uint32_t, 1000> {};
+struct Count : Object<BTHOME_ID_COUNT, uint8_t, 1> {};
+struct Count2 : Object<BTHOME_ID_COUNT2, uint16_t, 1> {};
+struct Count4 : Object<BTHOME_ID_COUNT4, uint32_t, 1> {};
+struct Timestamp : Object<BTHOME_ID_TIMESTAMP, uint32_t, 1> {};
+
+/* Binary states */
+struct Door : Object<BTHOME_STATE_DOOR, uint8_t, 1> {};
+struct Window : Object<BTHOME_STATE_WINDOW, uint8_t, 1> {};
+struct Motion : Object<BTHOME_STATE_MOTION, uint8_t, 1> {};
+struct BatteryLow : Object<BTHOME_STATE_BATTERY_LOW, uint8_t, 1> {};
+
+/* Events, the dimmer raw value is event type | steps << 8 */
+struct Button : Object<BTHOME_EVENT_BUTTON, uint8_t, 1> {};
+struct Dimmer : Object<BTHOME_EVENT_DIMMER, uint16_t, 1> {};
+
+/**
+ * @brief Convert a physical value to the raw value of an object
+ *
+ * Truncates like bthome_add_sensor().
+ */
+template <typename Obj>
+constexpr typename Obj::raw_type scaled(float value)
+{
+    return static_cast<typename Obj::raw_type>(value * Obj::scale);
+}
+
+/**
+ * @brief Fixed packet layout made of the given objects, in order
+ */
+template <typename... Objs>
+class Packet {
+    static_assert(sizeof...(Objs) > 0, "empty BTHome packet");
+
+    static constexpr std::array<size_t, sizeof...(Objs)> offsets()
+    {
+        std::array<size_t, sizeof...(Objs)> result{};
+        size_t sizes[] = {(1 + Objs::size)...};
+        size_t offset = 0;
+
+        for (size_t i = 0; i < sizeof...(Objs); i++) {
+            result[i] = offset;
+            offset += sizes[i];
+        }
+
+        return result;
+    }
+
+public:
+    /** Encoded size in bytes, object IDs included */
+    static constexpr size_t size = ((1 + Objs::size) + ...);
+
+    /** Offset of each object ID within the payload */
+    static constexpr std::array<size_t, sizeof...(Objs)> offset = offsets();
+
+    /** Packet also fits when encryption is enabled */
+    static constexpr bool fits_encrypted = size <= BTHOME_MAX_PAYLOAD_ENC;
+
+    static_assert(size <= BTHOME_MAX_PAYLOAD_SIZE,
+                  "BTHome packet exceeds the advertising payload");
+
+    static constexpr bool ascending()
+    {
+        uint8_t ids[] = {Objs::id...};
+
+        for (size_t i = 1; i < sizeof...(Objs); i++) {
+            if (ids[i] < ids[i - 1]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static_assert(ascending(), "BTHome objects must be in ascending ID order");
+
+    using buffer = std::array<uint8_t, size>;
+
+    /**
+     * @brief Encode raw values into a byte array
+     */
+    static constexpr buffer encode(typename Objs::raw_type... raw)
+    {
+        buffer out{};
+
+        encode_into(out.data(), std::index_sequence_for<Objs...>{}, raw...);
+        return out;
+    }
+
+    /**
+     * @brief Encode raw values directly into the payload of a device
+     *
+     * Replaces the current measurements and drops a pending reservation,
+     * bthome_advertise() sends them without further copies.
+     *
+     * @return 0 on success, -ENOSPC if the packet is too large for an
+     *         encrypted device
+     */
+    static int write(struct bthome_device &dev, typename Objs::raw_type... raw)
+    {
+        static_assert(size <= sizeof(dev.payload), "payload buffer too small");
+
+        if (!fits_encrypted && dev.config.encryption) {
+            return -ENOSPC;
+        }
+
+        encode_into(dev.payload, std::index_sequence_for<Objs...>{}, raw...);
+        dev.payload_len = size;
+        dev.reserved_len = 0;
+
+        return 0;
+    }
+
+private:
+    template <typename Obj, size_t Offset>
+    static constexpr void put(uint8_t *out, typename Obj::raw_type raw)
+    {
+        auto value = static_cast<std::make_unsigned_t<typename Obj::raw_type>>(raw);
+
+        out[Offset] = Obj::id;
+        for (size_t i = 0; i < Obj::size; i++) {
+            out[Offset + 1 + i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    template <size_t... I>
+    static constexpr void encode_into(uint8_t *out, std::index_sequence<I...>,
+                                      typename Objs::raw_type... raw)
+    {
+        (put<Objs, offset[I]>(out, raw), ...);
+    }
+};
+
+} /* namespace bthome */
+
+#endif /* ZEPHYR_INCLUDE_BTHOME_PACKET_HPP_ */
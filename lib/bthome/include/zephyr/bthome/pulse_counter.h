@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_BTHOME_PULSE_COUNTER_H_
+#define ZEPHYR_INCLUDE_BTHOME_PULSE_COUNTER_H_
+
+#include <zephyr/bthome/bthome.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Hardware pulse counter for BTHome meter nodes
+ *
+ * Counts external pulses (water, gas or S0 energy meters) without CPU
+ * involvement. On Nordic SoCs a GPIOTE IN event is routed through
+ * PPI/DPPI to the COUNT task of a TIMER running in low-power counter
+ * mode, so the CPU only wakes to read the count at advertising time.
+ *
+ * With CONFIG_BTHOME_PULSE_COUNTER_EMUL (e.g. on native_sim) pulses are
+ * injected by software through bthome_pulse_counter_emul_pulse().
+ */
+
+/**
+ * @addtogroup bthome
+ * @{
+ */
+
+/** Tick rate of pulse edge timestamps (32.768 kHz / 32, wraps after ~48 days) */
+#define BTHOME_PULSE_TICK_HZ        1024U
+
+/**
+ * @brief Consistent view of the pulse counter at one instant
+ */
+struct bthome_pulse_snapshot {
+    uint32_t count;                /**< Pulses counted since initialization */
+    uint32_t edge_ticks;           /**< Timestamp of the most recent pulse */
+    uint32_t now_ticks;            /**< Timestamp when the snapshot was taken */
+};
+
+/**
+ * @brief Initialize the pulse counter
+ *
+ * Configures the input pin, the counter and the event routing. The count
+ * starts at zero.
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int bthome_pulse_counter_init(void);
+
+/**
+ * @brief Read the number of pulses counted since initialization
+ *
+ * @param count Pulse count (wraps at 2^32)
+ * @return 0 on success, negative error code on failure
+ */
+int bthome_pulse_counter_read(uint32_t *count);
+
+/**
+ * @brief Add the current pulse count to the packet as BTHOME_ID_COUNT4
+ *
+ * @param dev BTHome device instance
+ * @return 0 on success, negative error code on failure
+ */
+int bthome_pulse_counter_add(struct bthome_device *dev);
+
+/**
+ * @brief Read count and last pulse timestamp atomically
+ *
+ * Requires CONFIG_BTHOME_PULSE_RATE. On nRF the pulse edge clears an RTC
+ * in hardware, so the RTC counter is the time since the last pulse and no
+ * CPU work is done per pulse. Pauses longer than the 24-bit RTC range
+ * (4.5 h) are reported as that range.
+ *
+ * @param snap Snapshot to fill
+ * @return 0 on success, -ENOTSUP without timestamp capture
+ */
+int bthome_pulse_counter_snapshot(struct bthome_pulse_snapshot *snap);
+
+#if defined(CONFIG_BTHOME_PULSE_COUNTER_EMUL)
+/**
+ * @brief Inject pulses into the emulated counter
+ *
+ * @param pulses Number of pulses to add
+ */
+void bthome_pulse_counter_emul_pulse(uint32_t pulses);
+#endif
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_BTHOME_PULSE_COUNTER_H_ */
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_BTHOME_PULSE_RATE_H_
+#define ZEPHYR_INCLUDE_BTHOME_PULSE_RATE_H_
+
+#include <zephyr/bthome/pulse_counter.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Instantaneous power and flow from pulse intervals
+ *
+ * Every call to bthome_pulse_rate_update() stores one hardware snapshot
+ * (pulse count plus timestamp of the last pulse edge) in a small ring
+ * buffer. The rate is computed edge-to-edge over the buffered window in
+ * integer fixed point, so there is neither per-pulse CPU work nor any
+ * floating point.
+ */
+
+/**
+ * @addtogroup bthome
+ * @{
+ */
+
+/**
+ * @brief Meter constant
+ */
+struct bthome_pulse_rate_config {
+    /** Pulses per kWh (energy meters) or per m³ (water/gas meters) */
+    uint32_t pulses_per_unit;
+};
+
+/**
+ * @brief Initialize the rate calculation
+ *
+ * The pulse counter must already be initialized.
+ *
+ * @param config Meter constant
+ * @return 0 on success, negative error code on failure
+ */
+int bthome_pulse_rate_init(const struct bthome_pulse_rate_config *config);
+
+/**
+ * @brief Take a snapshot of the pulse counter
+ *
+ * Call once per advertising cycle, before adding rate objects.
+ *
+ * @return 0 on success, negative error code on failure
+ */
+int bthome_pulse_rate_update(void);
+
+/**
+ * @brief Get the current pulse rate
+ *
+ * The rate decays towards zero when no pulse has arrived for longer than
+ * the last measured interval.
+ *
+ * @param milli_hz Pulse rate in 0.001 pulses per second
+ * @return 0 on success, -ENODATA if fewer than two pulses were seen
+ */
+int bthome_pulse_rate_get(uint32_t *milli_hz);
+
+/**
+ * @brief Add power (BTHOME_ID_POWER) and energy (BTHOME_ID_ENERGY4)
+ *
+ * Uses pulses_per_unit as impulses per kWh.
+ *
+ * @param dev BTHome device instance
+ * @return 0 on success, negative error code on failure
+ */
+int bthome_pulse_rate_add_power(struct bthome_device *dev);
+
+/**
+ * @brief Add flow (BTHOME_ID_VOLUME_FLOW_RATE) and volume (BTHOME_ID_VOLUME)
+ *
+ * Uses pulses_per_unit as impulses per m³.
+ *
+ * @param dev BTHome device instance
+ * @return 0 on success, negative error code on failure
+ */
+int bthome_pulse_rate_add_flow(struct bthome_device *dev);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_BTHOME_PULSE_RATE_H_ */
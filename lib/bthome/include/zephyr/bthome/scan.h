@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_BTHOME_SCAN_H_
+#define ZEPHYR_INCLUDE_BTHOME_SCAN_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Gateway side: predictive scan scheduling
+ *
+ * BTHome sensors advertise at a fixed interval, so a gateway that
+ * cannot scan all the time (battery or solar repeaters) only needs to
+ * listen around the expected arrivals. The predictor learns period and
+ * phase of every sensor from the reception times and packet IDs of
+ * decoded packets, and plans short scan windows around the next
+ * arrivals. Each missed arrival widens the window of that sensor; after
+ * max_misses in a row the sensor is left to the discovery windows,
+ * which scan continuously to find new sensors and re-acquire lost ones.
+ *
+ * The predictor does not touch the radio. The gateway asks for the next
+ * window with bthome_scan_next(), runs bt_le_scan_start() and
+ * bt_le_scan_stop() at its edges and reports every decoded packet with
+ * bthome_scan_observe(). Calls must be serialized by the caller. The
+ * scan driver in <zephyr/bthome/scanner.h> (CONFIG_BTHOME_SCANNER) does
+ * all of this on a work item.
+ */
+
+/**
+ * @addtogroup bthome
+ * @{
+ */
+
+/**
+ * @brief Per-sensor state, all fields are private
+ */
+struct bthome_scan_sensor {
+    uint8_t mac[6];
+    uint8_t state;
+    uint8_t last_id;
+    uint8_t misses;
+    int64_t last_ms;                /* Reception time of the last packet */
+    uint32_t period_us;             /* Learned advertising period */
+    uint32_t dev_us;                /* Mean deviation from the prediction */
+};
+
+/**
+ * @brief Predictor configuration
+ */
+struct bthome_scan_config {
+    uint16_t guard_ms;              /**< Margin on each side of every prediction */
+    uint16_t merge_ms;              /**< Windows closer than this are merged */
+    uint8_t max_misses;             /**< Misses in a row before a sensor is dropped */
+    uint32_t discovery_ms;          /**< Discovery window, above the longest interval */
+    uint32_t discovery_interval_ms; /**< Discovery period, 0 for only the first */
+};
+
+/**
+ * @brief Predictor counters
+ */
+struct bthome_scan_stats {
+    uint32_t observed;              /**< Packets reported */
+    uint32_t learned;               /**< Sensors whose period was learned */
+    uint32_t predicted;             /**< Packets of sensors being tracked */
+    uint32_t misses;                /**< Expected packets that did not arrive */
+    uint32_t lost;                  /**< Sensors dropped after max_misses */
+    uint32_t relearned;             /**< Period changes, e.g. a new interval */
+};
+
+/**
+ * @brief Predictor
+ */
+struct bthome_scan {
+    struct bthome_scan_config cfg;
+    struct bthome_scan_sensor *sensors;
+    size_t max_sensors;
+    size_t num_sensors;
+    size_t learning;                /* Sensors seen once, period unknown */
+    int64_t discovery_ms;           /* Start of the next discovery window */
+    struct bthome_scan_stats stats;
+};
+
+/**
+ * @brief Scan window
+ */
+struct bthome_scan_window {
+    int64_t start_ms;               /**< Uptime to start scanning */
+    int64_t end_ms;                 /**< Uptime to stop scanning */
+    bool discovery;                 /**< Window contains a discovery window */
+};
+
+/**
+ * @brief Initialize a predictor
+ *
+ * The first discovery window starts at uptime 0.
+ *
+ * @param scan Predictor
+ * @param cfg Configuration, copied
+ * @param sensors Storage for the sensor table
+ * @param max_sensors Number of entries in sensors
+ * @return 0 on success, -EINVAL if discovery_ms is 0 or discovery_interval_ms
+ *         is shorter than discovery_ms
+ */
+int bthome_scan_init(struct bthome_scan *scan, const struct bthome_scan_config *cfg,
+                     struct bthome_scan_sensor *sensors, size_t max_sensors);
+
+/**
+ * @brief Report a decoded packet
+ *
+ * Repeated receptions of the same packet are ignored. The packet ID
+ * tells how many packets were missed since the last one; without it the
+ * count is derived from the learned period.
+ *
+ * @param scan Predictor
+ * @param mac Sender address in bt_addr_t (little endian) order
+ * @param packet_id Value of BTHOME_ID_PACKET, negative if not present
+ * @param rx_ms Uptime at reception
+ * @return 0 on success, -ENOMEM if the sensor table is full
+ */
+int bthome_scan_observe(struct bthome_scan *scan, const uint8_t mac[6], int packet_id,
+                        int64_t rx_ms);
+
+/**
+ * @brief Get the next scan window
+ *
+ * Returns the earliest window that has not ended at now_ms, merged with
+ * every window that overlaps it or follows within merge_ms. Arrivals
+ * that passed without a packet are counted as misses. The window may
+ * grow when packets are reported later, so call again after it ends.
+ *
+ * @param scan Predictor
+ * @param now_ms Current uptime
+ * @param win Output window, start_ms is at least now_ms
+ * @return 0 on success, -ENOENT if no sensor is tracked and no discovery
+ *         window is due
+ */
+int bthome_scan_next(struct bthome_scan *scan, int64_t now_ms, struct bthome_scan_window *win);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_BTHOME_SCAN_H_ */
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_BTHOME_SCANNER_H_
+#define ZEPHYR_INCLUDE_BTHOME_SCANNER_H_
+
+#include <zephyr/bluetooth/addr.h>
+#include <zephyr/bthome/decode.h>
+#include <zephyr/bthome/scan.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Gateway side: scan driver for the predictor
+ *
+ * Runs bt_le_scan_start() and bt_le_scan_stop() at the edges of the
+ * windows planned by bthome_scan_next(). A delayable work item on the
+ * library work queue wakes at every edge, so the radio is off between
+ * windows. Advertisements with BTHome service data are decoded and
+ * reported to the predictor, then passed to the application. The
+ * driver owns the Bluetooth scanner while it runs.
+ */
+
+/**
+ * @addtogroup bthome
+ * @{
+ */
+
+/**
+ * @brief Bind key lookup
+ *
+ * @param addr Sender address
+ * @return Bind key of the sender, NULL if unknown
+ */
+typedef const uint8_t *(*bthome_scanner_key_t)(const bt_addr_le_t *addr);
+
+/**
+ * @brief Packet callback
+ *
+ * Called from the Bluetooth RX thread for every decoded packet, repeats
+ * on other advertising channels included; bthome_dedup_check() drops
+ * them. pkt is only valid during the call.
+ *
+ * @param addr Sender address
+ * @param rssi Received signal strength in dBm
+ * @param pkt Decoded packet
+ */
+typedef void (*bthome_scanner_cb_t)(const bt_addr_le_t *addr, int8_t rssi,
+                                    const struct bthome_packet *pkt);
+
+/**
+ * @brief Scan driver configuration
+ */
+struct bthome_scanner_config {
+    struct bthome_scan_config predict;  /**< Predictor configuration */
+    bthome_scanner_key_t key;           /**< Bind key lookup, NULL without encryption */
+    bthome_scanner_cb_t cb;             /**< Packet callback, may be NULL */
+    /**
+     * Advertising channels of the sensors (BTHOME_ADV_CHAN_*), 0 = all
+     * three. HCI has no scan channel map, so a subset is served by
+     * listening on channel 37 only: the scan interval and window are set
+     * to 10.24 s and the scan is restarted for every window and every
+     * 10.24 s. The subset must include channel 37. This relies on the
+     * controller starting each scan on channel 37, which the Core
+     * specification does not require; check with a sniffer.
+     */
+    uint8_t channels;
+};
+
+/**
+ * @brief Scan driver counters
+ */
+struct bthome_scanner_stats {
+    struct bthome_scan_stats predict;   /**< Predictor counters */
+    uint32_t windows;                   /**< Scans started */
+    uint64_t scan_ms;                   /**< Time scanned, up to the last stop */
+    uint32_t received;                  /**< Packets decoded, repeats included */
+    uint32_t errors;                    /**< BTHome service data that failed to decode */
+};
+
+/**
+ * @brief Start scanning in predicted windows
+ *
+ * The predictor is reset and the first discovery window starts now.
+ * If the predictor runs out of windows (no sensor tracked and no
+ * discovery window configured) the driver turns the radio off and stops
+ * by itself; it can then be started again.
+ *
+ * @param cfg Configuration, copied
+ * @return 0 on success, -EALREADY if running, -EINVAL for a NULL or
+ *         invalid predictor configuration or channel bits, -ENOTSUP for
+ *         a channel subset without channel 37
+ */
+int bthome_scanner_start(const struct bthome_scanner_config *cfg);
+
+/**
+ * @brief Stop scanning
+ *
+ * Waits for a running window edge to finish, so it must not be called
+ * from the library work queue or the packet callback.
+ *
+ * @return 0 on success, -EALREADY if not running or stopped by itself
+ */
+int bthome_scanner_stop(void);
+
+/**
+ * @brief Get the scan driver counters
+ *
+ * @param stats Output, reset by bthome_scanner_start()
+ */
+void bthome_scanner_get_stats(struct bthome_scanner_stats *stats);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_BTHOME_SCANNER_H_ */
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_BTHOME_SCHED_H_
+#define ZEPHYR_INCLUDE_BTHOME_SCHED_H_
+
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Wake-up coalescing scheduler for periodic BTHome activities
+ *
+ * Sampling, advertising, heartbeat/statistics and battery reads are
+ * registered as periodic tasks with a slack. All tasks run from a single
+ * delayable work item, which wakes at the latest instant that keeps
+ * every task within its slack and then runs every task whose window has
+ * opened. Each merged wake-up saves the clock and CPU start-up energy of
+ * a separate timer.
+ */
+
+/**
+ * @addtogroup bthome
+ * @{
+ */
+
+struct bthome_sched_task;
+
+/**
+ * @brief Periodic task handler
+ *
+ * @param task Task being run
+ */
+typedef void (*bthome_sched_handler_t)(struct bthome_sched_task *task);
+
+/**
+ * @brief Periodic task
+ */
+struct bthome_sched_task {
+    bthome_sched_handler_t handler; /**< Called once per period */
+    uint32_t period_ms;            /**< Nominal period */
+    uint32_t slack_ms;             /**< Allowed deviation from the due time */
+    int64_t next_due;              /**< Private: next due uptime (ms) */
+    uint32_t phase_ms;             /**< Private: slot offset in the cycle */
+    bool slotted;                  /**< Private: registered in a slot */
+};
+
+/**
+ * @brief Initialize a periodic task
+ *
+ * @param handler Task handler
+ * @param period Period in ms
+ * @param slack Slack in ms, the task may run this much early or late
+ */
+#define BTHOME_SCHED_TASK_INIT(_handler, _period, _slack) \
+    {                                                      \
+        .handler = (_handler),                             \
+        .period_ms = (_period),                            \
+        .slack_ms = (_slack),                              \
+    }
+
+/**
+ * @brief Register a periodic task
+ *
+ * @param task Task to register, must stay valid while registered
+ * @param delay_ms Delay before the first run
+ * @return 0 on success, -ENOMEM if CONFIG_BTHOME_SCHED_MAX_TASKS is
+ *         reached, negative error code on failure
+ */
+int bthome_sched_add(struct bthome_sched_task *task, uint32_t delay_ms);
+
+/**
+ * @brief Register a periodic task in a per-node time slot
+ *
+ * Opt-in mode for dense deployments. The period is divided into slots of
+ * slot_ms and the node picks one from a hash of its identity address, so
+ * nodes with the same period spread over the cycle instead of colliding.
+ * Must be called after bt_enable() has completed.
+ *
+ * Slots are counted from the epoch, which defaults to uptime 0. Without
+ * a shared time source every node counts from its own boot: nodes that
+ * power up together (a batch deployment, mains restored) still spread
+ * over the cycle, but against nodes booted at random times a slot is no
+ * better than a random phase. Nodes that learn the time should pass it
+ * to bthome_sched_set_time().
+ *
+ * @param task Task to register, must stay valid while registered
+ * @param slot_ms Slot length, at least the advertising duration
+ * @return 0 on success, negative error code on failure
+ */
+int bthome_sched_add_slotted(struct bthome_sched_task *task, uint32_t slot_ms);
+
+/**
+ * @brief Get the slot a node picks
+ *
+ * The hash used by bthome_sched_add_slotted(), e.g. for simulations or
+ * for a gateway planning scan windows.
+ *
+ * @param addr Identity address in bt_addr_t (little endian) order
+ * @param slots Number of slots in the cycle, not 0
+ * @return Slot index below slots
+ */
+uint32_t bthome_sched_slot(const uint8_t addr[6], uint32_t slots);
+
+/**
+ * @brief Set the time reference for slotted tasks
+ *
+ * Registered slotted tasks move to their slot relative to the new epoch.
+ *
+ * @param epoch_ms Uptime (ms) that corresponds to the start of a cycle
+ */
+void bthome_sched_set_epoch(int64_t epoch_ms);
+
+/**
+ * @brief Align slotted tasks to wall-clock time
+ *
+ * Cycles start whenever the Unix time is a multiple of the period, so all
+ * nodes with the same period and a common time source share the slot
+ * grid. Call it whenever the time is learned, e.g. from a gateway over
+ * the Current Time Service, GNSS or an RTC set at provisioning, and
+ * again every few hours: a 20 ppm sleep clock drifts 1.7 s per day.
+ *
+ * @param unix_ms Current Unix time in ms
+ */
+void bthome_sched_set_time(uint64_t unix_ms);
+
+/**
+ * @brief Unregister a periodic task
+ *
+ * @param task Task to remove
+ * @return 0 on success, -ENOENT if the task was not registered
+ */
+int bthome_sched_remove(struct bthome_sched_task *task);
+
+/**
+ * @brief Get the number of scheduler wake-ups so far
+ *
+ * @return Number of times the scheduler work item ran
+ */
+uint32_t bthome_sched_wakeups(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_BTHOME_SCHED_H_ */
@@ -9,15 +9,34 @@
 #include <zephyr/sys/byteorder.h>
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/gap.h>
+#include <zephyr/init.h>
 #include <string.h>
 
-LOG_MODULE_REGISTER(bthome, LOG_LEVEL_INF);
+#include "bthome_workq.h"
+
+#if defined(CONFIG_BTHOME_ENCRYPTION)
+#include "bthome_crypto.h"
+#endif
+
+LOG_MODULE_REGISTER(bthome, CONFIG_BTHOME_LOG_LEVEL);
 
 /* Forward declarations */
 static void bthome_adv_work_handler(struct k_work *work);
 
-/* Global persistent service data buffer */
-static uint8_t g_service_data[BTHOME_MAX_PAYLOAD_SIZE + 8];
+#if defined(CONFIG_BTHOME_STATS)
+static struct bthome_stats g_stats;
+
+#define BTHOME_STATS_INC(field, hci_cmds)                                      \
+    do {                                                                       \
+        g_stats.field++;                                                       \
+        g_stats.hci_commands_est += (hci_cmds);                                \
+    } while (0)
+#else
+#define BTHOME_STATS_INC(field, hci_cmds)
+#endif
+
+/* AD flags, referenced by ad_data for as long as advertising runs */
+static const uint8_t g_flags = BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR;
 
 /* BTHome v2 Service Data Structure */
 struct bthome_service_header {
@@ -28,140 +47,24 @@ struct bthome_service_header {
 /* Helper function to get data size for object ID */
 static uint8_t bthome_get_data_size(uint8_t object_id)
 {
-    switch (object_id) {
-    /* 8-bit values */
-    case BTHOME_ID_PACKET:
-    case BTHOME_ID_BATTERY:
-    case BTHOME_ID_COUNT:
-    case BTHOME_ID_HUMIDITY:
-    case BTHOME_ID_MOISTURE:
-    case BTHOME_ID_UV:
-    case BTHOME_STATE_GENERIC_BOOLEAN:
-    case BTHOME_STATE_POWER_ON:
-    case BTHOME_STATE_OPENING:
-    case BTHOME_STATE_BATTERY_LOW:
-    case BTHOME_STATE_BATTERY_CHARGING:
-    case BTHOME_STATE_CO:
-    case BTHOME_STATE_COLD:
-    case BTHOME_STATE_CONNECTIVITY:
-    case BTHOME_STATE_DOOR:
-    case BTHOME_STATE_GARAGE_DOOR:
-    case BTHOME_STATE_GAS_DETECTED:
-    case BTHOME_STATE_HEAT:
-    case BTHOME_STATE_LIGHT:
-    case BTHOME_STATE_LOCK:
-    case BTHOME_STATE_MOISTURE:
-    case BTHOME_STATE_MOTION:
-    case BTHOME_STATE_MOVING:
-    case BTHOME_STATE_OCCUPANCY:
-    case BTHOME_STATE_PLUG:
-    case BTHOME_STATE_PRESENCE:
-    case BTHOME_STATE_PROBLEM:
-    case BTHOME_STATE_RUNNING:
-    case BTHOME_STATE_SAFETY:
-    case BTHOME_STATE_SMOKE:
-    case BTHOME_STATE_SOUND:
-    case BTHOME_STATE_TAMPER:
-    case BTHOME_STATE_VIBRATION:
-    case BTHOME_STATE_WINDOW:
-    case BTHOME_EVENT_BUTTON:
-        return 1;
-
-    /* 16-bit values */
-    case BTHOME_ID_TEMPERATURE_PRECISE:
-    case BTHOME_ID_HUMIDITY_PRECISE:
-    case BTHOME_ID_DEWPOINT:
-    case BTHOME_ID_VOLTAGE:
-    case BTHOME_ID_PM25:
-    case BTHOME_ID_PM10:
-    case BTHOME_ID_CO2:
-    case BTHOME_ID_TVOC:
-    case BTHOME_ID_MOISTURE_PRECISE:
-    case BTHOME_ID_MASS:
-    case BTHOME_ID_MASS_LB:
-    case BTHOME_ID_COUNT2:
-    case BTHOME_ID_ROTATION:
-    case BTHOME_ID_DISTANCE:
-    case BTHOME_ID_DISTANCE_M:
-    case BTHOME_ID_CURRENT:
-    case BTHOME_ID_SPEED:
-    case BTHOME_ID_TEMPERATURE:
-    case BTHOME_ID_VOLUME1:
-    case BTHOME_ID_VOLUME2:
-    case BTHOME_ID_VOLUME_FLOW_RATE:
-    case BTHOME_ID_VOLTAGE1:
-        return 2;
-
-    /* 24-bit values */
-    case BTHOME_ID_PRESSURE:
-    case BTHOME_ID_ILLUMINANCE:
-    case BTHOME_ID_ENERGY:
-    case BTHOME_ID_POWER:
-    case BTHOME_ID_DURATION:
-    case BTHOME_ID_GAS:
-        return 3;
-
-    /* 32-bit values */
-    case BTHOME_ID_COUNT4:
-    case BTHOME_ID_ENERGY4:
-    case BTHOME_ID_GAS4:
-    case BTHOME_ID_VOLUME:
-    case BTHOME_ID_WATER:
-    case BTHOME_ID_TIMESTAMP:
-        return 4;
+    uint8_t size = bthome_object_size(object_id);
 
-    default:
+    if (size == 0) {
         LOG_WRN("Unknown object ID: 0x%02X, assuming 2 bytes", object_id);
         return 2;
     }
-}
 
-/* Helper function to get scaling factor for object ID */
-static uint16_t bthome_get_scale_factor(uint8_t object_id)
-{
-    switch (object_id) {
-    /* 0.1 scaling */
-    case BTHOME_ID_DISTANCE_M:
-    case BTHOME_ID_ROTATION:
-    case BTHOME_ID_TEMPERATURE:
-    case BTHOME_ID_VOLTAGE1:
-    case BTHOME_ID_VOLUME1:
-    case BTHOME_ID_UV:
-        return 10;
-
-    /* 0.01 scaling */
-    case BTHOME_ID_TEMPERATURE_PRECISE:
-    case BTHOME_ID_HUMIDITY_PRECISE:
-    case BTHOME_ID_DEWPOINT:
-    case BTHOME_ID_ILLUMINANCE:
-    case BTHOME_ID_MASS:
-    case BTHOME_ID_MASS_LB:
-    case BTHOME_ID_MOISTURE_PRECISE:
-    case BTHOME_ID_POWER:
-    case BTHOME_ID_PRESSURE:
-    case BTHOME_ID_SPEED:
-        return 100;
-
-    /* 0.001 scaling */
-    case BTHOME_ID_CURRENT:
-    case BTHOME_ID_DURATION:
-    case BTHOME_ID_ENERGY:
-    case BTHOME_ID_ENERGY4:
-    case BTHOME_ID_GAS:
-    case BTHOME_ID_GAS4:
-    case BTHOME_ID_VOLTAGE:
-    case BTHOME_ID_VOLUME:
-    case BTHOME_ID_WATER:
-        return 1000;
-
-    default:
-        return 1;  /* No scaling */
-    }
+    return size;
 }
 
 /* Platform-specific MAC address generation */
-#if defined(CONFIG_SOC_NRF52840) || defined(CONFIG_SOC_NRF52833) || defined(CONFIG_SOC_NRF52832)
+#if defined(CONFIG_SOC_NRF52840) || defined(CONFIG_SOC_NRF52833) || \
+    defined(CONFIG_SOC_NRF52832) || defined(CONFIG_SOC_COMPATIBLE_NRF5340_CPUAPP)
+#if defined(CONFIG_TRUSTED_EXECUTION_NONSECURE) && defined(NRF_FICR_S)
+#include <soc_secure.h>
+#else
 #include <hal/nrf_ficr.h>
+#endif
 
 int bthome_set_fixed_mac(void)
 {
@@ -169,11 +72,28 @@ int bthome_set_fixed_mac(void)
     uint32_t deviceaddr_low, deviceaddr_high;
     int err;
 
+#if defined(CONFIG_SOC_COMPATIBLE_NRF5340_CPUAPP)
+    /* DEVICEADDR is only in the network core FICR, use the device ID */
+#if defined(CONFIG_TRUSTED_EXECUTION_NONSECURE) && defined(NRF_FICR_S)
+    uint32_t deviceid[2];
+
+    /* FICR is secure-only, read it through the secure firmware */
+    soc_secure_read_deviceid(deviceid);
+    deviceaddr_low = deviceid[0];
+    deviceaddr_high = deviceid[1];
+#else
+    deviceaddr_low = nrf_ficr_deviceid_get(NRF_FICR, 0);
+    deviceaddr_high = nrf_ficr_deviceid_get(NRF_FICR, 1);
+#endif
+
+    LOG_INF("FICR.INFO.DEVICEID: 0x%08X%08X", deviceaddr_high, deviceaddr_low);
+#else
     /* Read Nordic FICR.DEVICEADDR registers */
     deviceaddr_low = nrf_ficr_deviceaddr_get(NRF_FICR, 0);
     deviceaddr_high = nrf_ficr_deviceaddr_get(NRF_FICR, 1);
 
     LOG_INF("FICR.DEVICEADDR: 0x%08X%08X", deviceaddr_high, deviceaddr_low);
+#endif
 
     /* Generate deterministic MAC address */
     addr.type = BT_ADDR_LE_RANDOM;
@@ -245,6 +165,22 @@ int bthome_set_fixed_mac(void)
 }
 #endif
 
+#if defined(CONFIG_BTHOME_AUTO_MAC)
+/* Create the fixed identity before the application calls bt_enable() */
+static int bthome_auto_mac_init(void)
+{
+    int err = bthome_set_fixed_mac();
+
+    if (err) {
+        LOG_WRN("Failed to set fixed MAC: %d", err);
+    }
+
+    return 0;
+}
+
+SYS_INIT(bthome_auto_mac_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+#endif
+
 int bthome_init(struct bthome_device *dev, const struct bthome_config *config)
 {
     if (!dev || !config) {
@@ -254,6 +190,23 @@ int bthome_init(struct bthome_device *dev, const struct bthome_config *config)
     memset(dev, 0, sizeof(*dev));
     memcpy(&dev->config, config, sizeof(*config));
 
+    if (config->encryption) {
+#if defined(CONFIG_BTHOME_ENCRYPTION)
+        int err = bthome_crypto_init(dev);
+
+        if (err) {
+            return err;
+        }
+#else
+        LOG_ERR("Encryption requested but CONFIG_BTHOME_ENCRYPTION is disabled");
+        return -ENOTSUP;
+#endif
+    }
+
+    if (config->adv_channels & ~BTHOME_ADV_CHAN_ALL) {
+        return -EINVAL;
+    }
+
     /* Initialize work queue for advertisement timeout */
     k_work_init_delayable(&dev->adv_work, bthome_adv_work_handler);
 
@@ -272,51 +225,97 @@ void bthome_reset_measurements(struct bthome_device *dev)
     }
 
     dev->payload_len = 0;
+    dev->reserved_len = 0;
     LOG_DBG("Measurements reset");
 }
 
-static int bthome_add_data(struct bthome_device *dev, uint8_t object_id,
-                          const void *data, uint8_t size)
+/* Bounds-check once and hand out the value bytes inside the payload */
+static int bthome_reserve(struct bthome_device *dev, uint8_t object_id,
+                          uint8_t len, uint8_t **ptr)
 {
-    uint8_t required_space = 1 + size;  /* Object ID + data */
-    uint8_t max_payload = dev->config.encryption ? 
-                         BTHOME_MAX_PAYLOAD_ENC : BTHOME_MAX_PAYLOAD_SIZE;
+    uint8_t header = bthome_object_is_variable(object_id) ? 2 : 1;
+    uint8_t max_payload = dev->config.encryption ?
+                          BTHOME_MAX_PAYLOAD_ENC : BTHOME_MAX_PAYLOAD_SIZE;
 
-    if (!dev || !data) {
-        return -EINVAL;
+    if (dev->reserved_len) {
+        return -EBUSY;
     }
 
-    if (dev->payload_len + required_space > max_payload) {
+    if (dev->payload_len + header + len > max_payload) {
         LOG_WRN("Payload full, cannot add object 0x%02X", object_id);
         return -ENOSPC;
     }
 
-    /* Add object ID */
-    dev->payload[dev->payload_len++] = object_id;
+    dev->payload[dev->payload_len] = object_id;
+    if (header == 2) {
+        dev->payload[dev->payload_len + 1] = len;
+    }
+
+    *ptr = &dev->payload[dev->payload_len + header];
+    dev->reserved_len = header + len;
+
+    return 0;
+}
+
+int bthome_payload_reserve(struct bthome_device *dev, uint8_t object_id,
+                           uint8_t len, uint8_t **ptr)
+{
+    if (!dev || !ptr) {
+        return -EINVAL;
+    }
+
+    if (!bthome_object_is_variable(object_id) &&
+        len != bthome_get_data_size(object_id)) {
+        return -EINVAL;
+    }
 
-    /* Add data */
-    memcpy(&dev->payload[dev->payload_len], data, size);
-    dev->payload_len += size;
+    return bthome_reserve(dev, object_id, len, ptr);
+}
 
-    LOG_DBG("Added object 0x%02X, size %u, total payload: %u",
-            object_id, size, dev->payload_len);
+int bthome_payload_commit(struct bthome_device *dev)
+{
+    if (!dev || dev->reserved_len == 0) {
+        return -EINVAL;
+    }
+
+    if (IS_ENABLED(CONFIG_BTHOME_SORT_OBJECTS)) {
+        bthome_payload_sort_last(dev->payload, dev->payload_len, dev->reserved_len);
+    }
+
+    dev->payload_len += dev->reserved_len;
+    dev->reserved_len = 0;
+
+    LOG_DBG("Object committed, total payload: %u", dev->payload_len);
 
     return 0;
 }
 
-int bthome_add_measurement(struct bthome_device *dev,
-                          const struct bthome_measurement *measurement)
+static int bthome_add_data(struct bthome_device *dev, uint8_t object_id,
+                          const void *data, uint8_t size)
 {
-    uint8_t data_size;
-    uint8_t data_buf[8];
+    uint8_t *ptr;
+    int err;
 
-    if (!dev || !measurement) {
+    if (!dev || !data) {
         return -EINVAL;
     }
 
-    data_size = bthome_get_data_size(measurement->object_id);
+    err = bthome_reserve(dev, object_id, size, &ptr);
+    if (err) {
+        return err;
+    }
+
+    memcpy(ptr, data, size);
+
+    return bthome_payload_commit(dev);
+}
+
+/* Convert a measurement value to a little-endian byte array */
+static int bthome_encode_measurement(const struct bthome_measurement *measurement,
+                                     uint8_t data_buf[8])
+{
+    uint8_t data_size = bthome_get_data_size(measurement->object_id);
 
-    /* Convert value to little-endian byte array */
     switch (data_size) {
     case 1:
         data_buf[0] = measurement->value.u8;
@@ -332,7 +331,7 @@ int bthome_add_measurement(struct bthome_device *dev,
         break;
     default:
         /* Raw data */
-        if (measurement->data_size > sizeof(data_buf)) {
+        if (measurement->data_size > 8) {
             return -EINVAL;
         }
         memcpy(data_buf, measurement->value.data, measurement->data_size);
@@ -340,6 +339,39 @@ int bthome_add_measurement(struct bthome_device *dev,
         break;
     }
 
+    return data_size;
+}
+
+int bthome_add_measurement(struct bthome_device *dev,
+                          const struct bthome_measurement *measurement)
+{
+    uint8_t data_buf[8];
+    int data_size;
+
+    if (!dev || !measurement) {
+        return -EINVAL;
+    }
+
+    /* Text and raw objects: copy straight into the payload */
+    if (bthome_object_is_variable(measurement->object_id)) {
+        uint8_t *ptr;
+        int err;
+
+        err = bthome_reserve(dev, measurement->object_id,
+                             measurement->data_size, &ptr);
+        if (err) {
+            return err;
+        }
+
+        memcpy(ptr, measurement->value.data, measurement->data_size);
+        return bthome_payload_commit(dev);
+    }
+
+    data_size = bthome_encode_measurement(measurement, data_buf);
+    if (data_size < 0) {
+        return data_size;
+    }
+
     return bthome_add_data(dev, measurement->object_id, data_buf, data_size);
 }
 
@@ -364,7 +396,7 @@ int bthome_add_sensor(struct bthome_device *dev, uint8_t object_id, float value)
     }
 
     measurement.object_id = object_id;
-    scale_factor = bthome_get_scale_factor(object_id);
+    scale_factor = bthome_object_scale(object_id);
     data_size = bthome_get_data_size(object_id);
 
     /* Scale and convert value */
@@ -396,59 +428,263 @@ int bthome_add_sensor(struct bthome_device *dev, uint8_t object_id, float value)
 int bthome_add_event(struct bthome_device *dev, uint8_t object_id,
                      uint8_t event, uint8_t steps)
 {
-    int err;
     struct bthome_measurement measurement = {
         .object_id = object_id,
         .value.u8 = event,
     };
+    uint8_t dimmer[2];
 
     if (!dev) {
         return -EINVAL;
     }
 
-    /* Add event value */
-    err = bthome_add_measurement(dev, &measurement);
-    if (err) {
-        return err;
+    if (object_id != BTHOME_EVENT_DIMMER) {
+        return bthome_add_measurement(dev, &measurement);
     }
 
-    /* Add steps if dimmer event with steps */
-    if (object_id == BTHOME_EVENT_DIMMER && event != BTHOME_EVENT_DIMMER_NONE && steps > 0) {
-        measurement.value.u8 = steps;
-        err = bthome_add_data(dev, object_id, &steps, 1);
+    /* Dimmer object: [event type][steps] in a single object */
+    dimmer[0] = event;
+    dimmer[1] = (event == BTHOME_EVENT_DIMMER_NONE) ? 0 : steps;
+
+    return bthome_add_data(dev, object_id, dimmer, sizeof(dimmer));
+}
+
+#if defined(CONFIG_BTHOME_SLOW_OBJECTS)
+int bthome_set_slow_object(struct bthome_device *dev,
+                           const struct bthome_measurement *measurement,
+                           uint16_t every_n, uint32_t min_interval_ms)
+{
+    struct bthome_slow_object *obj = NULL;
+    uint8_t data_buf[8];
+    int data_size;
+
+    if (!dev || !measurement || measurement->object_id == 0 ||
+        bthome_object_is_variable(measurement->object_id)) {
+        return -EINVAL;
     }
 
-    return err;
+    data_size = bthome_encode_measurement(measurement, data_buf);
+    if (data_size < 0) {
+        return data_size;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(dev->slow); i++) {
+        if (dev->slow[i].object_id == measurement->object_id) {
+            obj = &dev->slow[i];
+            break;
+        }
+        if (!obj && dev->slow[i].object_id == 0) {
+            obj = &dev->slow[i];
+        }
+    }
+
+    if (!obj) {
+        LOG_WRN("No free slow object slot for 0x%02X", measurement->object_id);
+        return -ENOMEM;
+    }
+
+    if (obj->object_id != measurement->object_id) {
+        /* New object: due on the next packet */
+        memset(obj, 0, sizeof(*obj));
+        obj->object_id = measurement->object_id;
+        obj->last_sent_ms = -1;
+    } else if (obj->size != data_size || memcmp(obj->data, data_buf, data_size) != 0) {
+        obj->changed = true;
+    }
+
+    obj->size = data_size;
+    memcpy(obj->data, data_buf, data_size);
+    obj->every_n = every_n;
+    obj->min_interval_ms = min_interval_ms;
+
+    return 0;
 }
 
-static int bthome_build_advertisement(struct bthome_device *dev)
+int bthome_remove_slow_object(struct bthome_device *dev, uint8_t object_id)
+{
+    if (!dev) {
+        return -EINVAL;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(dev->slow); i++) {
+        if (object_id != 0 && dev->slow[i].object_id == object_id) {
+            memset(&dev->slow[i], 0, sizeof(dev->slow[i]));
+            return 0;
+        }
+    }
+
+    return -ENOENT;
+}
+
+static bool bthome_slow_object_due(const struct bthome_device *dev,
+                                   const struct bthome_slow_object *obj, int64_t now)
+{
+    if (obj->last_sent_ms < 0) {
+        return true;
+    }
+
+    if (obj->every_n && dev->packet_count - obj->last_packet >= obj->every_n) {
+        return true;
+    }
+
+    return obj->changed && now - obj->last_sent_ms >= obj->min_interval_ms;
+}
+
+/* Append due slow objects to buf, remembering which ones went in */
+static uint8_t bthome_append_slow_objects(struct bthome_device *dev, uint8_t *buf,
+                                          uint8_t len, uint8_t max_len)
+{
+    int64_t now = k_uptime_get();
+
+    dev->slow_pending = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(dev->slow); i++) {
+        const struct bthome_slow_object *obj = &dev->slow[i];
+
+        if (obj->object_id == 0 || !bthome_slow_object_due(dev, obj, now)) {
+            continue;
+        }
+
+        /* Does not fit: stays due for the next packet */
+        if (len + 1 + obj->size > max_len) {
+            continue;
+        }
+
+        buf[len] = obj->object_id;
+        memcpy(&buf[len + 1], obj->data, obj->size);
+        if (IS_ENABLED(CONFIG_BTHOME_SORT_OBJECTS)) {
+            bthome_payload_sort_last(buf, len, 1 + obj->size);
+        }
+        len += 1 + obj->size;
+        dev->slow_pending |= BIT(i);
+    }
+
+    return len;
+}
+
+/* Called once the packet carrying the pending slow objects is on air */
+static void bthome_slow_objects_sent(struct bthome_device *dev)
+{
+    int64_t now = k_uptime_get();
+
+    for (size_t i = 0; i < ARRAY_SIZE(dev->slow); i++) {
+        if (dev->slow_pending & BIT(i)) {
+            dev->slow[i].changed = false;
+            dev->slow[i].last_packet = dev->packet_count;
+            dev->slow[i].last_sent_ms = now;
+        }
+    }
+
+    dev->slow_pending = 0;
+    dev->packet_count++;
+}
+#endif
+
+static uint8_t bthome_device_info(const struct bthome_device *dev)
+{
+    if (dev->config.trigger_based) {
+        return dev->config.encryption ?
+               BTHOME_ENCRYPT_TRIGGER : BTHOME_NO_ENCRYPT_TRIGGER;
+    }
+
+    return dev->config.encryption ? BTHOME_ENCRYPT : BTHOME_NO_ENCRYPT;
+}
+
+/* Header and payload, encrypted if configured; mac as in bthome_encode() */
+static int bthome_encode_service_data(struct bthome_device *dev, const uint8_t *mac,
+                                      const uint8_t *payload, uint8_t payload_len,
+                                      uint8_t *out)
 {
     struct bthome_service_header header;
-    uint8_t flags = BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR;
+    uint8_t len;
+
+    header.service_uuid = sys_cpu_to_le16(BTHOME_SERVICE_UUID);
+    header.device_info = bthome_device_info(dev);
+
+    memcpy(out, &header, sizeof(header));
+    len = sizeof(header);
+
+#if defined(CONFIG_BTHOME_ENCRYPTION)
+    if (dev->config.encryption) {
+        /* Ciphertext + counter + MIC */
+        int enc_len = bthome_crypto_encrypt(dev, mac, header.device_info, payload,
+                                            payload_len, &out[len]);
+        if (enc_len < 0) {
+            return enc_len;
+        }
+        return len + enc_len;
+    }
+#else
+    ARG_UNUSED(mac);
+#endif
+
+    memcpy(&out[len], payload, payload_len);
+
+    return len + payload_len;
+}
+
+int bthome_encode(struct bthome_device *dev, const uint8_t mac[6],
+                  uint8_t *out, size_t size)
+{
+    size_t needed;
+
+    if (!dev || !out) {
+        return -EINVAL;
+    }
+
+    needed = sizeof(struct bthome_service_header) + dev->payload_len;
+#if defined(CONFIG_BTHOME_ENCRYPTION)
+    if (dev->config.encryption) {
+        needed += BTHOME_CRYPTO_OVERHEAD;
+    }
+#endif
+
+    if (size < needed) {
+        return -ENOMEM;
+    }
+
+    return bthome_encode_service_data(dev, mac, dev->payload, dev->payload_len, out);
+}
+
+/*
+ * Encode into the back half of the device's service data and point ad_data
+ * at it. The front half, last handed to the advertiser, stays untouched
+ * until bthome_adv_flip() after a successful start or update.
+ */
+static int bthome_build_advertisement(struct bthome_device *dev)
+{
     uint8_t service_data_len;
+    uint8_t *service_data;
+    const uint8_t *payload;
+    uint8_t payload_len;
+    int len;
 
     if (!dev) {
         return -EINVAL;
     }
 
-    /* Build BTHome service data header */
-    header.service_uuid = sys_cpu_to_le16(BTHOME_SERVICE_UUID);
-    
-    if (dev->config.trigger_based) {
-        header.device_info = dev->config.encryption ? 
-                           BTHOME_ENCRYPT_TRIGGER : BTHOME_NO_ENCRYPT_TRIGGER;
-    } else {
-        header.device_info = dev->config.encryption ? 
-                           BTHOME_ENCRYPT : BTHOME_NO_ENCRYPT;
-    }
+    service_data = dev->service_data[!dev->service_front];
+    payload = dev->payload;
+    payload_len = dev->payload_len;
+
+#if defined(CONFIG_BTHOME_SLOW_OBJECTS)
+    /* Measurements plus the slow objects due on this packet */
+    uint8_t packet[BTHOME_MAX_PAYLOAD_SIZE];
 
-    /* Copy complete header into global service data */
-    memcpy(g_service_data, &header, sizeof(header));
-    service_data_len = sizeof(header);
+    memcpy(packet, dev->payload, dev->payload_len);
+    payload_len = bthome_append_slow_objects(dev, packet, dev->payload_len,
+                                             dev->config.encryption ?
+                                             BTHOME_MAX_PAYLOAD_ENC :
+                                             BTHOME_MAX_PAYLOAD_SIZE);
+    payload = packet;
+#endif
 
-    /* Copy payload */
-    memcpy(&g_service_data[service_data_len], dev->payload, dev->payload_len);
-    service_data_len += dev->payload_len;
+    len = bthome_encode_service_data(dev, NULL, payload, payload_len, service_data);
+    if (len < 0) {
+        LOG_ERR("Failed to encrypt payload: %d", len);
+        return len;
+    }
+    service_data_len = len;
 
     /* Clear advertisement data array */
     memset(dev->ad_data, 0, sizeof(dev->ad_data));
@@ -457,25 +693,27 @@ static int bthome_build_advertisement(struct bthome_device *dev)
     /* Element 1: Flags */
     dev->ad_data[0].type = BT_DATA_FLAGS;
     dev->ad_data[0].data_len = 1;
-    dev->ad_data[0].data = &flags;
+    dev->ad_data[0].data = &g_flags;
 
     /* Element 2: Service Data */
     dev->ad_data[1].type = BT_DATA_SVC_DATA16;
     dev->ad_data[1].data_len = service_data_len;
-    dev->ad_data[1].data = g_service_data;  /* Use global service data */
+    dev->ad_data[1].data = service_data;
 
     /* Element 3: Complete Device Name */
     dev->ad_data[2].type = BT_DATA_NAME_COMPLETE;
     dev->ad_data[2].data = dev->config.device_name;
     dev->ad_data[2].data_len = strlen(dev->config.device_name);
 
+    BTHOME_STATS_INC(packets, 0);
+
     LOG_INF("Advertisement built: payload=%u bytes, total=%u elements",
-            dev->payload_len, 3);  // Now 3 elements again
-    LOG_HEXDUMP_INF(g_service_data, service_data_len, "Service data:");
+            payload_len, 3);  // Now 3 elements again
+    LOG_HEXDUMP_INF(service_data, service_data_len, "Service data:");
     
     /* Debug: Print advertisement structure */
     LOG_INF("AD Element 1 (Flags): type=0x%02X, len=%u, data=0x%02X", 
-            dev->ad_data[0].type, dev->ad_data[0].data_len, flags);
+            dev->ad_data[0].type, dev->ad_data[0].data_len, g_flags);
     LOG_INF("AD Element 2 (Service Data): type=0x%02X, len=%u", 
             dev->ad_data[1].type, dev->ad_data[1].data_len);
     // LOG_INF("AD Element 3 (Name): type=0x%02X, len=%u, name='%s'", 
@@ -484,6 +722,34 @@ static int bthome_build_advertisement(struct bthome_device *dev)
     return 0;
 }
 
+/* The advertiser took the back half: it becomes the front one */
+static void bthome_adv_flip(struct bthome_device *dev)
+{
+    dev->service_front = !dev->service_front;
+}
+
+static uint32_t bthome_channel_options(const struct bthome_device *dev)
+{
+    uint8_t channels = dev->config.adv_channels;
+    uint32_t options = 0;
+
+    if (channels == 0) {
+        return 0;
+    }
+
+    if (!(channels & BTHOME_ADV_CHAN_37)) {
+        options |= BT_LE_ADV_OPT_DISABLE_CHAN_37;
+    }
+    if (!(channels & BTHOME_ADV_CHAN_38)) {
+        options |= BT_LE_ADV_OPT_DISABLE_CHAN_38;
+    }
+    if (!(channels & BTHOME_ADV_CHAN_39)) {
+        options |= BT_LE_ADV_OPT_DISABLE_CHAN_39;
+    }
+
+    return options;
+}
+
 int bthome_advertise(struct bthome_device *dev, uint32_t duration_ms)
 {
     int err;
@@ -504,7 +770,7 @@ int bthome_advertise(struct bthome_device *dev, uint32_t duration_ms)
 
     /* Start advertising */
     struct bt_le_adv_param adv_param = BT_LE_ADV_PARAM_INIT(
-        BT_LE_ADV_OPT_USE_IDENTITY,
+        BT_LE_ADV_OPT_USE_IDENTITY | bthome_channel_options(dev),
         BT_GAP_ADV_SLOW_INT_MIN,
         BT_GAP_ADV_SLOW_INT_MAX,
         NULL);
@@ -515,12 +781,34 @@ int bthome_advertise(struct bthome_device *dev, uint32_t duration_ms)
         return err;
     }
 
+    bthome_adv_flip(dev);
     dev->advertising = true;
+    BTHOME_STATS_INC(adv_starts, BTHOME_HCI_CMDS_EST_ADV_START);
     LOG_INF("BTHome advertising started (payload: %u bytes)", dev->payload_len);
 
+#if defined(CONFIG_BTHOME_SLOW_OBJECTS)
+    bthome_slow_objects_sent(dev);
+#endif
+
+#if defined(CONFIG_BTHOME_BOOT_TIMING)
+    static bool first_adv_done;
+
+    if (!first_adv_done) {
+        first_adv_done = true;
+        LOG_INF("Boot to first advertisement: %u ms", k_uptime_get_32());
+    }
+#endif
+
+#if defined(CONFIG_BTHOME_ENCRYPTION_PRECOMPUTE)
+    /* Radio is busy anyway: prepare the keystream for the next packet */
+    if (dev->config.encryption) {
+        bthome_crypto_precompute(dev, NULL, bthome_device_info(dev));
+    }
+#endif
+
     /* Stop advertising after duration if specified */
     if (duration_ms > 0) {
-        k_work_schedule(&dev->adv_work, K_MSEC(duration_ms));
+        k_work_schedule_for_queue(BTHOME_WORKQ, &dev->adv_work, K_MSEC(duration_ms));
     }
 
     return 0;
@@ -532,6 +820,54 @@ static void bthome_adv_work_handler(struct k_work *work)
     struct bthome_device *dev = CONTAINER_OF(dwork, struct bthome_device, adv_work);
 
     bthome_stop_advertising(dev);
+
+#if defined(CONFIG_BTHOME_WORKQ) && defined(CONFIG_THREAD_STACK_INFO) && \
+    defined(CONFIG_BTHOME_LOG_LEVEL_DBG)
+    size_t unused;
+
+    /* Stack headroom of the library queue, to size BTHOME_WORKQ_STACK_SIZE */
+    if (k_thread_stack_space_get(k_current_get(), &unused) == 0) {
+        LOG_DBG("bthome_workq stack unused: %zu bytes", unused);
+    }
+#endif
+}
+
+int bthome_publish(struct bthome_device *dev)
+{
+    int err;
+
+    if (!dev) {
+        return -EINVAL;
+    }
+
+    if (!dev->advertising) {
+        return -EALREADY;
+    }
+
+    if (dev->payload_len == 0) {
+        return -ENODATA;
+    }
+
+    err = bthome_build_advertisement(dev);
+    if (err) {
+        return err;
+    }
+
+    err = bt_le_adv_update_data(dev->ad_data, 3, NULL, 0);
+    if (err) {
+        LOG_ERR("Failed to update advertising data: %d", err);
+        return err;
+    }
+
+    bthome_adv_flip(dev);
+
+    BTHOME_STATS_INC(data_updates, BTHOME_HCI_CMDS_EST_ADV_UPDATE);
+
+#if defined(CONFIG_BTHOME_SLOW_OBJECTS)
+    bthome_slow_objects_sent(dev);
+#endif
+
+    return 0;
 }
 
 int bthome_stop_advertising(struct bthome_device *dev)
@@ -553,6 +889,7 @@ int bthome_stop_advertising(struct bthome_device *dev)
     }
 
     dev->advertising = false;
+    BTHOME_STATS_INC(adv_stops, BTHOME_HCI_CMDS_EST_ADV_STOP);
     k_work_cancel_delayable(&dev->adv_work);
     
     LOG_INF("BTHome advertising stopped");
@@ -562,4 +899,20 @@ int bthome_stop_advertising(struct bthome_device *dev)
 bool bthome_is_advertising(const struct bthome_device *dev)
 {
     return dev ? dev->advertising : false;
-}
\ No newline at end of file
+}
+
+#if defined(CONFIG_BTHOME_STATS)
+void bthome_get_stats(struct bthome_stats *stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    *stats = g_stats;
+}
+
+void bthome_reset_stats(void)
+{
+    memset(&g_stats, 0, sizeof(g_stats));
+}
+#endif
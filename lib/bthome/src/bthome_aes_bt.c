@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "bthome_crypto.h"
+
+#include <zephyr/bluetooth/crypto.h>
+#include <string.h>
+
+/* bt_encrypt_be() takes the key with every block */
+static uint8_t aes_key[16];
+
+int bthome_aes_set_key(const uint8_t key[16])
+{
+    memcpy(aes_key, key, sizeof(aes_key));
+    return 0;
+}
+
+int bthome_aes_ecb(const uint8_t in[16], uint8_t out[16])
+{
+    return bt_encrypt_be(aes_key, in, out) ? -EIO : 0;
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "bthome_crypto.h"
+
+#include <mbedtls/aes.h>
+
+static mbedtls_aes_context aes_ctx;
+
+int bthome_aes_set_key(const uint8_t key[16])
+{
+    mbedtls_aes_init(&aes_ctx);
+
+    return mbedtls_aes_setkey_enc(&aes_ctx, key, 128) ? -EIO : 0;
+}
+
+int bthome_aes_ecb(const uint8_t in[16], uint8_t out[16])
+{
+    return mbedtls_aes_crypt_ecb(&aes_ctx, MBEDTLS_AES_ENCRYPT, in, out) ? -EIO : 0;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "bthome_crypto.h"
+
+#include <psa/crypto.h>
+
+static psa_key_id_t key_id = PSA_KEY_ID_NULL;
+
+int bthome_aes_set_key(const uint8_t key[16])
+{
+    psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+
+    if (psa_crypto_init() != PSA_SUCCESS) {
+        return -EIO;
+    }
+
+    if (key_id != PSA_KEY_ID_NULL) {
+        psa_destroy_key(key_id);
+        key_id = PSA_KEY_ID_NULL;
+    }
+
+    psa_set_key_type(&attr, PSA_KEY_TYPE_AES);
+    psa_set_key_bits(&attr, 128);
+    psa_set_key_usage_flags(&attr, PSA_KEY_USAGE_ENCRYPT);
+    psa_set_key_algorithm(&attr, PSA_ALG_ECB_NO_PADDING);
+
+    return (psa_import_key(&attr, key, 16, &key_id) == PSA_SUCCESS) ? 0 : -EIO;
+}
+
+int bthome_aes_ecb(const uint8_t in[16], uint8_t out[16])
+{
+    size_t out_len;
+
+    if (psa_cipher_encrypt(key_id, PSA_ALG_ECB_NO_PADDING, in, 16,
+                           out, 16, &out_len) != PSA_SUCCESS) {
+        return -EIO;
+    }
+
+    return (out_len == 16) ? 0 : -EIO;
+}
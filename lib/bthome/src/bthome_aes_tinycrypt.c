@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "bthome_crypto.h"
+
+#include <tinycrypt/aes.h>
+#include <tinycrypt/constants.h>
+
+static struct tc_aes_key_sched_struct key_sched;
+
+int bthome_aes_set_key(const uint8_t key[16])
+{
+    return (tc_aes128_set_encrypt_key(&key_sched, key) == TC_CRYPTO_SUCCESS) ? 0 : -EIO;
+}
+
+int bthome_aes_ecb(const uint8_t in[16], uint8_t out[16])
+{
+    return (tc_aes_encrypt(out, in, &key_sched) == TC_CRYPTO_SUCCESS) ? 0 : -EIO;
+}
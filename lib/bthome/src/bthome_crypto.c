@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "bthome_crypto.h"
+
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#if defined(CONFIG_BTHOME_ENCRYPTION_COUNTER_PERSIST)
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/crc.h>
+#endif
+
+LOG_MODULE_DECLARE(bthome, CONFIG_BTHOME_LOG_LEVEL);
+
+/*
+ * The AES backend holds one key at a time. Devices encrypting from the
+ * advertising path and a decoder running in another thread take turns.
+ */
+static K_MUTEX_DEFINE(crypto_lock);
+
+static int backend_set_key(struct bthome_aes *aes, const uint8_t key[16])
+{
+    ARG_UNUSED(aes);
+
+    return bthome_aes_set_key(key);
+}
+
+static int backend_encrypt(struct bthome_aes *aes, const uint8_t in[16], uint8_t out[16])
+{
+    ARG_UNUSED(aes);
+
+    return bthome_aes_ecb(in, out);
+}
+
+/* Codec view of the linked backend, protected by crypto_lock */
+static struct bthome_aes backend = {
+    .set_key = backend_set_key,
+    .encrypt = backend_encrypt,
+};
+
+/* mac is in bt_addr_t order, NULL for the identity address */
+static void nonce_mac(const uint8_t *mac, uint8_t out[6])
+{
+    bt_addr_le_t addrs[CONFIG_BT_ID_MAX];
+    size_t count = ARRAY_SIZE(addrs);
+
+    if (!mac) {
+        bt_id_get(addrs, &count);
+        mac = addrs[BT_ID_DEFAULT].a.val;
+    }
+
+    memcpy(out, mac, 6);
+}
+
+static void build_nonce(uint8_t nonce[BTHOME_CCM_NONCE_LEN], const uint8_t *mac,
+                        uint8_t device_info, uint32_t counter)
+{
+    uint8_t addr[6];
+
+    nonce_mac(mac, addr);
+    bthome_ccm_nonce(nonce, addr, device_info, counter);
+}
+
+#if defined(CONFIG_BTHOME_ENCRYPTION_COUNTER_PERSIST)
+#define COUNTER_BLOCK CONFIG_BTHOME_ENCRYPTION_COUNTER_BLOCK
+
+struct counter_load {
+    uint32_t value;
+    bool found;
+};
+
+/* One entry per bind key: the key itself is not stored */
+static void counter_name(const struct bthome_device *dev, char *name, size_t size)
+{
+    snprintk(name, size, "bthome/ctr/%08x",
+             crc32_ieee(dev->config.bind_key, sizeof(dev->config.bind_key)));
+}
+
+static int counter_load_cb(const char *key, size_t len, settings_read_cb read_cb,
+                           void *cb_arg, void *param)
+{
+    struct counter_load *load = param;
+
+    ARG_UNUSED(key);
+
+    if (len != sizeof(load->value)) {
+        return -EINVAL;
+    }
+
+    if (read_cb(cb_arg, &load->value, sizeof(load->value)) == sizeof(load->value)) {
+        load->found = true;
+    }
+
+    return 0;
+}
+
+/* Store the end of the next block before any counter in it is used */
+static int counter_reserve(struct bthome_device *dev)
+{
+    uint32_t limit = dev->encrypt_counter + COUNTER_BLOCK;
+    char name[24];
+    int err;
+
+    counter_name(dev, name, sizeof(name));
+    err = settings_save_one(name, &limit, sizeof(limit));
+    if (err) {
+        LOG_ERR("Failed to store encryption counter: %d", err);
+        return err;
+    }
+
+    dev->counter_limit = limit;
+
+    return 0;
+}
+
+static int counter_restore(struct bthome_device *dev)
+{
+    struct counter_load load = { 0 };
+    char name[24];
+    int err;
+
+    err = settings_subsys_init();
+    if (err) {
+        return err;
+    }
+
+    counter_name(dev, name, sizeof(name));
+    err = settings_load_subtree_direct(name, counter_load_cb, &load);
+    if (err) {
+        return err;
+    }
+
+    /* Continue after the block reserved before the reset */
+    dev->encrypt_counter = load.found ? load.value : 0;
+    LOG_INF("Encryption counter continues at %u", dev->encrypt_counter);
+
+    return counter_reserve(dev);
+}
+#endif
+
+int bthome_crypto_init(struct bthome_device *dev)
+{
+    int err;
+
+    k_mutex_lock(&crypto_lock, K_FOREVER);
+    err = bthome_aes_load_key(&backend, dev->config.bind_key);
+    k_mutex_unlock(&crypto_lock);
+    if (err) {
+        LOG_ERR("Failed to load bind key: %d", err);
+        return err;
+    }
+
+#if defined(CONFIG_BTHOME_ENCRYPTION_COUNTER_PERSIST)
+    /* Without a stored counter nonces would repeat: refuse to encrypt */
+    err = counter_restore(dev);
+    if (err) {
+        return err;
+    }
+#else
+    LOG_WRN("Encryption counter restarts at 0 after reset, "
+            "enable CONFIG_BTHOME_ENCRYPTION_COUNTER_PERSIST");
+#endif
+
+    dev->keystream_valid = false;
+    return 0;
+}
+
+static int keystream_update(struct bthome_device *dev, const uint8_t *mac,
+                            uint8_t device_info)
+{
+    uint8_t nonce[BTHOME_CCM_NONCE_LEN];
+    uint8_t addr[6];
+    int err;
+
+    /* Precomputed for the identity address, an explicit MAC may differ */
+    nonce_mac(mac, addr);
+
+    if (dev->keystream_valid && dev->keystream_counter == dev->encrypt_counter &&
+        dev->keystream_info == device_info &&
+        memcmp(dev->keystream_mac, addr, sizeof(addr)) == 0) {
+        return 0;
+    }
+
+    err = bthome_aes_load_key(&backend, dev->config.bind_key);
+    if (err) {
+        return err;
+    }
+
+    bthome_ccm_nonce(nonce, addr, device_info, dev->encrypt_counter);
+    err = bthome_ccm_keystream(&backend, nonce, dev->keystream);
+    if (err) {
+        dev->keystream_valid = false;
+        return err;
+    }
+
+    dev->keystream_counter = dev->encrypt_counter;
+    dev->keystream_info = device_info;
+    memcpy(dev->keystream_mac, addr, sizeof(addr));
+    dev->keystream_valid = true;
+
+    return 0;
+}
+
+static int ccm_encrypt(struct bthome_device *dev, const uint8_t *mac,
+                       uint8_t device_info, const uint8_t *payload, uint8_t len,
+                       uint8_t *out)
+{
+    uint8_t nonce[BTHOME_CCM_NONCE_LEN];
+    int ret;
+
+    if (len > BTHOME_MAX_PAYLOAD_ENC) {
+        return -EMSGSIZE;
+    }
+
+#if defined(CONFIG_BTHOME_ENCRYPTION_COUNTER_PERSIST)
+    if (dev->encrypt_counter >= dev->counter_limit) {
+        ret = counter_reserve(dev);
+        if (ret) {
+            return ret;
+        }
+    }
+#endif
+
+    /* Normally a no-op: computed after the previous advertisement */
+    ret = keystream_update(dev, mac, device_info);
+    if (ret) {
+        return ret;
+    }
+
+    /* A cached keystream skips the key load above, another key may be active */
+    ret = bthome_aes_load_key(&backend, dev->config.bind_key);
+    if (ret) {
+        return ret;
+    }
+
+    build_nonce(nonce, mac, device_info, dev->encrypt_counter);
+    ret = bthome_ccm_seal(&backend, nonce, (const uint8_t (*)[16])dev->keystream, payload,
+                          len, dev->encrypt_counter, out);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* Counter must never repeat under the same key */
+    dev->encrypt_counter++;
+    dev->keystream_valid = false;
+
+    return ret;
+}
+
+int bthome_crypto_precompute(struct bthome_device *dev, const uint8_t *mac,
+                             uint8_t device_info)
+{
+    int err;
+
+    k_mutex_lock(&crypto_lock, K_FOREVER);
+    err = keystream_update(dev, mac, device_info);
+    k_mutex_unlock(&crypto_lock);
+
+    return err;
+}
+
+int bthome_crypto_encrypt(struct bthome_device *dev, const uint8_t *mac,
+                          uint8_t device_info, const uint8_t *payload, uint8_t len,
+                          uint8_t *out)
+{
+    int ret;
+
+    k_mutex_lock(&crypto_lock, K_FOREVER);
+    ret = ccm_encrypt(dev, mac, device_info, payload, len, out);
+    k_mutex_unlock(&crypto_lock);
+
+    return ret;
+}
+
+int bthome_crypto_decode(const uint8_t *service_data, size_t len, const uint8_t mac[6],
+                         const uint8_t key[16], struct bthome_packet *pkt)
+{
+    int ret;
+
+    k_mutex_lock(&crypto_lock, K_FOREVER);
+    ret = bthome_codec_decode(service_data, len, mac, key, &backend, pkt);
+    k_mutex_unlock(&crypto_lock);
+
+    return ret;
+}
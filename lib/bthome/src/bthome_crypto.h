@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BTHOME_CRYPTO_H_
+#define BTHOME_CRYPTO_H_
+
+#include <zephyr/bthome/bthome.h>
+
+/*
+ * AES-128 block cipher backend, one implementation is linked depending
+ * on the CONFIG_BTHOME_CRYPTO_* choice (bthome_aes_<backend>.c).
+ */
+int bthome_aes_set_key(const uint8_t key[16]);
+int bthome_aes_ecb(const uint8_t in[16], uint8_t out[16]);
+
+/* Load the bind key into the AES engine */
+int bthome_crypto_init(struct bthome_device *dev);
+
+/*
+ * The MAC used for the nonce is given in bt_addr_t (little endian) order,
+ * NULL selects the identity address of the local controller.
+ */
+
+/*
+ * Encrypt len bytes of payload with AES-CCM for the current
+ * encrypt_counter and write ciphertext, counter and MIC to out.
+ * Returns the number of bytes written or a negative error code.
+ */
+int bthome_crypto_encrypt(struct bthome_device *dev, const uint8_t *mac,
+                          uint8_t device_info, const uint8_t *payload, uint8_t len,
+                          uint8_t *out);
+
+/* Compute the CTR keystream for the current encrypt_counter ahead of time */
+int bthome_crypto_precompute(struct bthome_device *dev, const uint8_t *mac,
+                             uint8_t device_info);
+
+/*
+ * bthome_codec_decode() with the linked AES backend, serialised against
+ * encryption by other devices.
+ */
+int bthome_crypto_decode(const uint8_t *service_data, size_t len, const uint8_t mac[6],
+                         const uint8_t key[16], struct bthome_packet *pkt);
+
+#endif /* BTHOME_CRYPTO_H_ */
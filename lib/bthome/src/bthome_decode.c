@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/bthome/decode.h>
+
+#if defined(CONFIG_BTHOME_ENCRYPTION)
+#include "bthome_crypto.h"
+#endif
+
+int bthome_decode(const uint8_t *service_data, size_t len, const uint8_t mac[6],
+                  const uint8_t key[16], struct bthome_packet *pkt)
+{
+#if defined(CONFIG_BTHOME_ENCRYPTION)
+    return bthome_crypto_decode(service_data, len, mac, key, pkt);
+#else
+    /* Without a cipher encrypted packets are rejected with -ENOTSUP */
+    return bthome_codec_decode(service_data, len, mac, key, NULL, pkt);
+#endif
+}
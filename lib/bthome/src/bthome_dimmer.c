@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/bthome/dimmer.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(bthome, CONFIG_BTHOME_LOG_LEVEL);
+
+#define COUNTS_PER_STEP CONFIG_BTHOME_DIMMER_COUNTS_PER_STEP
+
+/* Counts read from the decoder but not yet reported as whole steps */
+static int32_t residual_counts;
+/* Steps that did not fit into the previous event */
+static int32_t pending_steps;
+
+#if defined(CONFIG_BTHOME_DIMMER_NRF)
+#include <nrfx_qdec.h>
+#include <zephyr/drivers/pinctrl.h>
+
+/* Pins come from the pinctrl states of the enabled QDEC node */
+#define QDEC_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(nordic_nrf_qdec)
+
+PINCTRL_DT_DEFINE(QDEC_NODE);
+
+static const nrfx_qdec_t qdec = NRFX_QDEC_INSTANCE(0);
+
+/* All QDEC interrupts stay disabled, the handler is never called */
+static void qdec_handler(nrfx_qdec_event_t event, void *context)
+{
+    ARG_UNUSED(event);
+    ARG_UNUSED(context);
+}
+
+int bthome_dimmer_init(void)
+{
+    nrfx_qdec_config_t config = NRFX_QDEC_DEFAULT_CONFIG(NRF_QDEC_PIN_NOT_CONNECTED,
+                                                         NRF_QDEC_PIN_NOT_CONNECTED,
+                                                         NRF_QDEC_LED_NOT_CONNECTED);
+    nrfx_err_t nerr;
+    int err;
+
+    err = pinctrl_apply_state(PINCTRL_DT_DEV_CONFIG_GET(QDEC_NODE), PINCTRL_STATE_DEFAULT);
+    if (err) {
+        LOG_ERR("Failed to apply QDEC pinctrl (err %d)", err);
+        return err;
+    }
+
+    /* Hardware accumulation only: no SAMPLERDY or REPORTRDY interrupts */
+    config.reportper = NRF_QDEC_REPORTPER_DISABLED;
+    config.sample_inten = false;
+    config.dbfen = true;
+    config.skip_gpio_cfg = true;
+    config.skip_psel_cfg = true;
+
+    nerr = nrfx_qdec_init(&qdec, &config, qdec_handler, NULL);
+    if (nerr != NRFX_SUCCESS) {
+        LOG_ERR("Failed to init QDEC: 0x%08X", nerr);
+        return -EBUSY;
+    }
+
+    nrfx_qdec_enable(&qdec);
+
+    LOG_INF("Dimmer ready: %s", DT_NODE_FULL_NAME(QDEC_NODE));
+    return 0;
+}
+
+static int32_t dimmer_take_counts(void)
+{
+    int32_t acc;
+    uint32_t accdbl;
+
+    /* READCLRACC: copy ACC to ACCREAD and clear it in one task */
+    nrfx_qdec_accumulators_read(&qdec, &acc, &accdbl);
+    if (accdbl) {
+        LOG_WRN("QDEC double transitions: %u", accdbl);
+    }
+
+    /* ACC saturates at 10 bits; keep a bad read from running away with the residual */
+    return CLAMP(acc, INT16_MIN, INT16_MAX);
+}
+
+#elif defined(CONFIG_BTHOME_DIMMER_EMUL)
+
+static atomic_t emul_counts;
+
+int bthome_dimmer_init(void)
+{
+    atomic_clear(&emul_counts);
+    LOG_INF("Dimmer ready (emulated)");
+    return 0;
+}
+
+void bthome_dimmer_emul_rotate(int32_t counts)
+{
+    atomic_add(&emul_counts, counts);
+}
+
+static int32_t dimmer_take_counts(void)
+{
+    return (int32_t)atomic_clear(&emul_counts);
+}
+
+#endif
+
+int bthome_dimmer_read(int32_t *steps)
+{
+    if (!steps) {
+        return -EINVAL;
+    }
+
+    residual_counts += dimmer_take_counts();
+
+    /* Truncate toward zero, keep partial detents for later */
+    *steps = residual_counts / COUNTS_PER_STEP;
+    residual_counts -= *steps * COUNTS_PER_STEP;
+
+    return 0;
+}
+
+int bthome_dimmer_add(struct bthome_device *dev)
+{
+    int32_t steps;
+    uint8_t event;
+    uint8_t magnitude;
+    int err;
+
+    if (!dev) {
+        return -EINVAL;
+    }
+
+    err = bthome_dimmer_read(&steps);
+    if (err) {
+        return err;
+    }
+
+    pending_steps += steps;
+    if (pending_steps == 0) {
+        return -ENODATA;
+    }
+
+    event = (pending_steps > 0) ? BTHOME_EVENT_DIMMER_RIGHT : BTHOME_EVENT_DIMMER_LEFT;
+    magnitude = (uint8_t)MIN(pending_steps > 0 ? pending_steps : -pending_steps,
+                             UINT8_MAX);
+
+    err = bthome_add_event(dev, BTHOME_EVENT_DIMMER, event, magnitude);
+    if (err) {
+        return err;
+    }
+
+    pending_steps += (event == BTHOME_EVENT_DIMMER_RIGHT) ? -magnitude : magnitude;
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/bthome/dt.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+LOG_MODULE_DECLARE(bthome, CONFIG_BTHOME_LOG_LEVEL);
+
+static int32_t bthome_dt_raw(const struct bthome_dt_object *obj,
+                             const struct sensor_value *val)
+{
+    int64_t raw = (int64_t)val->val1 * obj->scale +
+                  (int64_t)val->val2 * obj->scale / 1000000;
+
+    return (int32_t)CLAMP(raw, INT32_MIN, INT32_MAX);
+}
+
+static bool bthome_dt_due(const struct bthome_dt_object *obj,
+                          const struct bthome_dt_state *state, int32_t raw)
+{
+    if (!state->valid || state->skipped + 1 >= obj->every_n) {
+        return true;
+    }
+
+    int64_t delta = (int64_t)raw - state->last;
+
+    return obj->deadband && (uint64_t)(delta < 0 ? -delta : delta) >= obj->deadband;
+}
+
+static int bthome_dt_fetch(const struct bthome_dt_object *objects, size_t idx)
+{
+    /* Fetch each sensor only for its first object */
+    for (size_t i = 0; i < idx; i++) {
+        if (objects[i].sensor == objects[idx].sensor) {
+            return 0;
+        }
+    }
+
+    if (!device_is_ready(objects[idx].sensor)) {
+        return -ENODEV;
+    }
+
+    return sensor_sample_fetch(objects[idx].sensor);
+}
+
+int bthome_dt_update(struct bthome_device *dev, const struct bthome_dt_object *objects,
+                     struct bthome_dt_state *state, size_t count)
+{
+    int added = 0;
+
+    if (!dev || !objects || !state) {
+        return -EINVAL;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const struct bthome_dt_object *obj = &objects[i];
+        struct sensor_value val;
+        uint8_t le[4];
+        uint8_t *ptr;
+        int32_t raw;
+        int err;
+
+        err = bthome_dt_fetch(objects, i);
+        if (err) {
+            LOG_WRN("Sensor %s fetch failed: %d", obj->sensor->name, err);
+            return err;
+        }
+
+        err = sensor_channel_get(obj->sensor, obj->channel, &val);
+        if (err) {
+            return err;
+        }
+
+        raw = bthome_dt_raw(obj, &val);
+        if (!bthome_dt_due(obj, &state[i], raw)) {
+            state[i].skipped++;
+            continue;
+        }
+
+        err = bthome_payload_reserve(dev, obj->object_id, obj->size, &ptr);
+        if (err) {
+            return err;
+        }
+
+        /* Two's complement little endian, truncated to the object size */
+        sys_put_le32((uint32_t)raw, le);
+        memcpy(ptr, le, obj->size);
+        err = bthome_payload_commit(dev);
+        if (err) {
+            return err;
+        }
+
+        state[i].last = raw;
+        state[i].skipped = 0;
+        state[i].valid = true;
+        added++;
+    }
+
+    return added;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/bthome/packer.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+LOG_MODULE_DECLARE(bthome, CONFIG_BTHOME_LOG_LEVEL);
+
+BUILD_ASSERT(CONFIG_BTHOME_MAX_MEASUREMENTS <= 32, "selection mask is 32 bits");
+
+int bthome_packer_queue(struct bthome_packer *packer,
+                        const struct bthome_measurement *measurement,
+                        uint8_t priority, uint32_t change)
+{
+    struct bthome_packer_entry *entry = NULL;
+
+    if (!packer || !measurement || bthome_object_size(measurement->object_id) == 0) {
+        return -EINVAL;
+    }
+
+    for (uint8_t i = 0; i < packer->count; i++) {
+        if (packer->entries[i].measurement.object_id == measurement->object_id) {
+            entry = &packer->entries[i];
+            break;
+        }
+    }
+
+    if (!entry) {
+        if (packer->count == ARRAY_SIZE(packer->entries)) {
+            return -ENOMEM;
+        }
+
+        entry = &packer->entries[packer->count++];
+        entry->queued_ms = k_uptime_get();
+        entry->change = 0;
+    }
+
+    entry->measurement = *measurement;
+    entry->priority = priority;
+    entry->change = (change > UINT32_MAX - entry->change) ?
+                    UINT32_MAX : entry->change + change;
+
+    return 0;
+}
+
+static uint32_t bthome_packer_value(const struct bthome_packer_entry *entry, int64_t now)
+{
+    uint64_t age_s = (now - entry->queued_ms) / MSEC_PER_SEC;
+    uint64_t value = (uint64_t)(entry->priority + 1) * (age_s + 1) + entry->change;
+
+    return (uint32_t)MIN(value, UINT32_MAX);
+}
+
+int bthome_packer_pack(struct bthome_packer *packer, struct bthome_device *dev)
+{
+    /* best[w]: highest value within w bytes, pick[w]: the objects giving it */
+    uint64_t best[BTHOME_MAX_PAYLOAD_SIZE + 1] = {0};
+    uint32_t pick[BTHOME_MAX_PAYLOAD_SIZE + 1] = {0};
+    uint8_t max_payload;
+    uint8_t budget;
+    uint8_t kept = 0;
+    int64_t now;
+    int added = 0;
+
+    if (!packer || !dev) {
+        return -EINVAL;
+    }
+
+    max_payload = dev->config.encryption ? BTHOME_MAX_PAYLOAD_ENC : BTHOME_MAX_PAYLOAD_SIZE;
+    budget = max_payload > dev->payload_len ? max_payload - dev->payload_len : 0;
+    now = k_uptime_get();
+
+    /* 0/1 knapsack, at most 20 objects and 23 bytes */
+    for (uint8_t i = 0; i < packer->count; i++) {
+        const struct bthome_packer_entry *entry = &packer->entries[i];
+        uint8_t weight = 1 + bthome_object_size(entry->measurement.object_id);
+        uint64_t value = bthome_packer_value(entry, now);
+
+        for (int w = budget; w >= weight; w--) {
+            if (best[w - weight] + value > best[w]) {
+                best[w] = best[w - weight] + value;
+                pick[w] = pick[w - weight] | BIT(i);
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < packer->count; i++) {
+        if ((pick[budget] & BIT(i)) &&
+            bthome_add_measurement(dev, &packer->entries[i].measurement) == 0) {
+            added++;
+            continue;
+        }
+
+        /* Deferred: stays queued and keeps gaining value */
+        packer->entries[kept++] = packer->entries[i];
+    }
+
+    if (kept) {
+        LOG_DBG("Packed %d objects, %u deferred", added, kept);
+    }
+
+    packer->count = kept;
+
+    return added;
+}
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/bthome/pulse_counter.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(bthome, CONFIG_BTHOME_LOG_LEVEL);
+
+#if defined(CONFIG_BTHOME_PULSE_COUNTER_NRF)
+#include <zephyr/drivers/gpio.h>
+#include <soc.h>
+#include <nrfx_gpiote.h>
+#include <nrfx_timer.h>
+#if defined(CONFIG_BTHOME_PULSE_RATE)
+#include <nrfx_rtc.h>
+#endif
+#include <helpers/nrfx_gppi.h>
+
+/* Pulse input: bthome-pulse-gpios in the zephyr,user node */
+#define PULSE_NODE DT_PATH(zephyr_user)
+
+BUILD_ASSERT(DT_NODE_HAS_PROP(PULSE_NODE, bthome_pulse_gpios),
+             "Add bthome-pulse-gpios to the zephyr,user node");
+
+#if defined(CONFIG_BTHOME_PULSE_COUNTER_TIMER2)
+#define PULSE_TIMER_IDX 2
+#elif defined(CONFIG_BTHOME_PULSE_COUNTER_TIMER3)
+#define PULSE_TIMER_IDX 3
+#else
+#define PULSE_TIMER_IDX 4
+#endif
+
+#if defined(CONFIG_BTHOME_PULSE_RATE_RTC0)
+#define EDGE_RTC_IDX 0
+#else
+#define EDGE_RTC_IDX 2
+#endif
+
+/* 32.768 kHz / (31 + 1) = BTHOME_PULSE_TICK_HZ, the 24-bit counter wraps after 4.5 h */
+#define EDGE_RTC_PRESCALER  (32768U / BTHOME_PULSE_TICK_HZ - 1U)
+#define EDGE_RTC_MAX        0xFFFFFFU
+
+/* GPIOTE instance shared with the Zephyr GPIO driver */
+static const nrfx_gpiote_t pulse_gpiote = NRFX_GPIOTE_INSTANCE(0);
+static const nrfx_timer_t pulse_timer = NRFX_TIMER_INSTANCE(PULSE_TIMER_IDX);
+#if defined(CONFIG_BTHOME_PULSE_RATE)
+/* Cleared by every pulse edge, so its counter is the time since the last pulse */
+static const nrfx_rtc_t edge_rtc = NRFX_RTC_INSTANCE(EDGE_RTC_IDX);
+static uint32_t last_count;
+#endif
+
+/* Counter mode never raises COMPARE events, the handler is never called */
+static void pulse_timer_handler(nrf_timer_event_t event_type, void *context)
+{
+    ARG_UNUSED(event_type);
+    ARG_UNUSED(context);
+}
+
+#if defined(CONFIG_BTHOME_PULSE_RATE)
+/* No RTC interrupt is enabled, the handler is never called */
+static void edge_rtc_handler(nrfx_rtc_int_type_t int_type)
+{
+    ARG_UNUSED(int_type);
+}
+
+/* Timestamp on the same LFCLK time base as the edge RTC */
+static uint32_t pulse_now_ticks(void)
+{
+    return (uint32_t)(k_ticks_to_us_floor64(k_uptime_ticks()) *
+                      BTHOME_PULSE_TICK_HZ / USEC_PER_SEC);
+}
+#endif
+
+int bthome_pulse_counter_init(void)
+{
+    const uint32_t pin = NRF_DT_GPIOS_TO_PSEL(PULSE_NODE, bthome_pulse_gpios);
+    nrfx_timer_config_t timer_config =
+        NRFX_TIMER_DEFAULT_CONFIG(NRFX_TIMER_BASE_FREQUENCY_GET(&pulse_timer));
+    nrf_gpio_pin_pull_t pull = (DT_GPIO_FLAGS(PULSE_NODE, bthome_pulse_gpios) & GPIO_PULL_UP) ?
+                               NRF_GPIO_PIN_PULLUP : NRF_GPIO_PIN_NOPULL;
+    nrfx_gpiote_trigger_config_t trigger_config = {
+        .trigger = NRFX_GPIOTE_TRIGGER_HITOLO,
+    };
+    nrfx_gpiote_input_pin_config_t input_config = {
+        .p_pull_config = &pull,
+        .p_trigger_config = &trigger_config,
+        .p_handler_config = NULL,   /* No interrupt per pulse */
+    };
+    uint8_t gpiote_ch;
+    uint8_t ppi_ch;
+    nrfx_err_t nerr;
+
+    /* Timer in low-power counter mode: TASK_COUNT increments, no HFCLK */
+    timer_config.mode = NRF_TIMER_MODE_LOW_POWER_COUNTER;
+    timer_config.bit_width = NRF_TIMER_BIT_WIDTH_32;
+
+    nerr = nrfx_timer_init(&pulse_timer, &timer_config, pulse_timer_handler);
+    if (nerr != NRFX_SUCCESS) {
+        LOG_ERR("Failed to init pulse timer: 0x%08X", nerr);
+        return -EBUSY;
+    }
+
+    nerr = nrfx_gpiote_channel_alloc(&pulse_gpiote, &gpiote_ch);
+    if (nerr != NRFX_SUCCESS) {
+        LOG_ERR("No free GPIOTE channel for pulse input");
+        goto err_timer;
+    }
+
+    trigger_config.p_in_channel = &gpiote_ch;
+    nerr = nrfx_gpiote_input_configure(&pulse_gpiote, pin, &input_config);
+    if (nerr != NRFX_SUCCESS) {
+        LOG_ERR("Failed to configure pulse pin %u: 0x%08X", pin, nerr);
+        goto err_gpiote;
+    }
+
+    nerr = nrfx_gppi_channel_alloc(&ppi_ch);
+    if (nerr != NRFX_SUCCESS) {
+        LOG_ERR("No free (D)PPI channel for pulse counter");
+        goto err_pin;
+    }
+
+    /* GPIOTE IN event -> TIMER COUNT task */
+    nrfx_gppi_channel_endpoints_setup(ppi_ch,
+        nrfx_gpiote_in_event_address_get(&pulse_gpiote, pin),
+        nrfx_timer_task_address_get(&pulse_timer, NRF_TIMER_TASK_COUNT));
+
+#if defined(CONFIG_BTHOME_PULSE_RATE)
+    {
+        nrfx_rtc_config_t rtc_config = NRFX_RTC_DEFAULT_CONFIG;
+
+        /*
+         * An RTC runs from the LFCLK that is on anyway. A TIMER would keep
+         * HFCLK and the 1 MHz peripheral clock requested all the time.
+         */
+        rtc_config.prescaler = EDGE_RTC_PRESCALER;
+        nerr = nrfx_rtc_init(&edge_rtc, &rtc_config, edge_rtc_handler);
+        if (nerr != NRFX_SUCCESS) {
+            LOG_ERR("Failed to init pulse edge RTC: 0x%08X", nerr);
+            nrfx_gppi_channel_free(ppi_ch);
+            goto err_pin;
+        }
+    }
+
+    /* Same edge clears the RTC, the overflow event marks gaps above 4.5 h */
+    nrfx_gppi_fork_endpoint_setup(ppi_ch, nrfx_rtc_task_address_get(&edge_rtc, NRF_RTC_TASK_CLEAR));
+    nrfx_rtc_overflow_enable(&edge_rtc, false);
+    nrfx_rtc_enable(&edge_rtc);
+    last_count = 0;
+#endif
+
+    nrfx_gppi_channels_enable(BIT(ppi_ch));
+
+    nrfx_timer_clear(&pulse_timer);
+    nrfx_timer_enable(&pulse_timer);
+    nrfx_gpiote_trigger_enable(&pulse_gpiote, pin, false);
+
+    LOG_INF("Pulse counter ready: pin %u -> TIMER%d", pin, PULSE_TIMER_IDX);
+    return 0;
+
+err_pin:
+    nrfx_gpiote_pin_uninit(&pulse_gpiote, pin);
+err_gpiote:
+    nrfx_gpiote_channel_free(&pulse_gpiote, gpiote_ch);
+err_timer:
+    nrfx_timer_uninit(&pulse_timer);
+    return -EBUSY;
+}
+
+int bthome_pulse_counter_read(uint32_t *count)
+{
+    if (!count) {
+        return -EINVAL;
+    }
+
+    /* TASK_CAPTURE copies the running count into CC[0] */
+    *count = nrfx_timer_capture(&pulse_timer, NRF_TIMER_CC_CHANNEL0);
+    return 0;
+}
+
+#if defined(CONFIG_BTHOME_PULSE_RATE)
+int bthome_pulse_counter_snapshot(struct bthome_pulse_snapshot *snap)
+{
+    uint32_t since;
+    uint32_t count;
+    bool overflow;
+
+    if (!snap) {
+        return -EINVAL;
+    }
+
+    /* Retry if a pulse lands between reading the count and the RTC */
+    do {
+        count = nrfx_timer_capture(&pulse_timer, NRF_TIMER_CC_CHANNEL0);
+        snap->now_ticks = pulse_now_ticks();
+        since = nrfx_rtc_counter_get(&edge_rtc);
+        overflow = nrf_rtc_event_check(edge_rtc.p_reg, NRF_RTC_EVENT_OVERFLOW);
+        snap->count = nrfx_timer_capture(&pulse_timer, NRF_TIMER_CC_CHANNEL0);
+    } while (snap->count != count);
+
+    if (snap->count != last_count) {
+        /* The RTC restarted at the new edge, an older overflow is stale */
+        nrf_rtc_event_clear(edge_rtc.p_reg, NRF_RTC_EVENT_OVERFLOW);
+        last_count = snap->count;
+    } else if (overflow) {
+        since = EDGE_RTC_MAX;
+    }
+
+    snap->edge_ticks = snap->now_ticks - since;
+
+    return 0;
+}
+#endif
+
+#elif defined(CONFIG_BTHOME_PULSE_COUNTER_EMUL)
+
+static atomic_t emul_count;
+static atomic_t emul_edge_ticks;
+
+static uint32_t emul_now_ticks(void)
+{
+    return (uint32_t)(k_ticks_to_us_floor64(k_uptime_ticks()) *
+                      BTHOME_PULSE_TICK_HZ / USEC_PER_SEC);
+}
+
+int bthome_pulse_counter_init(void)
+{
+    atomic_clear(&emul_count);
+    atomic_set(&emul_edge_ticks, (atomic_val_t)emul_now_ticks());
+    LOG_INF("Pulse counter ready (emulated)");
+    return 0;
+}
+
+int bthome_pulse_counter_read(uint32_t *count)
+{
+    if (!count) {
+        return -EINVAL;
+    }
+
+    *count = (uint32_t)atomic_get(&emul_count);
+    return 0;
+}
+
+void bthome_pulse_counter_emul_pulse(uint32_t pulses)
+{
+    unsigned int key = irq_lock();
+
+    atomic_add(&emul_count, (atomic_val_t)pulses);
+    atomic_set(&emul_edge_ticks, (atomic_val_t)emul_now_ticks());
+    irq_unlock(key);
+}
+
+int bthome_pulse_counter_snapshot(struct bthome_pulse_snapshot *snap)
+{
+    unsigned int key;
+
+    if (!snap) {
+        return -EINVAL;
+    }
+
+    key = irq_lock();
+    snap->count = (uint32_t)atomic_get(&emul_count);
+    snap->edge_ticks = (uint32_t)atomic_get(&emul_edge_ticks);
+    irq_unlock(key);
+    snap->now_ticks = emul_now_ticks();
+
+    return 0;
+}
+
+#endif
+
+#if defined(CONFIG_BTHOME_PULSE_COUNTER_NRF) && !defined(CONFIG_BTHOME_PULSE_RATE)
+int bthome_pulse_counter_snapshot(struct bthome_pulse_snapshot *snap)
+{
+    ARG_UNUSED(snap);
+    return -ENOTSUP;
+}
+#endif
+
+int bthome_pulse_counter_add(struct bthome_device *dev)
+{
+    uint32_t count;
+    int err;
+    struct bthome_measurement measurement = {
+        .object_id = BTHOME_ID_COUNT4,
+    };
+
+    if (!dev) {
+        return -EINVAL;
+    }
+
+    err = bthome_pulse_counter_read(&count);
+    if (err) {
+        return err;
+    }
+
+    measurement.value.u32 = count;
+    return bthome_add_measurement(dev, &measurement);
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/bthome/pulse_rate.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(bthome, CONFIG_BTHOME_LOG_LEVEL);
+
+#define RATE_WINDOW CONFIG_BTHOME_PULSE_RATE_WINDOW
+
+/* Joules per kWh, scaled for 0.01 W output from 0.001 Hz input */
+#define CENTIWATT_PER_MILLIHZ_KWH  360000ULL
+/* Litres per m³ times seconds per hour, scaled for 0.001 Hz input */
+#define LPH_PER_MILLIHZ_M3         3600ULL
+
+/* Ring buffer of snapshots, one entry per distinct pulse edge */
+static struct bthome_pulse_snapshot ring[RATE_WINDOW];
+static uint8_t ring_head;
+static uint8_t ring_used;
+static struct bthome_pulse_snapshot latest;
+static uint32_t pulses_per_unit;
+
+static const struct bthome_pulse_snapshot *ring_entry(uint8_t age)
+{
+    return &ring[(ring_head + RATE_WINDOW - 1 - age) % RATE_WINDOW];
+}
+
+int bthome_pulse_rate_init(const struct bthome_pulse_rate_config *config)
+{
+    if (!config || config->pulses_per_unit == 0) {
+        return -EINVAL;
+    }
+
+    pulses_per_unit = config->pulses_per_unit;
+    ring_head = 0;
+    ring_used = 0;
+
+    return bthome_pulse_counter_snapshot(&latest);
+}
+
+int bthome_pulse_rate_update(void)
+{
+    int err;
+
+    err = bthome_pulse_counter_snapshot(&latest);
+    if (err) {
+        return err;
+    }
+
+    /* Only a new edge carries new interval information */
+    if (ring_used > 0 && ring_entry(0)->count == latest.count) {
+        return 0;
+    }
+
+    ring[ring_head] = latest;
+    ring_head = (ring_head + 1) % RATE_WINDOW;
+    if (ring_used < RATE_WINDOW) {
+        ring_used++;
+    }
+
+    return 0;
+}
+
+int bthome_pulse_rate_get(uint32_t *milli_hz)
+{
+    const struct bthome_pulse_snapshot *newest;
+    const struct bthome_pulse_snapshot *oldest;
+    uint32_t pulses;
+    uint32_t ticks;
+    uint32_t since;
+    uint64_t rate;
+
+    if (!milli_hz) {
+        return -EINVAL;
+    }
+
+    if (ring_used < 2) {
+        return -ENODATA;
+    }
+
+    newest = ring_entry(0);
+    oldest = ring_entry(ring_used - 1);
+
+    /* Unsigned arithmetic handles one wrap of counter and timestamp */
+    pulses = newest->count - oldest->count;
+    ticks = newest->edge_ticks - oldest->edge_ticks;
+    if (ticks == 0) {
+        return -ENODATA;
+    }
+
+    rate = (uint64_t)pulses * BTHOME_PULSE_TICK_HZ * 1000U / ticks;
+
+    /* No pulse for longer than one interval: rate is at most 1/since */
+    since = latest.now_ticks - newest->edge_ticks;
+    if ((uint64_t)since * pulses > ticks) {
+        rate = (uint64_t)BTHOME_PULSE_TICK_HZ * 1000U / since;
+    }
+
+    *milli_hz = (uint32_t)MIN(rate, UINT32_MAX);
+    return 0;
+}
+
+static int add_u32(struct bthome_device *dev, uint8_t object_id, uint32_t value)
+{
+    struct bthome_measurement measurement = {
+        .object_id = object_id,
+    };
+
+    switch (object_id) {
+    case BTHOME_ID_VOLUME_FLOW_RATE:
+        measurement.value.u16 = (uint16_t)MIN(value, UINT16_MAX);
+        break;
+    case BTHOME_ID_POWER:
+        measurement.value.u32 = MIN(value, 0xFFFFFFU);
+        break;
+    default:
+        measurement.value.u32 = value;
+        break;
+    }
+
+    return bthome_add_measurement(dev, &measurement);
+}
+
+static int add_rate_and_total(struct bthome_device *dev, uint8_t rate_id,
+                              uint64_t rate_factor, uint8_t total_id)
+{
+    uint32_t milli_hz = 0;
+    uint64_t total;
+    int err;
+
+    if (!dev) {
+        return -EINVAL;
+    }
+
+    if (pulses_per_unit == 0) {
+        return -EINVAL;
+    }
+
+    err = bthome_pulse_rate_get(&milli_hz);
+    if (err && err != -ENODATA) {
+        return err;
+    }
+
+    err = add_u32(dev, rate_id, (uint32_t)MIN((uint64_t)milli_hz * rate_factor /
+                                              pulses_per_unit, UINT32_MAX));
+    if (err) {
+        return err;
+    }
+
+    /* Totals in 0.001 units: Wh or litres */
+    total = (uint64_t)latest.count * 1000U / pulses_per_unit;
+
+    return add_u32(dev, total_id, (uint32_t)total);
+}
+
+int bthome_pulse_rate_add_power(struct bthome_device *dev)
+{
+    return add_rate_and_total(dev, BTHOME_ID_POWER, CENTIWATT_PER_MILLIHZ_KWH,
+                              BTHOME_ID_ENERGY4);
+}
+
+int bthome_pulse_rate_add_flow(struct bthome_device *dev)
+{
+    return add_rate_and_total(dev, BTHOME_ID_VOLUME_FLOW_RATE, LPH_PER_MILLIHZ_M3,
+                              BTHOME_ID_VOLUME);
+}
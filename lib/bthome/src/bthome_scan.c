@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/bthome/scan.h>
+#include <zephyr/sys/util.h>
+
+#include <errno.h>
+#include <string.h>
+
+enum {
+    SCAN_FREE,
+    SCAN_LEARNING,                  /* Seen once, period unknown */
+    SCAN_TRACKING,
+    SCAN_LOST,                      /* Too many misses, left to discovery */
+};
+
+/*
+ * Packets are reported after decoding, so an arrival only counts as
+ * missed this long after its window closed.
+ */
+#define SCAN_REPORT_DELAY_MS    100
+
+/* Window half-width in learned deviations */
+#define SCAN_DEV_FACTOR         3
+
+/*
+ * Deviation assumed for a period measured from a single pair of packets:
+ * the random advertising delay of up to 10 ms
+ */
+#define SCAN_INITIAL_DEV_US     10000
+
+/* Inverse gain of the period and deviation filters */
+#define SCAN_PERIOD_GAIN        8
+#define SCAN_DEV_GAIN           4
+
+int bthome_scan_init(struct bthome_scan *scan, const struct bthome_scan_config *cfg,
+                     struct bthome_scan_sensor *sensors, size_t max_sensors)
+{
+    if (cfg->discovery_ms == 0 ||
+        (cfg->discovery_interval_ms && cfg->discovery_interval_ms < cfg->discovery_ms)) {
+        return -EINVAL;
+    }
+
+    memset(scan, 0, sizeof(*scan));
+    memset(sensors, 0, max_sensors * sizeof(*sensors));
+
+    scan->cfg = *cfg;
+    scan->sensors = sensors;
+    scan->max_sensors = max_sensors;
+
+    return 0;
+}
+
+static struct bthome_scan_sensor *scan_find(struct bthome_scan *scan, const uint8_t mac[6])
+{
+    for (size_t i = 0; i < scan->num_sensors; i++) {
+        if (memcmp(scan->sensors[i].mac, mac, 6) == 0) {
+            return &scan->sensors[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Number of periods since the last packet. The packet ID gives it modulo
+ * 256; with a learned period the wrap count is taken from the elapsed
+ * time. Returns 0 for a repeated reception.
+ */
+static int64_t scan_gap(const struct bthome_scan_sensor *s, int packet_id, int64_t dt_us)
+{
+    int64_t est;
+    int64_t gap;
+
+    if (s->state == SCAN_LEARNING) {
+        /* No period yet: trust the ID, or assume consecutive packets */
+        if (packet_id < 0) {
+            return dt_us >= 1000000 ? 1 : 0;
+        }
+        return (uint8_t)(packet_id - s->last_id);
+    }
+
+    est = (dt_us + s->period_us / 2) / s->period_us;
+    if (packet_id < 0) {
+        return est;
+    }
+
+    gap = (uint8_t)(packet_id - s->last_id);
+    if (gap == 0 && est < 128) {
+        return 0;
+    }
+
+    /* Closest gap to the estimate with the same ID */
+    gap += (est - gap + 128) / 256 * 256;
+
+    return MAX(gap, 1);
+}
+
+int bthome_scan_observe(struct bthome_scan *scan, const uint8_t mac[6], int packet_id,
+                        int64_t rx_ms)
+{
+    struct bthome_scan_sensor *s = scan_find(scan, mac);
+    int64_t dt_us;
+    int64_t gap;
+    int64_t err;
+
+    if (!s) {
+        if (scan->num_sensors == scan->max_sensors) {
+            return -ENOMEM;
+        }
+
+        s = &scan->sensors[scan->num_sensors++];
+        memcpy(s->mac, mac, 6);
+        s->state = SCAN_LEARNING;
+        s->last_id = packet_id;
+        s->last_ms = rx_ms;
+        scan->learning++;
+        scan->stats.observed++;
+
+        return 0;
+    }
+
+    dt_us = (rx_ms - s->last_ms) * 1000;
+    if (dt_us <= 0) {
+        return 0;
+    }
+
+    if (s->state == SCAN_LEARNING && packet_id < 0 &&
+        dt_us > (int64_t)scan->cfg.discovery_ms * 1000) {
+        /* Packets may have been missed in between: wait for a closer pair */
+        s->last_ms = rx_ms;
+        return 0;
+    }
+
+    gap = scan_gap(s, packet_id, dt_us);
+    if (gap == 0) {
+        return 0;
+    }
+
+    scan->stats.observed++;
+
+    if (s->state == SCAN_LEARNING) {
+        s->period_us = dt_us / gap;
+        s->dev_us = SCAN_INITIAL_DEV_US;
+        scan->learning--;
+        scan->stats.learned++;
+    } else {
+        err = dt_us - gap * s->period_us;
+
+        if (err > (int64_t)s->period_us * gap / 4 || -err > (int64_t)s->period_us * gap / 4) {
+            /* Interval changed or the packet count is off: start over */
+            s->period_us = dt_us / gap;
+            s->dev_us = SCAN_INITIAL_DEV_US;
+            scan->stats.relearned++;
+        } else {
+            s->period_us += err / (gap * SCAN_PERIOD_GAIN);
+            /* Jitter adds up over several periods, learn it from single ones */
+            if (gap == 1) {
+                s->dev_us += ((err < 0 ? -err : err) - (int64_t)s->dev_us) / SCAN_DEV_GAIN;
+                s->dev_us = MIN(s->dev_us, s->period_us / 8);
+            }
+        }
+
+        if (s->state == SCAN_TRACKING) {
+            scan->stats.predicted++;
+        }
+    }
+
+    s->state = SCAN_TRACKING;
+    s->misses = 0;
+    s->last_ms = rx_ms;
+    if (packet_id >= 0) {
+        s->last_id = packet_id;
+    }
+
+    return 0;
+}
+
+/* Window around the n-th expected packet, wider for every period in between */
+static void scan_sensor_window(const struct bthome_scan *scan,
+                               const struct bthome_scan_sensor *s, int64_t n,
+                               int64_t *start, int64_t *end)
+{
+    int64_t expected = s->last_ms * 1000 + n * s->period_us;
+    int64_t margin = scan->cfg.guard_ms * 1000 + n * SCAN_DEV_FACTOR * s->dev_us;
+
+    *start = (expected - margin) / 1000;
+    *end = (expected + margin) / 1000 + 1;
+}
+
+/*
+ * Count the windows of a tracked sensor that passed without a packet.
+ * Returns false once the sensor is lost.
+ */
+static bool scan_sensor_settle(struct bthome_scan *scan, struct bthome_scan_sensor *s,
+                               int64_t now)
+{
+    int64_t start, end;
+
+    while (true) {
+        scan_sensor_window(scan, s, s->misses + 1, &start, &end);
+        if (end + SCAN_REPORT_DELAY_MS > now) {
+            return true;
+        }
+
+        s->misses++;
+        scan->stats.misses++;
+
+        if (s->misses > scan->cfg.max_misses) {
+            s->state = SCAN_LOST;
+            scan->stats.lost++;
+            return false;
+        }
+    }
+}
+
+/* First window of a tracked sensor that has not ended at now */
+static void scan_sensor_next(const struct bthome_scan *scan, const struct bthome_scan_sensor *s,
+                             int64_t now, int64_t *start, int64_t *end)
+{
+    int64_t n = s->misses + 1;
+
+    do {
+        scan_sensor_window(scan, s, n++, start, end);
+    } while (*end <= now);
+}
+
+/* End of the current discovery window, extended while sensors still learn */
+static int64_t scan_discovery_end(const struct bthome_scan *scan)
+{
+    uint32_t len = scan->cfg.discovery_ms;
+
+    return scan->discovery_ms + (scan->learning ? 2 * len : len);
+}
+
+int bthome_scan_next(struct bthome_scan *scan, int64_t now_ms, struct bthome_scan_window *win)
+{
+    int64_t start = INT64_MAX;
+    int64_t end = INT64_MAX;
+    int64_t s_start, s_end;
+    bool merged;
+
+    while (scan->discovery_ms != INT64_MAX && scan_discovery_end(scan) <= now_ms) {
+        scan->discovery_ms = scan->cfg.discovery_interval_ms ?
+                             scan->discovery_ms + scan->cfg.discovery_interval_ms :
+                             INT64_MAX;
+    }
+
+    if (scan->discovery_ms != INT64_MAX) {
+        start = MAX(scan->discovery_ms, now_ms);
+        end = scan_discovery_end(scan);
+    }
+
+    /* Earliest window */
+    for (size_t i = 0; i < scan->num_sensors; i++) {
+        struct bthome_scan_sensor *s = &scan->sensors[i];
+
+        if (s->state != SCAN_TRACKING || !scan_sensor_settle(scan, s, now_ms)) {
+            continue;
+        }
+
+        scan_sensor_next(scan, s, now_ms, &s_start, &s_end);
+        s_start = MAX(s_start, now_ms);
+        if (s_start < start) {
+            start = s_start;
+            end = s_end;
+        }
+    }
+
+    if (start == INT64_MAX) {
+        return -ENOENT;
+    }
+
+    /* Absorb windows that overlap or follow closely, until none is left */
+    do {
+        merged = false;
+
+        if (scan->discovery_ms != INT64_MAX && scan->discovery_ms <= end + scan->cfg.merge_ms &&
+            scan_discovery_end(scan) > end) {
+            end = scan_discovery_end(scan);
+            merged = true;
+        }
+
+        for (size_t i = 0; i < scan->num_sensors; i++) {
+            struct bthome_scan_sensor *s = &scan->sensors[i];
+
+            if (s->state != SCAN_TRACKING) {
+                continue;
+            }
+
+            scan_sensor_next(scan, s, now_ms, &s_start, &s_end);
+            if (s_start <= end + scan->cfg.merge_ms && s_end > end) {
+                end = s_end;
+                merged = true;
+            }
+        }
+    } while (merged);
+
+    win->start_ms = start;
+    win->end_ms = end;
+    win->discovery = scan->discovery_ms < end && scan_discovery_end(scan) > start;
+
+    return 0;
+}
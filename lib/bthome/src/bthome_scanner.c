@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/bthome/scanner.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include "bthome_workq.h"
+
+LOG_MODULE_DECLARE(bthome, CONFIG_BTHOME_LOG_LEVEL);
+
+static void scanner_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(scanner_work, scanner_work_handler);
+
+static struct bthome_scan_sensor scanner_sensors[CONFIG_BTHOME_SCANNER_MAX_SENSORS];
+static struct bthome_scan scanner_scan;
+static struct bthome_scanner_config scanner_cfg;
+static struct bthome_scanner_stats scanner_stats;
+static struct k_spinlock scanner_lock;
+static bool running;
+static bool scanning;                   /* Work item and stop only */
+static bool pinned;                     /* Listen on channel 37 only */
+static int64_t scan_start_ms;
+
+/*
+ * Longest scan interval. With the window equal to it, the controller
+ * stays on the first channel of a scan for SCANNER_PIN_MS.
+ */
+#define SCANNER_PIN_INTERVAL    0x4000
+#define SCANNER_PIN_MS          10240
+
+/* Interval equal to the window: scan all the time while a window is open */
+static struct bt_le_scan_param scanner_param = {
+    .type = BT_LE_SCAN_TYPE_PASSIVE,
+    .options = BT_LE_SCAN_OPT_NONE,
+    .interval = BT_GAP_SCAN_FAST_INTERVAL,
+    .window = BT_GAP_SCAN_FAST_INTERVAL,
+};
+
+struct scanner_svc_data {
+    const uint8_t *data;
+    uint8_t len;
+};
+
+static bool scanner_parse_ad(struct bt_data *data, void *user_data)
+{
+    struct scanner_svc_data *svc = user_data;
+
+    if (data->type == BT_DATA_SVC_DATA16 && data->data_len >= 3 &&
+        sys_get_le16(data->data) == BTHOME_SERVICE_UUID) {
+        svc->data = data->data;
+        svc->len = data->data_len;
+        return false;
+    }
+
+    return true;
+}
+
+static void scanner_device_found(const bt_addr_le_t *addr, int8_t rssi, uint8_t type,
+                                 struct net_buf_simple *ad)
+{
+    /* Scan callbacks run one at a time in the Bluetooth RX thread */
+    static struct bthome_packet pkt;
+    struct scanner_svc_data svc = { 0 };
+    const struct bthome_object *id;
+    k_spinlock_key_t key;
+    int ret = 0;
+    int err;
+
+    ARG_UNUSED(type);
+
+    bt_data_parse(ad, scanner_parse_ad, &svc);
+    if (!svc.data) {
+        return;
+    }
+
+    err = bthome_decode(svc.data, svc.len, addr->a.val,
+                        scanner_cfg.key ? scanner_cfg.key(addr) : NULL, &pkt);
+
+    key = k_spin_lock(&scanner_lock);
+    if (err) {
+        scanner_stats.errors++;
+    } else {
+        id = bthome_packet_find(&pkt, BTHOME_ID_PACKET);
+        scanner_stats.received++;
+        ret = bthome_scan_observe(&scanner_scan, addr->a.val, id ? (int)id->raw : -1,
+                                  k_uptime_get());
+    }
+    k_spin_unlock(&scanner_lock, key);
+
+    if (err) {
+        LOG_DBG("Decode failed: %d", err);
+        return;
+    }
+
+    if (ret == -ENOMEM) {
+        LOG_WRN_ONCE("Scan sensor table full, raise CONFIG_BTHOME_SCANNER_MAX_SENSORS");
+    }
+
+    if (scanner_cfg.cb) {
+        scanner_cfg.cb(addr, rssi, &pkt);
+    }
+}
+
+static void scanner_radio_off(int64_t now)
+{
+    k_spinlock_key_t key;
+    int err;
+
+    if (!scanning) {
+        return;
+    }
+
+    err = bt_le_scan_stop();
+    if (err) {
+        LOG_ERR("Scan stop failed: %d", err);
+    }
+
+    scanning = false;
+
+    key = k_spin_lock(&scanner_lock);
+    scanner_stats.scan_ms += now - scan_start_ms;
+    k_spin_unlock(&scanner_lock, key);
+}
+
+static void scanner_radio_on(int64_t now)
+{
+    k_spinlock_key_t key;
+    int err;
+
+    if (scanning && !(pinned && now - scan_start_ms >= SCANNER_PIN_MS)) {
+        return;
+    }
+
+    /* A new scan starts over on the first channel */
+    scanner_radio_off(now);
+
+    err = bt_le_scan_start(&scanner_param, scanner_device_found);
+    if (err) {
+        LOG_ERR("Scan start failed: %d", err);
+        return;
+    }
+
+    scanning = true;
+    scan_start_ms = now;
+
+    key = k_spin_lock(&scanner_lock);
+    scanner_stats.windows++;
+    k_spin_unlock(&scanner_lock, key);
+}
+
+/* Runs at every window edge and decides whether the radio is on until the next one */
+static void scanner_work_handler(struct k_work *work)
+{
+    struct bthome_scan_window win;
+    int64_t now = k_uptime_get();
+    k_spinlock_key_t key;
+    int err;
+
+    ARG_UNUSED(work);
+
+    key = k_spin_lock(&scanner_lock);
+    err = running ? bthome_scan_next(&scanner_scan, now, &win) : -ECANCELED;
+    k_spin_unlock(&scanner_lock, key);
+
+    if (err == -ECANCELED) {
+        return;
+    }
+
+    if (err) {
+        /* Only a new start brings sensors back: let it through */
+        LOG_WRN("No sensor tracked and no discovery window due");
+        scanner_radio_off(now);
+        key = k_spin_lock(&scanner_lock);
+        running = false;
+        k_spin_unlock(&scanner_lock, key);
+        return;
+    }
+
+    if (win.start_ms > now) {
+        scanner_radio_off(now);
+        k_work_reschedule_for_queue(BTHOME_WORKQ, &scanner_work, K_MSEC(win.start_ms - now));
+        return;
+    }
+
+    /* The window may grow with packets received meanwhile: ask again at its end */
+    scanner_radio_on(now);
+    if (pinned && scanning) {
+        win.end_ms = MIN(win.end_ms, scan_start_ms + SCANNER_PIN_MS);
+    }
+    k_work_reschedule_for_queue(BTHOME_WORKQ, &scanner_work, K_MSEC(win.end_ms - now));
+}
+
+int bthome_scanner_start(const struct bthome_scanner_config *cfg)
+{
+    k_spinlock_key_t key;
+    int err;
+
+    if (!cfg || cfg->channels & ~BTHOME_ADV_CHAN_ALL) {
+        return -EINVAL;
+    }
+
+    if (cfg->channels && cfg->channels != BTHOME_ADV_CHAN_ALL &&
+        !(cfg->channels & BTHOME_ADV_CHAN_37)) {
+        return -ENOTSUP;
+    }
+
+    key = k_spin_lock(&scanner_lock);
+    if (running) {
+        k_spin_unlock(&scanner_lock, key);
+        return -EALREADY;
+    }
+
+    err = bthome_scan_init(&scanner_scan, &cfg->predict, scanner_sensors,
+                           ARRAY_SIZE(scanner_sensors));
+    if (!err) {
+        /* First discovery window from now, not from boot */
+        scanner_scan.discovery_ms = k_uptime_get();
+        scanner_cfg = *cfg;
+        memset(&scanner_stats, 0, sizeof(scanner_stats));
+        pinned = cfg->channels && cfg->channels != BTHOME_ADV_CHAN_ALL;
+        scanner_param.interval = pinned ? SCANNER_PIN_INTERVAL : BT_GAP_SCAN_FAST_INTERVAL;
+        scanner_param.window = scanner_param.interval;
+        running = true;
+    }
+    k_spin_unlock(&scanner_lock, key);
+
+    if (err) {
+        return err;
+    }
+
+    k_work_reschedule_for_queue(BTHOME_WORKQ, &scanner_work, K_NO_WAIT);
+
+    return 0;
+}
+
+int bthome_scanner_stop(void)
+{
+    struct k_work_sync sync;
+    k_spinlock_key_t key;
+
+    key = k_spin_lock(&scanner_lock);
+    if (!running) {
+        k_spin_unlock(&scanner_lock, key);
+        return -EALREADY;
+    }
+    running = false;
+    k_spin_unlock(&scanner_lock, key);
+
+    k_work_cancel_delayable_sync(&scanner_work, &sync);
+    scanner_radio_off(k_uptime_get());
+
+    return 0;
+}
+
+void bthome_scanner_get_stats(struct bthome_scanner_stats *stats)
+{
+    k_spinlock_key_t key = k_spin_lock(&scanner_lock);
+
+    *stats = scanner_stats;
+    stats->predict = scanner_scan.stats;
+    k_spin_unlock(&scanner_lock, key);
+}
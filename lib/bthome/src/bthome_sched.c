@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/bthome/sched.h>
+#include <bthome_codec.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(bthome, CONFIG_BTHOME_LOG_LEVEL);
+
+static void bthome_sched_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(sched_work, bthome_sched_work_handler);
+
+static struct bthome_sched_task *tasks[CONFIG_BTHOME_SCHED_MAX_TASKS];
+static struct k_spinlock sched_lock;
+static uint32_t wakeups;
+static int64_t slot_epoch;
+
+/*
+ * Next wake-up: the latest instant at which no task has exceeded its
+ * slack yet. Every task whose window [due - slack, due + slack] has
+ * opened by then runs in the same wake-up.
+ */
+static int64_t bthome_sched_next_wakeup(void)
+{
+    int64_t next = INT64_MAX;
+
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++) {
+        if (tasks[i]) {
+            next = MIN(next, tasks[i]->next_due + tasks[i]->slack_ms);
+        }
+    }
+
+    return next;
+}
+
+static void bthome_sched_reschedule(void)
+{
+    int64_t next = bthome_sched_next_wakeup();
+    int64_t now = k_uptime_get();
+
+    if (next == INT64_MAX) {
+        k_work_cancel_delayable(&sched_work);
+        return;
+    }
+
+    k_work_reschedule(&sched_work, K_MSEC(MAX(next - now, 0)));
+}
+
+static void bthome_sched_work_handler(struct k_work *work)
+{
+    struct bthome_sched_task *due[CONFIG_BTHOME_SCHED_MAX_TASKS];
+    size_t num_due = 0;
+    k_spinlock_key_t key;
+    int64_t now;
+
+    ARG_UNUSED(work);
+
+    wakeups++;
+    now = k_uptime_get();
+
+    key = k_spin_lock(&sched_lock);
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++) {
+        struct bthome_sched_task *task = tasks[i];
+
+        if (!task || task->next_due - task->slack_ms > now) {
+            continue;
+        }
+
+        due[num_due++] = task;
+
+        /* Keep the nominal phase, resync only after a long stall */
+        task->next_due += task->period_ms;
+        if (task->next_due + task->slack_ms < now) {
+            task->next_due = now + task->period_ms;
+        }
+    }
+    k_spin_unlock(&sched_lock, key);
+
+    for (size_t i = 0; i < num_due; i++) {
+        due[i]->handler(due[i]);
+    }
+
+    key = k_spin_lock(&sched_lock);
+    bthome_sched_reschedule();
+    k_spin_unlock(&sched_lock, key);
+
+    LOG_DBG("Scheduler wake-up %u ran %u task(s)", wakeups, num_due);
+}
+
+int bthome_sched_add(struct bthome_sched_task *task, uint32_t delay_ms)
+{
+    k_spinlock_key_t key;
+    int free_slot = -1;
+
+    if (!task || !task->handler || task->period_ms == 0) {
+        return -EINVAL;
+    }
+
+    key = k_spin_lock(&sched_lock);
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++) {
+        if (tasks[i] == task) {
+            k_spin_unlock(&sched_lock, key);
+            return -EALREADY;
+        }
+        if (!tasks[i] && free_slot < 0) {
+            free_slot = i;
+        }
+    }
+
+    if (free_slot < 0) {
+        k_spin_unlock(&sched_lock, key);
+        return -ENOMEM;
+    }
+
+    task->next_due = k_uptime_get() + delay_ms;
+    task->slotted = false;
+    tasks[free_slot] = task;
+    bthome_sched_reschedule();
+    k_spin_unlock(&sched_lock, key);
+
+    return 0;
+}
+
+uint32_t bthome_sched_slot(const uint8_t addr[6], uint32_t slots)
+{
+    /* Stable across reboots with a fixed MAC */
+    return bthome_mac_hash(addr) % slots;
+}
+
+/* First instant from now with (t - epoch) % period == phase */
+static int64_t bthome_sched_slot_due(const struct bthome_sched_task *task, int64_t now)
+{
+    int64_t since_epoch = now - slot_epoch;
+    int64_t delay;
+
+    delay = task->phase_ms -
+            (((since_epoch % task->period_ms) + task->period_ms) % task->period_ms);
+    if (delay < 0) {
+        delay += task->period_ms;
+    }
+
+    return now + delay;
+}
+
+int bthome_sched_add_slotted(struct bthome_sched_task *task, uint32_t slot_ms)
+{
+    bt_addr_le_t addrs[CONFIG_BT_ID_MAX];
+    size_t count = ARRAY_SIZE(addrs);
+    uint32_t slots;
+    int64_t now;
+    int err;
+
+    if (!task || slot_ms == 0 || slot_ms > task->period_ms) {
+        return -EINVAL;
+    }
+
+    bt_id_get(addrs, &count);
+    if (count == 0) {
+        return -EAGAIN;
+    }
+
+    slots = task->period_ms / slot_ms;
+    task->phase_ms = bthome_sched_slot(addrs[BT_ID_DEFAULT].a.val, slots) * slot_ms;
+
+    LOG_INF("Slotted task: slot %u of %u, phase %u ms", task->phase_ms / slot_ms, slots,
+            task->phase_ms);
+
+    now = k_uptime_get();
+    err = bthome_sched_add(task, (uint32_t)(bthome_sched_slot_due(task, now) - now));
+    if (err) {
+        return err;
+    }
+
+    /* Follows later epoch changes */
+    task->slotted = true;
+
+    return 0;
+}
+
+void bthome_sched_set_epoch(int64_t epoch_ms)
+{
+    k_spinlock_key_t key;
+    int64_t now = k_uptime_get();
+
+    key = k_spin_lock(&sched_lock);
+    slot_epoch = epoch_ms;
+
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++) {
+        if (tasks[i] && tasks[i]->slotted) {
+            tasks[i]->next_due = bthome_sched_slot_due(tasks[i], now);
+        }
+    }
+
+    bthome_sched_reschedule();
+    k_spin_unlock(&sched_lock, key);
+}
+
+void bthome_sched_set_time(uint64_t unix_ms)
+{
+    bthome_sched_set_epoch(k_uptime_get() - (int64_t)unix_ms);
+}
+
+int bthome_sched_remove(struct bthome_sched_task *task)
+{
+    k_spinlock_key_t key;
+    int err = -ENOENT;
+
+    key = k_spin_lock(&sched_lock);
+    for (size_t i = 0; i < ARRAY_SIZE(tasks); i++) {
+        if (tasks[i] == task) {
+            tasks[i] = NULL;
+            err = 0;
+            break;
+        }
+    }
+
+    if (err == 0) {
+        bthome_sched_reschedule();
+    }
+    k_spin_unlock(&sched_lock, key);
+
+    return err;
+}
+
+uint32_t bthome_sched_wakeups(void)
+{
+    return wakeups;
+}
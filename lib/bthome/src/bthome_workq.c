@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+
+#include "bthome_workq.h"
+
+K_THREAD_STACK_DEFINE(bthome_workq_stack, CONFIG_BTHOME_WORKQ_STACK_SIZE);
+
+struct k_work_q bthome_work_q;
+
+static int bthome_workq_init(void)
+{
+    const struct k_work_queue_config cfg = {
+        .name = "bthome_workq",
+        .no_yield = true,
+    };
+
+    k_work_queue_start(&bthome_work_q, bthome_workq_stack,
+                       K_THREAD_STACK_SIZEOF(bthome_workq_stack),
+                       CONFIG_BTHOME_WORKQ_PRIORITY, &cfg);
+
+    return 0;
+}
+
+SYS_INIT(bthome_workq_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
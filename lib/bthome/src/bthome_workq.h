@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2025 BTHome v2 for Zephyr
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BTHOME_WORKQ_H_
+#define BTHOME_WORKQ_H_
+
+#include <zephyr/kernel.h>
+
+/* Queue running the library's own work items (advertising timeout, scan windows) */
+#if defined(CONFIG_BTHOME_WORKQ)
+extern struct k_work_q bthome_work_q;
+#define BTHOME_WORKQ (&bthome_work_q)
+#else
+#define BTHOME_WORKQ (&k_sys_work_q)
+#endif
+
+#endif /* BTHOME_WORKQ_H_ */
@@ -0,0 +1,23 @@
+# Copyright (c) 2025 BTHome v2 for Zephyr
+# SPDX-License-Identifier: Apache-2.0
+#
+# Adds the hci_ipc controller image for the network core, included from the
+# sysbuild.cmake of the BTHome applications.
+
+if(SB_CONFIG_NET_CORE_IMAGE_HCI_IPC)
+    set(NET_APP hci_ipc)
+
+    ExternalZephyrProject_Add(
+        APPLICATION ${NET_APP}
+        SOURCE_DIR  ${ZEPHYR_BASE}/samples/bluetooth/${NET_APP}
+        BOARD       ${SB_CONFIG_NET_CORE_BOARD}
+    )
+
+    # Legacy advertising only, as used by the BTHome library
+    set_property(TARGET ${NET_APP} APPEND_STRING PROPERTY CONFIG
+                 "CONFIG_BT_CTLR_ADV_EXT=n\n")
+
+    native_simulator_set_child_images(${DEFAULT_IMAGE} ${NET_APP})
+endif()
+
+native_simulator_set_final_executable(${DEFAULT_IMAGE})
@@ -9,6 +9,16 @@
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/bthome/sched.h>
+#if defined(CONFIG_BTHOME_PULSE_COUNTER)
+#include <zephyr/bthome/pulse_counter.h>
+#endif
+#if defined(CONFIG_BTHOME_PULSE_RATE)
+#include <zephyr/bthome/pulse_rate.h>
+
+/* S0 energy meter constant (impulses per kWh) */
+#define METER_PULSES_PER_KWH 1000
+#endif
 
 LOG_MODULE_REGISTER(bthome_counter, LOG_LEVEL_INF);
 
@@ -19,8 +29,24 @@ static const struct gpio_dt_spec led1 = GPIO_DT_SPEC_GET(LED1_NODE, gpios);
 /* BTHome device instance */
 static struct bthome_device bthome_dev;
 
+#if !defined(CONFIG_BTHOME_PULSE_COUNTER)
 /* Counter state */
 static uint16_t counter_value = 0;
+#endif
+
+/* Periodic activities, aligned to shared wake-ups by the scheduler */
+#define COUNTER_PERIOD_MS   5000
+#define HEARTBEAT_PERIOD_MS 10000
+
+static void counter_task_handler(struct bthome_sched_task *task);
+static void heartbeat_task_handler(struct bthome_sched_task *task);
+
+static struct bthome_sched_task counter_task =
+    BTHOME_SCHED_TASK_INIT(counter_task_handler, COUNTER_PERIOD_MS, 0);
+/* Heartbeat has no deadline, it always rides on a counter wake-up */
+static struct bthome_sched_task heartbeat_task =
+    BTHOME_SCHED_TASK_INIT(heartbeat_task_handler, HEARTBEAT_PERIOD_MS,
+                           COUNTER_PERIOD_MS / 2);
 
 /* Bluetooth ready callback */
 static void bt_ready(int err)
@@ -31,13 +57,32 @@ static void bt_ready(int err)
     }
 
     LOG_INF("Bluetooth initialized");
+
+    /* Queue the first advertisement as soon as the stack is up */
+    bthome_sched_add(&counter_task, 0);
+    bthome_sched_add(&heartbeat_task, HEARTBEAT_PERIOD_MS);
 }
 
-/* Work handler for periodic counter updates */
-static void counter_work_handler(struct k_work *work);
-static K_WORK_DELAYABLE_DEFINE(counter_work, counter_work_handler);
+/* Value sent in the packet: hardware pulse count or software counter */
+static uint32_t counter_current(void)
+{
+#if defined(CONFIG_BTHOME_PULSE_COUNTER)
+    uint32_t count = 0;
+
+    (void)bthome_pulse_counter_read(&count);
+    return count;
+#else
+    return counter_value;
+#endif
+}
 
-static void counter_work_handler(struct k_work *work)
+static void heartbeat_task_handler(struct bthome_sched_task *task)
+{
+    LOG_INF("System running, current counter: %u, wake-ups: %u",
+            counter_current(), bthome_sched_wakeups());
+}
+
+static void counter_task_handler(struct bthome_sched_task *task)
 {
     int err;
 
@@ -47,6 +92,24 @@ static void counter_work_handler(struct k_work *work)
     /* Reset measurements for new packet */
     bthome_reset_measurements(&bthome_dev);
 
+#if defined(CONFIG_BTHOME_PULSE_COUNTER)
+    /* Read the hardware pulse count (32-bit), no CPU work per pulse */
+    err = bthome_pulse_counter_add(&bthome_dev);
+    if (err) {
+        LOG_ERR("Failed to add pulse count: %d", err);
+        goto cleanup;
+    }
+
+#if defined(CONFIG_BTHOME_PULSE_RATE)
+    /* Instantaneous power and energy total from pulse timestamps */
+    bthome_pulse_rate_update();
+    err = bthome_pulse_rate_add_power(&bthome_dev);
+    if (err) {
+        LOG_ERR("Failed to add power: %d", err);
+        goto cleanup;
+    }
+#endif
+#else
     /* Increment counter */
     counter_value++;
 
@@ -56,6 +119,7 @@ static void counter_work_handler(struct k_work *work)
         LOG_ERR("Failed to add counter: %d", err);
         goto cleanup;
     }
+#endif
 
     /* Send advertisement */
     err = bthome_advertise(&bthome_dev, 1500);  /* Advertise for 1.5 seconds */
@@ -64,15 +128,12 @@ static void counter_work_handler(struct k_work *work)
         goto cleanup;
     }
 
-    LOG_INF("BTHome advertisement sent: Counter = %u", counter_value);
+    LOG_INF("BTHome advertisement sent: Counter = %u", counter_current());
 
 cleanup:
     /* LED off after short delay */
     k_sleep(K_MSEC(100));
     gpio_pin_set_dt(&led1, 0);
-
-    /* Schedule next advertisement in 5 seconds */
-    k_work_schedule(&counter_work, K_SECONDS(5));
 }
 
 int main(void)
@@ -101,12 +162,6 @@ int main(void)
 
     LOG_INF("LED1 initialized successfully");
 
-    /* Set fixed MAC address manually */
-    err = bthome_set_fixed_mac();
-    if (err) {
-        LOG_WRN("Failed to set fixed MAC: %d", err);
-    }
-
     /* Initialize BTHome device */
     err = bthome_init(&bthome_dev, &config);
     if (err) {
@@ -114,28 +169,37 @@ int main(void)
         return -1;
     }
 
-    /* Initialize Bluetooth */
-    err = bt_enable(bt_ready);
+#if defined(CONFIG_BTHOME_PULSE_COUNTER)
+    /* Start counting meter pulses in hardware */
+    err = bthome_pulse_counter_init();
     if (err) {
-        LOG_ERR("Bluetooth init failed (err %d)", err);
+        LOG_ERR("Failed to initialize pulse counter: %d", err);
         return -1;
     }
 
-    /* Wait for Bluetooth to be ready */
-    k_sleep(K_SECONDS(2));
+#if defined(CONFIG_BTHOME_PULSE_RATE)
+    err = bthome_pulse_rate_init(&(struct bthome_pulse_rate_config) {
+        .pulses_per_unit = METER_PULSES_PER_KWH,
+    });
+    if (err) {
+        LOG_ERR("Failed to initialize pulse rate: %d", err);
+        return -1;
+    }
+#endif
+#endif
 
-    /* Start periodic counter updates */
-    k_work_schedule(&counter_work, K_SECONDS(3));
+    /* Initialize Bluetooth, bt_ready() starts the periodic updates.
+     * The fixed MAC was already applied by CONFIG_BTHOME_AUTO_MAC.
+     */
+    err = bt_enable(bt_ready);
+    if (err) {
+        LOG_ERR("Bluetooth init failed (err %d)", err);
+        return -1;
+    }
 
     LOG_INF("BTHome Counter is running...");
     LOG_INF("Sending counter values every 5 seconds");
     LOG_INF("Use nRF Connect or Home Assistant to receive BTHome data");
 
-    /* Main loop */
-    while (1) {
-        k_sleep(K_SECONDS(10));
-        LOG_INF("System running, current counter: %u", counter_value);
-    }
-
     return 0;
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/bthome/sched.h>
 
 LOG_MODULE_REGISTER(bthome_lowpower, LOG_LEVEL_WRN);  /* Minimal logging for power savings */
 
@@ -34,6 +35,19 @@ static uint16_t counter_value = 0;
 /* Power management state */
 static bool bluetooth_ready = false;
 
+/* Heartbeat logging interval, merged into advertising wake-ups */
+#define HEARTBEAT_INTERVAL_SEC (ADV_INTERVAL_SEC + 5)
+
+/* Periodic activities, aligned to shared wake-ups by the scheduler */
+static void counter_task_handler(struct bthome_sched_task *task);
+static void heartbeat_task_handler(struct bthome_sched_task *task);
+
+static struct bthome_sched_task counter_task =
+    BTHOME_SCHED_TASK_INIT(counter_task_handler, ADV_INTERVAL_SEC * 1000, 0);
+static struct bthome_sched_task heartbeat_task =
+    BTHOME_SCHED_TASK_INIT(heartbeat_task_handler, HEARTBEAT_INTERVAL_SEC * 1000,
+                           ADV_INTERVAL_SEC * 1000 / 2);
+
 /* Bluetooth ready callback */
 static void bt_ready(int err)
 {
@@ -44,33 +58,26 @@ static void bt_ready(int err)
 
     bluetooth_ready = true;
     LOG_WRN("Bluetooth initialized");
-}
 
-/* Work handler for periodic counter updates */
-static void counter_work_handler(struct k_work *work);
-static K_WORK_DELAYABLE_DEFINE(counter_work, counter_work_handler);
+    /* Queue the first advertisement as soon as the stack is up */
+    bthome_sched_add(&counter_task, 0);
+    bthome_sched_add(&heartbeat_task, HEARTBEAT_INTERVAL_SEC * 1000);
+}
 
-static void enter_deep_sleep(void)
+static void heartbeat_task_handler(struct bthome_sched_task *task)
 {
-    LOG_WRN("Entering deep sleep for %d seconds", ADV_INTERVAL_SEC);
-    
-#if HAS_LED
-    /* Turn off LED before sleep */
-    gpio_pin_set_dt(&led1, 0);
-#endif
-
-    /* Use basic k_sleep for long sleep periods */
-    /* On nRF52840, this will automatically enter low power modes */
-    k_sleep(K_SECONDS(ADV_INTERVAL_SEC - 3));  /* Sleep most of the time, leave 3s for processing */
+    /* Moderate heartbeat logging */
+    LOG_WRN("System heartbeat, counter: %u, wake-ups: %u",
+            counter_value, bthome_sched_wakeups());
 }
 
-static void counter_work_handler(struct k_work *work)
+static void counter_task_handler(struct bthome_sched_task *task)
 {
     int err;
 
     if (!bluetooth_ready) {
         LOG_ERR("Bluetooth not ready, skipping advertisement");
-        goto schedule_next;
+        return;
     }
 
 #if HAS_LED
@@ -107,12 +114,7 @@ cleanup:
     gpio_pin_set_dt(&led1, 0);
 #endif
 
-    /* Enter deep sleep mode for power savings */
-    enter_deep_sleep();
-
-schedule_next:
-    /* Schedule next advertisement */
-    k_work_schedule(&counter_work, K_SECONDS(3));  /* Small delay before next cycle */
+    /* The CPU idles in low power mode until the next scheduler wake-up */
 }
 
 int main(void)
@@ -145,12 +147,6 @@ int main(void)
     LOG_WRN("LED disabled for power savings");
 #endif
 
-    /* Set fixed MAC address manually */
-    err = bthome_set_fixed_mac();
-    if (err) {
-        LOG_WRN("Failed to set fixed MAC: %d", err);
-    }
-
     /* Initialize BTHome device */
     err = bthome_init(&bthome_dev, &config);
     if (err) {
@@ -158,30 +154,17 @@ int main(void)
         return -1;
     }
 
-    /* Initialize Bluetooth */
+    /* Initialize Bluetooth, bt_ready() starts the periodic updates.
+     * The fixed MAC was already applied by CONFIG_BTHOME_AUTO_MAC.
+     */
     err = bt_enable(bt_ready);
     if (err) {
         LOG_ERR("Bluetooth init failed (err %d)", err);
         return -1;
     }
 
-    /* Wait for Bluetooth to be ready */
-    k_sleep(K_SECONDS(2));
-
-    /* Start periodic counter updates */
-    k_work_schedule(&counter_work, K_SECONDS(3));
-
     LOG_WRN("BTHome Low-Power Counter is running...");
     LOG_WRN("Sending counter values every %d seconds", ADV_INTERVAL_SEC);
 
-    /* Main loop - just sleep and let work handler do everything */
-    while (1) {
-        /* Sleep for a moderate time, wake up only for work items */
-        k_sleep(K_SECONDS(ADV_INTERVAL_SEC + 5));  /* Sleep a bit longer than one cycle */
-        
-        /* Moderate heartbeat logging */
-        LOG_WRN("System heartbeat, counter: %u", counter_value);
-    }
-
     return 0;
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <bthome.h>
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/bthome/sched.h>
 
 /* Use static variables for pseudo-retained data (resets on reboot) */
 static struct retained_data {
@@ -35,34 +36,32 @@ static struct bthome_device bthome_dev;
 /* Power management state */
 static bool bluetooth_ready = false;
 
+/* Ultra-efficient counter updates, the only wake-up source */
+static void counter_task_handler(struct bthome_sched_task *task);
+static struct bthome_sched_task counter_task =
+    BTHOME_SCHED_TASK_INIT(counter_task_handler, ADV_INTERVAL_SEC * 1000, 0);
+
 /* Bluetooth ready callback - minimal */
 static void bt_ready(int err)
 {
     bluetooth_ready = (err == 0);
+    if (bluetooth_ready) {
+        /* Announce the node right after boot, the slot may be a full
+         * cycle away
+         */
+        counter_task_handler(&counter_task);
+
+        /* Then advertise in this node's slot of the cycle, so that many
+         * counters powered up together do not collide on air
+         */
+        bthome_sched_add_slotted(&counter_task, ADV_DURATION_MS);
+    }
 }
 
-/* Work handler for ultra-efficient counter updates */
-static void counter_work_handler(struct k_work *work);
-static K_WORK_DELAYABLE_DEFINE(counter_work, counter_work_handler);
-
-static void enter_ultra_deep_sleep(void)
-{
-#if HAS_LED
-    /* Turn off LED completely */
-    gpio_pin_set_dt(&led1, 0);
-#endif
-
-    /* Ultra long sleep for maximum power savings */
-    /* On nRF52840, k_sleep automatically uses lowest power mode */
-    k_sleep(K_SECONDS(ADV_INTERVAL_SEC - 2));
-}
-
-static void counter_work_handler(struct k_work *work)
+static void counter_task_handler(struct bthome_sched_task *task)
 {
-    int err;
-
     if (!bluetooth_ready) {
-        goto schedule_next;
+        return;
     }
 
 #if HAS_LED
@@ -79,24 +78,14 @@ static void counter_work_handler(struct k_work *work)
     retained.counter_value++;
 
     /* Add counter measurement (16-bit) */
-    err = bthome_add_sensor(&bthome_dev, BTHOME_ID_COUNT2, retained.counter_value);
-    if (err) {
-        goto cleanup;
+    if (bthome_add_sensor(&bthome_dev, BTHOME_ID_COUNT2, retained.counter_value)) {
+        return;
     }
 
-    /* Ultra short advertisement */
-    err = bthome_advertise(&bthome_dev, ADV_DURATION_MS);
-    if (err) {
-        goto cleanup;
-    }
-
-cleanup:
-    /* Enter ultra deep sleep immediately */
-    enter_ultra_deep_sleep();
-
-schedule_next:
-    /* Schedule next advertisement */
-    k_work_schedule(&counter_work, K_SECONDS(2));
+    /* Ultra short advertisement, then idle in the lowest power mode
+     * until the next scheduler wake-up
+     */
+    bthome_advertise(&bthome_dev, ADV_DURATION_MS);
 }
 
 int main(void)
@@ -122,47 +111,34 @@ int main(void)
     /* Ultra minimal LED initialization */
     if (gpio_is_ready_dt(&led1)) {
         gpio_pin_configure_dt(&led1, GPIO_OUTPUT_INACTIVE);
-        /* Boot indicator - 3 quick flashes */
-        for (int i = 0; i < 3; i++) {
-            gpio_pin_set_dt(&led1, 1);
-            k_sleep(K_MSEC(100));
-            gpio_pin_set_dt(&led1, 0);
-            k_sleep(K_MSEC(100));
-        }
     }
 #endif
 
-    /* Set fixed MAC address */
-    err = bthome_set_fixed_mac();
-    if (err) {
-        /* No logging in ultra low power mode - just continue */
-    }
-
     /* Initialize BTHome device */
     err = bthome_init(&bthome_dev, &config);
     if (err) {
         return -1;
     }
 
-    /* Initialize Bluetooth with minimal delay */
+    /* Initialize Bluetooth, bt_ready() queues the first advertisement.
+     * The fixed MAC was already applied by CONFIG_BTHOME_AUTO_MAC.
+     */
     err = bt_enable(bt_ready);
     if (err) {
         return -1;
     }
 
-    /* Minimal wait for Bluetooth */
-    k_sleep(K_MSEC(500));
-
-    /* Start ultra low power counter updates */
-    k_work_schedule(&counter_work, K_SECONDS(1));
-
-    /* Ultra minimal main loop */
-    while (1) {
-        /* Sleep for very long periods */
-        k_sleep(K_SECONDS(60));
-        
-        /* No logging - just continue working */
+#if HAS_LED
+    /* Boot indicator - 3 quick flashes, overlapping Bluetooth init */
+    if (gpio_is_ready_dt(&led1)) {
+        for (int i = 0; i < 3; i++) {
+            gpio_pin_set_dt(&led1, 1);
+            k_sleep(K_MSEC(100));
+            gpio_pin_set_dt(&led1, 0);
+            k_sleep(K_MSEC(100));
+        }
     }
+#endif
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2025 BTHome HCI Traffic Benchmark
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <bthome.h>
+#include <zephyr/bluetooth/bluetooth.h>
+
+/* Readings per mode and reading period */
+#define READINGS            20
+#define READING_PERIOD_MS   1000
+#define ADV_DURATION_MS     200
+
+/* The counter value only changes on every Nth reading */
+#define CHANGE_EVERY        4
+
+static struct bthome_device bthome_dev;
+
+enum bench_mode {
+    MODE_BURST,             /* start + timed stop per reading */
+    MODE_CONTINUOUS,        /* advertise once, update data per reading */
+    MODE_ON_CHANGE,         /* advertise once, update data on change only */
+};
+
+static const char *const mode_names[] = {
+    [MODE_BURST] = "burst (start/stop)",
+    [MODE_CONTINUOUS] = "continuous (update)",
+    [MODE_ON_CHANGE] = "on change (update)",
+};
+
+static int fill_packet(uint16_t value)
+{
+    bthome_reset_measurements(&bthome_dev);
+    return bthome_add_sensor(&bthome_dev, BTHOME_ID_COUNT2, value);
+}
+
+static void run_mode(enum bench_mode mode)
+{
+    struct bthome_stats stats;
+    uint16_t value = 0;
+    uint16_t sent = UINT16_MAX;
+
+    bthome_reset_stats();
+
+    for (int i = 0; i < READINGS; i++) {
+        if (i % CHANGE_EVERY == 0) {
+            value++;
+        }
+
+        if (fill_packet(value)) {
+            return;
+        }
+
+        if (mode == MODE_BURST) {
+            bthome_advertise(&bthome_dev, ADV_DURATION_MS);
+        } else if (!bthome_is_advertising(&bthome_dev)) {
+            bthome_advertise(&bthome_dev, 0);
+            sent = value;
+        } else if (mode == MODE_CONTINUOUS || value != sent) {
+            bthome_publish(&bthome_dev);
+            sent = value;
+        }
+
+        k_sleep(K_MSEC(READING_PERIOD_MS));
+    }
+
+    bthome_stop_advertising(&bthome_dev);
+    bthome_get_stats(&stats);
+
+    /* Every command and its completion event cross the IPC link */
+    printk("%-20s starts %3u stops %3u updates %3u | est. HCI cmds %3u, "
+           "per reading %u.%02u, IPC wake-ups per reading %u.%02u\n",
+           mode_names[mode], stats.adv_starts, stats.adv_stops, stats.data_updates,
+           stats.hci_commands_est,
+           stats.hci_commands_est / READINGS, stats.hci_commands_est * 100 / READINGS % 100,
+           2 * stats.hci_commands_est / READINGS,
+           2 * stats.hci_commands_est * 100 / READINGS % 100);
+}
+
+int main(void)
+{
+    int err;
+    struct bthome_config config = {
+        .device_name = "BTHome Bench",
+        .encryption = false,
+        .trigger_based = false,
+    };
+
+    printk("BTHome HCI traffic benchmark on %s\n", CONFIG_BOARD_TARGET);
+
+    err = bthome_init(&bthome_dev, &config);
+    if (err) {
+        printk("BTHome init failed (err %d)\n", err);
+        return -1;
+    }
+
+    err = bt_enable(NULL);
+    if (err) {
+        printk("Bluetooth init failed (err %d)\n", err);
+        return -1;
+    }
+
+    printk("%d readings per mode, one every %d ms\n", READINGS, READING_PERIOD_MS);
+
+    run_mode(MODE_BURST);
+    run_mode(MODE_CONTINUOUS);
+    run_mode(MODE_ON_CHANGE);
+
+    printk("Benchmark done\n");
+
+    return 0;
+}
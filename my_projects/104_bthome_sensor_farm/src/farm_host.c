@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2025 BTHome Sensor Farm
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Runs in the native simulator runner, not in the Zephyr image: simulated
+ * time does not advance while code runs, so CPU cost is read from the host.
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+uint64_t farm_host_cpu_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
@@ -0,0 +1,740 @@
+/*
+ * Copyright (c) 2025 BTHome Sensor Farm
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/bthome/bthome.h>
+#include <zephyr/bthome/decode.h>
+#include <zephyr/bthome/scan.h>
+#include <zephyr/bthome/sched.h>
+#include <string.h>
+
+/*
+ * Simulated time only advances while threads sleep, so a run is exactly
+ * reproducible for a given seed. Gateway CPU cost is measured separately
+ * on the host.
+ */
+uint64_t farm_host_cpu_ns(void);
+
+#define SENSORS             CONFIG_FARM_SENSORS
+#define RUN_MS              (CONFIG_FARM_DURATION_S * 1000)
+#define ADV_DELAY_MAX_MS    10
+
+/* Service data: UUID + device info + payload (+ counter and MIC) */
+#define FRAME_MAX           (3 + BTHOME_MAX_PAYLOAD_SIZE)
+
+/*
+ * Bytes on air besides the service data: preamble, access address, PDU
+ * header, AdvA, flags, AD header and CRC. 8 us per byte on the 1M PHY.
+ */
+#define AIR_OVERHEAD        21
+#define AIR_US_PER_BYTE     8
+
+/* Sensors send at their nominal period, the advertising delay does not add up */
+#define PHASE_SCHEDULED     (IS_ENABLED(CONFIG_FARM_PHASE_BOOT) || \
+                             IS_ENABLED(CONFIG_FARM_PHASE_SLOTTED))
+
+/* Gateway device table, open addressing on the MAC */
+#define TABLE_SIZE          4096
+BUILD_ASSERT(TABLE_SIZE >= 2 * SENSORS, "device table too small");
+
+/* Queue latency histogram, 1 ms buckets, last one collects the rest */
+#define LAT_BUCKETS         256
+
+#define SENSOR_STACK_SIZE   2048
+#define GATEWAY_STACK_SIZE  2048
+#define SCAN_STACK_SIZE     2048
+
+/* Scan windows that follow within this are merged, saving a restart */
+#define SCAN_MERGE_MS       20
+
+enum schema {
+    SCHEMA_CLIMATE,         /* temperature, humidity, battery */
+    SCHEMA_METER,           /* power, energy */
+    SCHEMA_CONTACT,         /* window, battery */
+    SCHEMA_COUNTER,         /* 32-bit count */
+    SCHEMA_NAMED,           /* text, temperature */
+    SCHEMA_COUNT,
+};
+
+static const char *const schema_names[] = {
+    [SCHEMA_CLIMATE] = "climate",
+    [SCHEMA_METER] = "meter",
+    [SCHEMA_CONTACT] = "contact",
+    [SCHEMA_COUNTER] = "counter",
+    [SCHEMA_NAMED] = "named",
+};
+
+struct farm_sensor {
+    struct bthome_device dev;
+    uint8_t mac[6];                 /* bt_addr_t order */
+    enum schema schema;
+    uint32_t interval_ms;
+    int64_t nominal_ms;             /* scheduler due time, PHASE_SCHEDULED */
+    int64_t next_ms;
+    uint16_t next_us;               /* start within next_ms, FARM_COLLISIONS */
+    uint8_t packet_id;
+    uint32_t value;                 /* drifting base value of the schema */
+};
+
+/* One reception as handed from the radio to the gateway */
+struct farm_frame {
+    uint8_t mac[6];
+    uint8_t len;
+    uint8_t data[FRAME_MAX];
+    uint32_t rx_ms;
+};
+
+/* What the gateway knows about a sensor */
+struct gw_entry {
+    bool used;
+    uint8_t mac[6];
+    uint8_t key[16];
+    struct bthome_dedup dedup;
+};
+
+struct farm_stats {
+    uint32_t sent;                  /* packets encoded by sensors */
+    uint32_t air_lost;              /* packets no channel delivered */
+    uint32_t collided;              /* packets overlapping another one */
+    uint32_t unheard;               /* packets sent while not scanning */
+    uint32_t frames;                /* receptions offered to the gateway */
+    uint32_t queue_drops;
+    uint32_t decode_errors;
+    uint32_t unknown;
+    uint32_t duplicates;
+    uint32_t readings;              /* unique packets output */
+    uint32_t objects;
+    uint32_t output_bytes;
+    uint32_t queue_peak;
+    uint64_t lat_sum_ms;
+    uint32_t lat_max_ms;
+    uint32_t lat_hist[LAT_BUCKETS];
+    uint64_t cpu_ns;
+    uint32_t cpu_max_ns;
+    uint32_t scan_windows;
+    uint64_t scan_ms;
+    uint64_t discovery_ms;          /* part of scan_ms in discovery windows */
+};
+
+static struct farm_sensor sensors[SENSORS];
+static struct gw_entry table[TABLE_SIZE];
+static struct farm_stats stats;
+static atomic_t sensors_done;
+static uint32_t rng_state = CONFIG_FARM_SEED;
+
+/* Without predictive scheduling the gateway scans continuously */
+static bool scanning = !IS_ENABLED(CONFIG_FARM_SCAN_PREDICT);
+
+K_MSGQ_DEFINE(rx_queue, sizeof(struct farm_frame), CONFIG_FARM_QUEUE_SIZE, 4);
+
+static uint32_t rng(void)
+{
+    /* xorshift32, reproducible across hosts */
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+
+    return rng_state;
+}
+
+static uint32_t rng_range(uint32_t min, uint32_t max)
+{
+    return min + rng() % (max - min + 1);
+}
+
+/* Add an integer value, already scaled to the object's raw units */
+static int add_raw(struct bthome_device *dev, uint8_t object_id, uint32_t raw)
+{
+    struct bthome_measurement m = {
+        .object_id = object_id,
+    };
+
+    switch (bthome_object_size(object_id)) {
+    case 1:
+        m.value.u8 = raw;
+        break;
+    case 2:
+        m.value.u16 = raw;
+        break;
+    default:
+        m.value.u32 = raw;
+        break;
+    }
+
+    return bthome_add_measurement(dev, &m);
+}
+
+static int fill_packet(struct farm_sensor *s)
+{
+    struct bthome_device *dev = &s->dev;
+    uint8_t *text;
+    int err;
+
+    bthome_reset_measurements(dev);
+
+    /* Packet ID lets the gateway drop repeated receptions */
+    err = add_raw(dev, BTHOME_ID_PACKET, s->packet_id++);
+    if (err) {
+        return err;
+    }
+
+    switch (s->schema) {
+    case SCHEMA_CLIMATE:
+        s->value += rng_range(0, 20);
+        err = add_raw(dev, BTHOME_ID_TEMPERATURE, (uint16_t)(150 + s->value % 150));
+        err = err ? err : add_raw(dev, BTHOME_ID_HUMIDITY_PRECISE, 4000 + s->value % 3000);
+        err = err ? err : add_raw(dev, BTHOME_ID_BATTERY, 100 - s->value / 1000 % 100);
+        break;
+    case SCHEMA_METER:
+        s->value += rng_range(0, 5000);
+        err = add_raw(dev, BTHOME_ID_POWER, rng_range(0, 300000));
+        err = err ? err : add_raw(dev, BTHOME_ID_ENERGY4, s->value);
+        break;
+    case SCHEMA_CONTACT:
+        err = add_raw(dev, BTHOME_STATE_WINDOW, rng() & 1);
+        err = err ? err : add_raw(dev, BTHOME_ID_BATTERY, 87);
+        break;
+    case SCHEMA_COUNTER:
+        s->value += rng_range(0, 3);
+        err = add_raw(dev, BTHOME_ID_COUNT4, s->value);
+        break;
+    case SCHEMA_NAMED:
+        err = bthome_payload_reserve(dev, BTHOME_ID_TEXT, 6, &text);
+        if (err) {
+            return err;
+        }
+        snprintk((char *)text, 6, "n%04u", (unsigned int)(s - sensors));
+        text[5] = (uint8_t)('a' + s->packet_id % 26);
+        err = bthome_payload_commit(dev);
+        err = err ? err : add_raw(dev, BTHOME_ID_TEMPERATURE, 210);
+        break;
+    default:
+        err = -EINVAL;
+        break;
+    }
+
+    return err;
+}
+
+static void farm_receive(const struct farm_sensor *s, const uint8_t *data, int len)
+{
+    struct farm_frame frame;
+    uint32_t used;
+
+    memcpy(frame.mac, s->mac, sizeof(frame.mac));
+    memcpy(frame.data, data, len);
+    frame.len = len;
+    frame.rx_ms = k_uptime_get_32();
+
+    for (int i = 0; i < CONFIG_FARM_REPEATS; i++) {
+        stats.frames++;
+
+        if (k_msgq_put(&rx_queue, &frame, K_NO_WAIT)) {
+            stats.queue_drops++;
+            continue;
+        }
+
+        used = k_msgq_num_used_get(&rx_queue);
+        stats.queue_peak = MAX(stats.queue_peak, used);
+    }
+}
+
+static int64_t air_start_us(const struct farm_sensor *s)
+{
+    return s->next_ms * 1000 + s->next_us;
+}
+
+/*
+ * Packets are sent in time order, so a packet collides if the previous
+ * one is still on air or the following one starts before it ends.
+ */
+static bool air_collides(const struct farm_sensor *s, const struct farm_sensor *following,
+                         int len)
+{
+    static int64_t air_end_us;
+    int64_t start = air_start_us(s);
+    int64_t end = start + (AIR_OVERHEAD + len) * AIR_US_PER_BYTE;
+    bool collides = start < air_end_us || (following && air_start_us(following) < end);
+
+    air_end_us = MAX(air_end_us, end);
+
+    return collides;
+}
+
+static void sensor_thread(void *p1, void *p2, void *p3)
+{
+    uint8_t data[FRAME_MAX];
+    int64_t now;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (true) {
+        struct farm_sensor *next = &sensors[0];
+        struct farm_sensor *following = NULL;
+
+        for (int i = 1; i < SENSORS; i++) {
+            if (air_start_us(&sensors[i]) < air_start_us(next)) {
+                following = next;
+                next = &sensors[i];
+            } else if (!following || air_start_us(&sensors[i]) < air_start_us(following)) {
+                following = &sensors[i];
+            }
+        }
+
+        if (next->next_ms >= RUN_MS) {
+            break;
+        }
+
+        now = k_uptime_get();
+        if (next->next_ms > now) {
+            k_sleep(K_MSEC(next->next_ms - now));
+        }
+
+        if (fill_packet(next) == 0) {
+            int len = bthome_encode(&next->dev, next->mac, data, sizeof(data));
+
+            if (len > 0) {
+                stats.sent++;
+
+                if (IS_ENABLED(CONFIG_FARM_COLLISIONS) &&
+                    air_collides(next, following, len)) {
+                    stats.collided++;
+                } else if (CONFIG_FARM_RX_LOSS_PERCENT > 0 &&
+                           rng() % 100 < CONFIG_FARM_RX_LOSS_PERCENT) {
+                    stats.air_lost++;
+                } else if (!scanning) {
+                    stats.unheard++;
+                } else {
+                    farm_receive(next, data, len);
+                }
+            }
+        }
+
+        if (PHASE_SCHEDULED) {
+            next->nominal_ms += next->interval_ms;
+            next->next_ms = next->nominal_ms + rng_range(0, ADV_DELAY_MAX_MS);
+        } else {
+            next->next_ms += next->interval_ms + rng_range(0, ADV_DELAY_MAX_MS);
+        }
+        if (IS_ENABLED(CONFIG_FARM_COLLISIONS)) {
+            next->next_us = rng() % 1000;
+        }
+    }
+
+    atomic_set(&sensors_done, 1);
+}
+
+#if defined(CONFIG_FARM_SCAN_PREDICT)
+static struct bthome_scan_sensor scan_sensors[SENSORS];
+static struct bthome_scan scan;
+
+static int farm_scan_init(void)
+{
+    const struct bthome_scan_config cfg = {
+        .guard_ms = CONFIG_FARM_SCAN_GUARD_MS,
+        .merge_ms = SCAN_MERGE_MS,
+        .max_misses = CONFIG_FARM_SCAN_MAX_MISSES,
+        .discovery_ms = CONFIG_FARM_INTERVAL_MAX_MS + ADV_DELAY_MAX_MS +
+                        CONFIG_FARM_SCAN_GUARD_MS,
+        .discovery_interval_ms = CONFIG_FARM_SCAN_DISCOVERY_INTERVAL_S * 1000,
+    };
+
+    printk("Predictive scan: guard %d ms, %d misses, discovery %u ms every %d s\n",
+           CONFIG_FARM_SCAN_GUARD_MS, CONFIG_FARM_SCAN_MAX_MISSES, cfg.discovery_ms,
+           CONFIG_FARM_SCAN_DISCOVERY_INTERVAL_S);
+
+    return bthome_scan_init(&scan, &cfg, scan_sensors, ARRAY_SIZE(scan_sensors));
+}
+
+static void farm_scan_observe(const struct farm_frame *frame, const struct bthome_packet *pkt)
+{
+    const struct bthome_object *id = bthome_packet_find(pkt, BTHOME_ID_PACKET);
+
+    bthome_scan_observe(&scan, frame->mac, id ? (int)id->raw : -1, frame->rx_ms);
+}
+
+/* Stands in for bt_le_scan_start() and bt_le_scan_stop() */
+static void scan_thread(void *p1, void *p2, void *p3)
+{
+    struct bthome_scan_window win;
+    int64_t now;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while ((now = k_uptime_get()) < RUN_MS) {
+        if (bthome_scan_next(&scan, now, &win)) {
+            break;
+        }
+
+        if (win.start_ms >= RUN_MS) {
+            break;
+        }
+        if (win.start_ms > now) {
+            k_sleep(K_MSEC(win.start_ms - now));
+        }
+
+        scanning = true;
+        k_sleep(K_MSEC(MIN(win.end_ms, RUN_MS) - win.start_ms));
+        scanning = false;
+
+        now = k_uptime_get();
+        stats.scan_windows++;
+        stats.scan_ms += now - win.start_ms;
+        if (win.discovery) {
+            stats.discovery_ms += now - win.start_ms;
+        }
+    }
+}
+
+/* Runs before the sensors, so a window is open at its first millisecond */
+K_THREAD_DEFINE(scan_tid, SCAN_STACK_SIZE, scan_thread, NULL, NULL, NULL,
+                K_PRIO_COOP(0), 0, SYS_FOREVER_MS);
+
+/* Scan time in permille of the run */
+static uint32_t farm_scan_duty(void)
+{
+    return (uint32_t)(stats.scan_ms * 1000 / RUN_MS);
+}
+
+/* Received share of the packets on air in permille */
+static uint32_t farm_scan_capture(void)
+{
+    uint32_t on_air = stats.sent - stats.air_lost - stats.collided;
+
+    return on_air ? (uint32_t)((uint64_t)(on_air - stats.unheard) * 1000 / on_air) : 0;
+}
+
+static void farm_scan_report(void)
+{
+    uint32_t on_air = stats.sent - stats.air_lost - stats.collided;
+    uint32_t duty = farm_scan_duty();
+    uint32_t tracking = (uint32_t)((stats.scan_ms - stats.discovery_ms) * 1000 / RUN_MS);
+    uint32_t captured = on_air - stats.unheard;
+    uint32_t rate = farm_scan_capture();
+
+    printk("Scan:     duty %u.%u%% (%u.%u%% outside discovery), %u windows, "
+           "avg %u ms\n", duty / 10, duty % 10, tracking / 10, tracking % 10,
+           stats.scan_windows,
+           stats.scan_windows ? (uint32_t)(stats.scan_ms / stats.scan_windows) : 0);
+    printk("Predict:  %u learned, %u predicted, %u misses, %u lost, %u relearned\n",
+           scan.stats.learned, scan.stats.predicted, scan.stats.misses, scan.stats.lost,
+           scan.stats.relearned);
+    printk("Capture:  %u of %u packets on air (%u.%u%%), %u sent while not scanning\n",
+           captured, on_air, rate / 10, rate % 10, stats.unheard);
+}
+#endif /* CONFIG_FARM_SCAN_PREDICT */
+
+static struct gw_entry *gw_lookup(const uint8_t mac[6], bool insert)
+{
+    uint32_t i = bthome_mac_hash(mac) & (TABLE_SIZE - 1);
+
+    while (table[i].used) {
+        if (memcmp(table[i].mac, mac, 6) == 0) {
+            return &table[i];
+        }
+        i = (i + 1) & (TABLE_SIZE - 1);
+    }
+
+    if (!insert) {
+        return NULL;
+    }
+
+    table[i].used = true;
+    memcpy(table[i].mac, mac, 6);
+
+    return &table[i];
+}
+
+/* Format the reading as a gateway would forward it */
+static int gw_output(const uint8_t mac[6], const struct bthome_packet *pkt)
+{
+    char line[160];
+    int len;
+
+    len = snprintk(line, sizeof(line), "%02X:%02X:%02X:%02X:%02X:%02X",
+                   mac[5], mac[4], mac[3], mac[2], mac[1], mac[0]);
+
+    for (uint8_t i = 0; i < pkt->count && len < sizeof(line); i++) {
+        const struct bthome_object *obj = &pkt->objects[i];
+
+        if (obj->object_id == BTHOME_ID_TEXT || obj->object_id == BTHOME_ID_RAW) {
+            len += snprintk(&line[len], sizeof(line) - len, " %02x=%.*s",
+                            obj->object_id, obj->len, (const char *)obj->data);
+        } else {
+            len += snprintk(&line[len], sizeof(line) - len, " %02x=%lld/%u",
+                            obj->object_id, (long long)obj->raw,
+                            bthome_object_scale(obj->object_id));
+        }
+    }
+
+    if (IS_ENABLED(CONFIG_FARM_PRINT_PACKETS)) {
+        printk("%s\n", line);
+    }
+
+    return MIN(len, sizeof(line) - 1);
+}
+
+static void gw_process(const struct farm_frame *frame)
+{
+    struct bthome_packet pkt;
+    struct gw_entry *e;
+    uint32_t latency;
+    int err;
+
+    e = gw_lookup(frame->mac, false);
+    if (!e) {
+        stats.unknown++;
+        return;
+    }
+
+    err = bthome_decode(frame->data, frame->len, frame->mac, e->key, &pkt);
+    if (err) {
+        stats.decode_errors++;
+        return;
+    }
+
+    if (bthome_dedup_check(&e->dedup, &pkt)) {
+        stats.duplicates++;
+        return;
+    }
+
+#if defined(CONFIG_FARM_SCAN_PREDICT)
+    farm_scan_observe(frame, &pkt);
+#endif
+
+    stats.readings++;
+    stats.objects += pkt.count;
+    stats.output_bytes += gw_output(frame->mac, &pkt);
+
+    latency = k_uptime_get_32() - frame->rx_ms;
+    stats.lat_sum_ms += latency;
+    stats.lat_max_ms = MAX(stats.lat_max_ms, latency);
+    stats.lat_hist[MIN(latency, LAT_BUCKETS - 1)]++;
+}
+
+static void gateway_thread(void *p1, void *p2, void *p3)
+{
+    struct farm_frame frame;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (!atomic_get(&sensors_done) || k_msgq_num_used_get(&rx_queue) > 0) {
+        for (int i = 0; i < CONFIG_FARM_GATEWAY_BATCH; i++) {
+            uint64_t start;
+            uint32_t cpu;
+
+            if (k_msgq_get(&rx_queue, &frame, K_NO_WAIT)) {
+                break;
+            }
+
+            start = farm_host_cpu_ns();
+            gw_process(&frame);
+            cpu = (uint32_t)(farm_host_cpu_ns() - start);
+
+            stats.cpu_ns += cpu;
+            stats.cpu_max_ns = MAX(stats.cpu_max_ns, cpu);
+        }
+
+        k_sleep(K_MSEC(CONFIG_FARM_GATEWAY_PERIOD_MS));
+    }
+}
+
+/* Both threads are cooperative: statistics need no locking */
+K_THREAD_DEFINE(sensor_tid, SENSOR_STACK_SIZE, sensor_thread, NULL, NULL, NULL,
+                K_PRIO_COOP(1), 0, SYS_FOREVER_MS);
+K_THREAD_DEFINE(gateway_tid, GATEWAY_STACK_SIZE, gateway_thread, NULL, NULL, NULL,
+                K_PRIO_COOP(2), 0, SYS_FOREVER_MS);
+
+static int farm_init(void)
+{
+    uint32_t schemas[SCHEMA_COUNT] = { 0 };
+    uint32_t encrypted = 0;
+
+    for (int i = 0; i < SENSORS; i++) {
+        struct farm_sensor *s = &sensors[i];
+        struct bthome_config config = {
+            .device_name = "Farm",
+            .encryption = rng() % 100 < CONFIG_FARM_ENCRYPTED_PERCENT,
+        };
+        struct gw_entry *e;
+        int err;
+
+        for (int k = 0; k < sizeof(config.bind_key); k++) {
+            config.bind_key[k] = rng();
+        }
+
+        err = bthome_init(&s->dev, &config);
+        if (err) {
+            printk("Sensor %d init failed (err %d)\n", i, err);
+            return err;
+        }
+
+        /* Static random address: two top bits set */
+        s->mac[0] = i;
+        s->mac[1] = i >> 8;
+        s->mac[2] = rng();
+        s->mac[3] = rng();
+        s->mac[4] = rng();
+        s->mac[5] = 0xC0 | (rng() & 0x3F);
+
+        s->schema = i % SCHEMA_COUNT;
+        s->interval_ms = rng_range(CONFIG_FARM_INTERVAL_MIN_MS, CONFIG_FARM_INTERVAL_MAX_MS);
+        s->next_ms = rng_range(0, s->interval_ms);
+#if defined(CONFIG_FARM_PHASE_BOOT)
+        s->nominal_ms = 0;
+        s->next_ms = rng_range(0, ADV_DELAY_MAX_MS);
+#elif defined(CONFIG_FARM_PHASE_SLOTTED)
+        s->nominal_ms = bthome_sched_slot(s->mac, s->interval_ms / CONFIG_FARM_SLOT_MS) *
+                        CONFIG_FARM_SLOT_MS;
+        s->next_ms = s->nominal_ms + rng_range(0, ADV_DELAY_MAX_MS);
+#endif
+        s->packet_id = rng();
+        s->value = rng() % 1000;
+
+        schemas[s->schema]++;
+        encrypted += config.encryption;
+
+        /* The gateway is provisioned with every sensor and its key */
+        e = gw_lookup(s->mac, true);
+        memcpy(e->key, config.bind_key, sizeof(e->key));
+    }
+
+    printk("%d sensors, %u encrypted, intervals %d..%d ms, %d receptions per packet\n",
+           SENSORS, encrypted, CONFIG_FARM_INTERVAL_MIN_MS, CONFIG_FARM_INTERVAL_MAX_MS,
+           CONFIG_FARM_REPEATS);
+    for (int i = 0; i < SCHEMA_COUNT; i++) {
+        printk("  %-8s %u\n", schema_names[i], schemas[i]);
+    }
+
+    return 0;
+}
+
+static uint32_t latency_percentile(uint32_t percent)
+{
+    uint32_t target = (uint64_t)stats.readings * percent / 100;
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < LAT_BUCKETS; i++) {
+        sum += stats.lat_hist[i];
+        if (sum > target) {
+            return i;
+        }
+    }
+
+    return LAT_BUCKETS - 1;
+}
+
+static void farm_report(void)
+{
+    uint32_t processed = stats.frames - stats.queue_drops;
+    uint32_t per_s = stats.readings / CONFIG_FARM_DURATION_S;
+    uint32_t cpu_avg = processed ? (uint32_t)(stats.cpu_ns / processed) : 0;
+
+    printk("Traffic:  %u packets, %u frames offered (%u/s)\n",
+           stats.sent, stats.frames, stats.frames / CONFIG_FARM_DURATION_S);
+    if (CONFIG_FARM_RX_LOSS_PERCENT > 0) {
+        printk("Air:      %u packets lost (%d%%)\n", stats.air_lost,
+               CONFIG_FARM_RX_LOSS_PERCENT);
+    }
+    if (IS_ENABLED(CONFIG_FARM_COLLISIONS)) {
+        uint32_t permille = stats.sent ? (uint64_t)stats.collided * 1000 / stats.sent : 0;
+
+        printk("Air:      %u packets collided (%u.%u%%)\n", stats.collided,
+               permille / 10, permille % 10);
+    }
+    printk("Gateway:  %u readings (%u/s), %u objects, %u output bytes\n",
+           stats.readings, per_s, stats.objects, stats.output_bytes);
+    printk("Drops:    queue %u, duplicates %u, decode errors %u, unknown %u, "
+           "readings lost %u\n",
+           stats.queue_drops, stats.duplicates, stats.decode_errors, stats.unknown,
+           stats.sent - stats.readings);
+    printk("Latency:  avg %u ms, p50 %u ms, p99 %u ms, max %u ms\n",
+           stats.readings ? (uint32_t)(stats.lat_sum_ms / stats.readings) : 0,
+           latency_percentile(50), latency_percentile(99), stats.lat_max_ms);
+    printk("Host CPU: avg %u ns, max %u ns per frame, ~%u frames/s per core\n",
+           cpu_avg, stats.cpu_max_ns, cpu_avg ? 1000000000U / cpu_avg : 0);
+    /* Thread stacks live on the host on native_sim and are not measured */
+    printk("Memory:   queue peak %u/%d (%zu B), gateway table %u/%d (%zu B), "
+           "decode buffer %zu B, sensors %zu B\n",
+           stats.queue_peak, CONFIG_FARM_QUEUE_SIZE,
+           stats.queue_peak * sizeof(struct farm_frame), SENSORS, TABLE_SIZE,
+           sizeof(table), sizeof(struct bthome_packet), sizeof(sensors));
+}
+
+/* Limits of the configuration, Twister matches the last line */
+static bool farm_check(void)
+{
+    bool ok = true;
+
+#if defined(CONFIG_FARM_COLLISIONS)
+    if ((uint64_t)stats.collided * 1000 >
+        (uint64_t)stats.sent * CONFIG_FARM_MAX_COLLISIONS_PERMILLE) {
+        printk("Check:    more than %d permille collided\n",
+               CONFIG_FARM_MAX_COLLISIONS_PERMILLE);
+        ok = false;
+    }
+#endif
+
+#if defined(CONFIG_FARM_SCAN_PREDICT)
+    if (farm_scan_capture() < CONFIG_FARM_SCAN_MIN_CAPTURE_PERMILLE) {
+        printk("Check:    less than %d permille captured\n",
+               CONFIG_FARM_SCAN_MIN_CAPTURE_PERMILLE);
+        ok = false;
+    }
+
+    if (farm_scan_duty() > CONFIG_FARM_SCAN_MAX_DUTY_PERMILLE) {
+        printk("Check:    scanned more than %d permille of the time\n",
+               CONFIG_FARM_SCAN_MAX_DUTY_PERMILLE);
+        ok = false;
+    }
+#endif
+
+    return ok;
+}
+
+int main(void)
+{
+    printk("BTHome sensor farm on %s\n", CONFIG_BOARD_TARGET);
+
+    if (farm_init()) {
+        return -1;
+    }
+
+#if defined(CONFIG_FARM_SCAN_PREDICT)
+    if (farm_scan_init()) {
+        return -1;
+    }
+#endif
+
+    printk("Gateway capacity %d frames/s, queue %d, %d s simulated\n",
+           CONFIG_FARM_GATEWAY_BATCH * 1000 / CONFIG_FARM_GATEWAY_PERIOD_MS,
+           CONFIG_FARM_QUEUE_SIZE, CONFIG_FARM_DURATION_S);
+
+#if defined(CONFIG_FARM_SCAN_PREDICT)
+    k_thread_start(scan_tid);
+#endif
+    k_thread_start(sensor_tid);
+    k_thread_start(gateway_tid);
+    k_thread_join(gateway_tid, K_FOREVER);
+#if defined(CONFIG_FARM_SCAN_PREDICT)
+    k_thread_join(scan_tid, K_FOREVER);
+#endif
+
+    farm_report();
+#if defined(CONFIG_FARM_SCAN_PREDICT)
+    farm_scan_report();
+#endif
+    printk("Farm checks %s\n", farm_check() ? "passed" : "failed");
+    printk("Farm done\n");
+
+    return 0;
+}